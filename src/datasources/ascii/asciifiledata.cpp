@@ -34,6 +34,7 @@ void fileBufferFree(void* ptr);
 #include <QFile>
 #include <QDebug>
 #include <QByteArray>
+#include <QMutex>
 
 int MB = 1024*1024;
 
@@ -50,6 +51,7 @@ size_t maxAllocate = (size_t) -1;
 
 //-------------------------------------------------------------------------------------------
 static QMap<void*, size_t> allocatedMBs;
+static QMutex allocatedMBsLock;
 
 //-------------------------------------------------------------------------------------------
 static void logMemoryUsed()
@@ -72,6 +74,7 @@ void* fileBufferMalloc(size_t bytes)
   if (bytes <= maxAllocate)
 #endif
     ptr = malloc(bytes);
+  QMutexLocker ml(&allocatedMBsLock);
   if (ptr)  {
     allocatedMBs[ptr] = bytes;
     KST_MEMORY_DEBUG if(bytes / MB != 0) qDebug() << "AsciiFileBuffer: " << bytes / MB << "MB allocated";
@@ -87,6 +90,7 @@ void* fileBufferMalloc(size_t bytes)
 //-------------------------------------------------------------------------------------------
 void fileBufferFree(void* ptr)
 {
+  QMutexLocker ml(&allocatedMBsLock);
   if (allocatedMBs.contains(ptr)) {
     KST_MEMORY_DEBUG if(allocatedMBs[ptr] / MB != 0) qDebug() << "AsciiFileData: " << allocatedMBs[ptr] / MB << "MB freed";
     allocatedMBs.remove(ptr);
@@ -219,6 +219,11 @@ bool AsciiPlugin::supportsTime(QSettings *cfg, const QString& filename) const {
 }
 
 
+QStringList AsciiPlugin::detectionSettings() const {
+  return AsciiSourceConfig::detectionKeys();
+}
+
+
 QStringList AsciiPlugin::provides() const {
   return QStringList() <<AsciiSource::asciiTypeKey();
 }
@@ -68,6 +68,10 @@ class AsciiPlugin : public QObject, public Kst::DataSourcePluginInterface
     virtual QStringList provides() const;
 
     virtual Kst::DataSourceConfigWidget *configWidget(QSettings *cfg, const QString& filename) const;
+
+    virtual bool concurrentOpen() const { return true; }
+
+    virtual QStringList detectionSettings() const;
 };
 
 
@@ -14,6 +14,7 @@
 
 #include "asciisource.h"
 #include "datasource.h"
+#include "datasourcepluginmanager.h"
 
 //
 // AsciiSourceConfig
@@ -143,6 +144,7 @@ void AsciiSourceConfig::saveDefault(QSettings& cfg) const {
   cfg.beginGroup(AsciiSource::asciiTypeKey());
   save(cfg);
   cfg.endGroup();
+  Kst::DataSourcePluginManager::detectionSettingsChanged();
 }
 
 
@@ -154,6 +156,13 @@ void AsciiSourceConfig::saveGroup(QSettings& cfg, const QString& fileName) const
   save(cfg);
   cfg.endGroup();
   cfg.endGroup();
+  Kst::DataSourcePluginManager::detectionSettingsChanged(fileName);
+}
+
+
+QStringList AsciiSourceConfig::detectionKeys() {
+  return QStringList() << Key_fileNamePattern << Key_columnType << Key_columnDelimiter
+                       << Key_delimiters << Key_dataLine;
 }
 
 
@@ -17,6 +17,7 @@
 
 #include <QDomElement>
 #include <QDateTime>
+#include <QStringList>
 
 
 class AsciiSourceConfig {
@@ -84,6 +85,8 @@ class AsciiSourceConfig {
 
     void saveDefault(QSettings& cfg) const;
     void saveGroup(QSettings& cfg, const QString& fileName) const;
+    // the settings AsciiPlugin::understands() reads
+    static QStringList detectionKeys();
     const AsciiSourceConfig& readGroup(QSettings& cfg, const QString& fileName = QString());
 
     void save(QXmlStreamWriter& s);
@@ -150,6 +150,9 @@ class DirFilePlugin : public QObject, public Kst::DataSourcePluginInterface {
     virtual QStringList provides() const;
 
     virtual Kst::DataSourceConfigWidget *configWidget(QSettings *cfg, const QString& filename) const;
+
+    // getdata keeps its state in each open dirfile
+    virtual bool concurrentOpen() const { return true; }
 };
 
 
@@ -109,6 +109,10 @@ class FitsImagePlugin : public QObject, public Kst::DataSourcePluginInterface {
     virtual QStringList provides() const;
 
     virtual Kst::DataSourceConfigWidget *configWidget(QSettings *cfg, const QString& filename) const;
+
+    // cfitsio shares buffers between open files unless it was built
+    // reentrant (--enable-reentrant)
+    virtual bool concurrentOpen() const { return fits_is_reentrant() != 0; }
 };
 
 
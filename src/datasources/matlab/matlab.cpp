@@ -15,6 +15,9 @@
 #include <QXmlStreamWriter>
 #include <QFileInfo>
 
+#include <limits.h>
+#include <string.h>
+
 using namespace Kst;
 
 // Define enum to handle the various classes of variables with readable code
@@ -64,6 +67,105 @@ enum matio_data_type {UNKNOWN_DT,
                       STRUCTURE_DT};
 
 
+// matio >= 1.5 reuses the last two class types for 64 bit integers
+static const int SIXTYFOUR_BIT_SIGNED_INT_ARRAY_CT = MATLAB_ARRAY_CT;
+static const int SIXTYFOUR_BIT_UNSIGNED_INT_ARRAY_CT = COMPRESSED_DATA_CT;
+
+// decoded variables kept per file, in kB
+static const int MaxDecodedCost = 256*1024;
+
+
+// A plain loop over one type, so that the compiler can vectorize it.
+template<class T>
+static void convertSamples(double *v, const void *data, int n) {
+  const T *d = static_cast<const T*>(data);
+  for (int i = 0; i < n; ++i) {
+    v[i] = double(d[i]);
+  }
+}
+
+
+// Converts n samples of the given data type to double.
+static bool convertData(double *v, const void *data, int dataType, int n) {
+  switch (dataType) {
+  case EIGHT_BIT_SIGNED_INT_DT:
+    convertSamples<int8_t>(v, data, n);
+    break;
+  case EIGHT_BIT_UNSIGNED_INT_DT:
+    convertSamples<uint8_t>(v, data, n);
+    break;
+  case SIXTEEN_BIT_SIGNED_INT_DT:
+    convertSamples<int16_t>(v, data, n);
+    break;
+  case SIXTEEN_BIT_UNSIGNED_INT_DT:
+    convertSamples<uint16_t>(v, data, n);
+    break;
+  case THIRTYTWO_BIT_SIGNED_INT_DT:
+    convertSamples<int32_t>(v, data, n);
+    break;
+  case THIRTYTWO_BIT_UNSIGNED_INT_DT:
+    convertSamples<uint32_t>(v, data, n);
+    break;
+  case IEEE_754_SINGLE_PRECISION_DT:
+    convertSamples<float>(v, data, n);
+    break;
+  case IEEE_754_DOUBLE_PRECISION_DT:
+    memcpy(v, data, n*sizeof(double));
+    break;
+  case SIXTYFOUR_BIT_SIGNED_INT_DT:
+    convertSamples<int64_t>(v, data, n);
+    break;
+  case SIXTYFOUR_BIT_UNSIGNED_INT_DT:
+    convertSamples<uint64_t>(v, data, n);
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+
+// Mat_VarReadData() returns the samples in the type of the class of the
+// variable, whatever they are stored as.
+static int classDataType(int classType, int *size) {
+  switch (classType) {
+  case DOUBLE_PRECISION_ARRAY_CT:
+    *size = sizeof(double);
+    return IEEE_754_DOUBLE_PRECISION_DT;
+  case SINGLE_PRECISION_ARRAY_CT:
+    *size = sizeof(float);
+    return IEEE_754_SINGLE_PRECISION_DT;
+  case EIGHT_BIT_SIGNED_INT_ARRAY_CT:
+    *size = sizeof(int8_t);
+    return EIGHT_BIT_SIGNED_INT_DT;
+  case EIGHT_BIT_UNSIGNED_INT_ARRAY_CT:
+    *size = sizeof(uint8_t);
+    return EIGHT_BIT_UNSIGNED_INT_DT;
+  case SIXTEEN_BIT_SIGNED_INT_ARRAY_CT:
+    *size = sizeof(int16_t);
+    return SIXTEEN_BIT_SIGNED_INT_DT;
+  case SIXTEEN_BIT_UNSIGNED_INT_ARRAY_CT:
+    *size = sizeof(uint16_t);
+    return SIXTEEN_BIT_UNSIGNED_INT_DT;
+  case THIRTYTWO_BIT_SIGNED_INT_ARRAY_CT:
+    *size = sizeof(int32_t);
+    return THIRTYTWO_BIT_SIGNED_INT_DT;
+  case THIRTYTWO_BIT_UNSIGNED_INT_ARRAY_CT:
+    *size = sizeof(uint32_t);
+    return THIRTYTWO_BIT_UNSIGNED_INT_DT;
+  case SIXTYFOUR_BIT_SIGNED_INT_ARRAY_CT:
+    *size = sizeof(int64_t);
+    return SIXTYFOUR_BIT_SIGNED_INT_DT;
+  case SIXTYFOUR_BIT_UNSIGNED_INT_ARRAY_CT:
+    *size = sizeof(uint64_t);
+    return SIXTYFOUR_BIT_UNSIGNED_INT_DT;
+  default:
+    *size = 0;
+    return UNKNOWN_DT;
+  }
+}
+
+
 //
 // Scalar interface
 //
@@ -261,13 +363,8 @@ const DataMatrix::DataInfo DataInterfaceMatlabMatrix::dataInfo(const QString& ma
     return DataMatrix::DataInfo();
   }
 
-  QByteArray bytes = matrix.toLatin1();
-  matvar_t *matvar = Mat_VarRead(matlab._matfile, bytes.data());
-  if (!matvar) {
-    return DataMatrix::DataInfo();
-  }
-
-  if (matvar->rank != 2) {
+  matvar_t *matvar = matlab.variableInfo(matrix);
+  if (!matvar || matvar->rank != 2) {
     return DataMatrix::DataInfo();
   }
 
@@ -276,8 +373,6 @@ const DataMatrix::DataInfo DataInterfaceMatlabMatrix::dataInfo(const QString& ma
   info.xSize = matvar->dims[0];
   info.ySize = matvar->dims[1];
 
-  Mat_VarFree(matvar);
-
   return info;
 }
 
@@ -311,6 +406,7 @@ MatlabSource::MatlabSource(Kst::ObjectStore *store, QSettings *cfg, const QStrin
 : Kst::DataSource(store, cfg, filename, type),
   _matfile(0L),
   _config(0L),
+  _decoded(MaxDecodedCost),
   is(new DataInterfaceMatlabScalar(*this)),
   it(new DataInterfaceMatlabString(*this)),
   iv(new DataInterfaceMatlabVector(*this)),
@@ -342,12 +438,14 @@ MatlabSource::MatlabSource(Kst::ObjectStore *store, QSettings *cfg, const QStrin
 
 
 MatlabSource::~MatlabSource() {
+  clearCaches();
   Mat_Close(_matfile);
   _matfile = 0L;
 }
 
 
 void MatlabSource::reset() {
+  clearCaches();
   Mat_Close(_matfile);
   _matfile = 0L;
   _maxFrameCount = 0;
@@ -485,235 +583,141 @@ int MatlabSource::readField(double *v, const QString& field, int s, int n) {
   }
 
   /* For a variable from the Matlab file */
-  matio_data_type dataType;
-  matvar_t *matvar = Mat_VarRead(_matfile, field.toLatin1().data());
-  if (!matvar) {
+  matvar_t *info = variableInfo(field);
+  if (!info) {
     KST_DBG qDebug() << "MatlabSource: queried field " << field << " which can't be read" << endl;
     return -1;
   }
 
-  if (s >= _frameCounts[field]) {
+  const int frameCount = _frameCounts[field];
+  if (s >= frameCount) {
     return 0;
   }
-
-  dataType = (matio_data_type) matvar->data_type;
-  switch (dataType) { // We have to be careful with the dimension of data elements
-  case EIGHT_BIT_SIGNED_INT_DT:
-  {
-    int8_t *dataPointer = (int8_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  if (n < 0) { // a single sample
+    n = 1;
   }
-    break;
+  n = qMin(n, frameCount - s);
 
-  case EIGHT_BIT_UNSIGNED_INT_DT:
-  {
-    uint8_t *dataPointer = (uint8_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  // uncompressed variables are read straight from the file
+  if (info->compression == MAT_COMPRESSION_NONE && readSlice(v, info, s, n)) {
+    return n;
   }
-    break;
 
-  case SIXTEEN_BIT_SIGNED_INT_DT:
-  {
-    int16_t *dataPointer = (int16_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  QScopedPointer<DecodedVariable> uncached;
+  matvar_t *matvar = decodedVariable(field, uncached);
+  if (!matvar) {
+    KST_DBG qDebug() << "MatlabSource: queried field " << field << " which can't be read" << endl;
+    return -1;
   }
-    break;
 
-  case SIXTEEN_BIT_UNSIGNED_INT_DT:
-  {
-    uint16_t *dataPointer = (uint16_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  int dataSize = Mat_SizeOf(matvar->data_type);
+  if (!convertData(v, static_cast<const char*>(matvar->data) + s*dataSize, matvar->data_type, n)) {
+    KST_DBG qDebug() << "MatlabSource, field " << field << ": wrong datatype for kst, no values read" << endl;
+    return -1;
   }
-    break;
 
-  case THIRTYTWO_BIT_SIGNED_INT_DT:
-  {
-    int32_t *dataPointer = (int32_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
-  }
-    break;
+  KST_DBG qDebug() << "Finished reading " << field << endl;
+  return n;
+}
 
-  case THIRTYTWO_BIT_UNSIGNED_INT_DT:
-  {
-    uint32_t *dataPointer = (uint32_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
-  }
-    break;
 
-  case IEEE_754_SINGLE_PRECISION_DT:
-  {
-    float *dataPointer = (float*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+// Reads n samples from s on of a vector through the file offsets in info,
+// without decoding the rest of the variable.
+bool MatlabSource::readSlice(double *v, matvar_t *info, int s, int n) {
+  if (info->isComplex || info->rank != 2) {
+    return false;
   }
-    break;
 
-  case IEEE_754_DOUBLE_PRECISION_DT:
-  {
-    double *dataPointer = (double*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  int size = 0;
+  const int dataType = classDataType(info->class_type, &size);
+  if (dataType == UNKNOWN_DT) {
+    return false;
   }
-    break;
 
-  case SIXTYFOUR_BIT_SIGNED_INT_DT:
-  {
-    int64_t *dataPointer = (int64_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  // vectors are a single row or column
+  int start[2] = {s, 0};
+  int stride[2] = {1, 1};
+  int edge[2] = {n, 1};
+  if (info->dims[0] == 1) {
+    start[0] = 0; start[1] = s;
+    edge[0] = 1; edge[1] = n;
   }
-    break;
 
-  case SIXTYFOUR_BIT_UNSIGNED_INT_DT:
-  {
-    uint64_t *dataPointer = (uint64_t*)matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i+s];
-    }
+  if (dataType == IEEE_754_DOUBLE_PRECISION_DT) {
+    return Mat_VarReadData(_matfile, info, v, start, stride, edge) == 0;
   }
-    break;
-
-  default:
-      KST_DBG qDebug() << "MatlabSource, field " << field << ": wrong datatype for kst, no values read" << endl;
-      return -1;
-      break;
+  QByteArray buffer;
+  buffer.resize(n*size);
+  if (Mat_VarReadData(_matfile, info, buffer.data(), start, stride, edge) != 0) {
+    return false;
   }
-
-  KST_DBG qDebug() << "Finished reading " << field << endl;
-  Mat_VarFree(matvar);
-  return n;
+  return convertData(v, buffer.constData(), dataType, n);
 }
 
 
-int MatlabSource::readMatrix(double *v, const QString& field)
-{
-  /* For a variable from the Matlab file */
-  matvar_t *matvar = Mat_VarRead(_matfile, field.toLatin1().data());
-  if (!matvar) {
-    KST_DBG qDebug() << "MatlabSource: queried matrix " << field << " which can't be read" << endl;
-    return -1;
+// The header of a variable, which is kept until the file is reset.
+matvar_t *MatlabSource::variableInfo(const QString& field) {
+  QHash<QString, matvar_t*>::ConstIterator it = _variableInfo.constFind(field);
+  if (it != _variableInfo.constEnd()) {
+    return it.value();
   }
-
-  // Matrices are always read from the beginning to the end
-  // But we have to first store the data in a buffer of the right type, then copy it to v
-  int n = matvar->dims[0] * matvar->dims[1];
-
-  matio_data_type dataType = (matio_data_type) matvar->data_type;
-  switch (dataType) {
-  case EIGHT_BIT_SIGNED_INT_DT:
-  {
-    int8_t *dataPointer = (int8_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+  matvar_t *matvar = Mat_VarReadInfo(_matfile, field.toLatin1().data());
+  if (matvar) {
+    _variableInfo.insert(field, matvar);
   }
-    break;
+  return matvar;
+}
 
-  case EIGHT_BIT_UNSIGNED_INT_DT:
-  {
-    uint8_t *dataPointer = (uint8_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
-    free(dataPointer);
-  }
-    break;
 
-  case SIXTEEN_BIT_SIGNED_INT_DT:
-  {
-    int16_t *dataPointer = (int16_t *) matvar->data;;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+// The whole variable, decoded.  Variables too big to keep are returned in
+// 'uncached', which frees them.
+matvar_t *MatlabSource::decodedVariable(const QString& field, QScopedPointer<DecodedVariable>& uncached) {
+  if (DecodedVariable *decoded = _decoded.object(field)) {
+    return decoded->var;
   }
-    break;
 
-  case SIXTEEN_BIT_UNSIGNED_INT_DT:
-  {
-    uint16_t *dataPointer = (uint16_t *) matvar->data;;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+  matvar_t *matvar = Mat_VarRead(_matfile, field.toLatin1().data());
+  if (!matvar) {
+    return 0L;
   }
-    break;
-
-  case THIRTYTWO_BIT_SIGNED_INT_DT:
-  {
-    int32_t *dataPointer = (int32_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+  DecodedVariable *decoded = new DecodedVariable(matvar);
+  const int cost = int(qMin(size_t(INT_MAX), size_t(matvar->nbytes)/1024 + 1));
+  if (cost <= _decoded.maxCost()) {
+    _decoded.insert(field, decoded, cost);
+  } else {
+    uncached.reset(decoded);
   }
-    break;
+  return matvar;
+}
 
-  case THIRTYTWO_BIT_UNSIGNED_INT_DT:
-  {
-    uint32_t *dataPointer = (uint32_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
-  }
-    break;
 
-  case IEEE_754_SINGLE_PRECISION_DT:
-  {
-    float *dataPointer = (float *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+void MatlabSource::clearCaches() {
+  _decoded.clear();
+  foreach (matvar_t *matvar, _variableInfo) {
+    Mat_VarFree(matvar);
   }
-    break;
+  _variableInfo.clear();
+}
 
-  case IEEE_754_DOUBLE_PRECISION_DT:
-  {
-    double *dataPointer = (double *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
-  }
-    break;
 
-  case SIXTYFOUR_BIT_SIGNED_INT_DT:
-  {
-    int64_t *dataPointer = (int64_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
+int MatlabSource::readMatrix(double *v, const QString& field)
+{
+  /* For a variable from the Matlab file */
+  QScopedPointer<DecodedVariable> uncached;
+  matvar_t *matvar = decodedVariable(field, uncached);
+  if (!matvar) {
+    KST_DBG qDebug() << "MatlabSource: queried matrix " << field << " which can't be read" << endl;
+    return -1;
   }
-    break;
 
-  case SIXTYFOUR_BIT_UNSIGNED_INT_DT:
-  {
-    uint64_t *dataPointer = (uint64_t *) matvar->data;
-    for (int i = 0; i < n; ++i) {
-      v[i] = (double)dataPointer[i];
-    }
-  }
-    break;
+  // Matrices are always read from the beginning to the end
+  int n = matvar->dims[0] * matvar->dims[1];
 
-  default:
-      KST_DBG qDebug() << "MatlabSource, field " << field << ": wrong datatype for kst, no values read" << endl;
-      return -1;
-      break;
+  if (!convertData(v, matvar->data, matvar->data_type, n)) {
+    KST_DBG qDebug() << "MatlabSource, field " << field << ": wrong datatype for kst, no values read" << endl;
+    return -1;
   }
 
-  Mat_VarFree(matvar);
-
   return n;
 }
 
@@ -17,6 +17,10 @@
 #include <datasource.h>
 #include <dataplugin.h>
 
+#include <QCache>
+#include <QHash>
+#include <QScopedPointer>
+
 #include <matio.h>
 
 class DataInterfaceMatlabScalar;
@@ -56,6 +60,18 @@ class MatlabSource : public Kst::DataSource {
 
 
   private:
+    // A variable read and decoded by matio, freed with it.
+    struct DecodedVariable {
+      explicit DecodedVariable(matvar_t *v) : var(v) {}
+      ~DecodedVariable() { Mat_VarFree(var); }
+      matvar_t *var;
+    };
+
+    matvar_t *variableInfo(const QString& field);
+    matvar_t *decodedVariable(const QString& field, QScopedPointer<DecodedVariable>& uncached);
+    bool readSlice(double *v, matvar_t *info, int s, int n);
+    void clearCaches();
+
     QMap<QString, int> _frameCounts;
     int _maxFrameCount;
 
@@ -63,6 +79,13 @@ class MatlabSource : public Kst::DataSource {
     mat_t *_matfile;
     mutable Config *_config;
 
+    // Headers of the variables read so far: type, size, and where they are
+    // in the file.  Uncompressed variables are read a slice at a time using
+    // these; compressed ones have to be decoded whole, so the decoded
+    // variables are kept as well, up to a limit.
+    QHash<QString, matvar_t*> _variableInfo;
+    QCache<QString, DecodedVariable> _decoded;
+
     // Primitive lists
     QMap<QString, QString> _strings;
     QStringList _scalarList;
@@ -51,7 +51,7 @@ class QImageSource::Config {
 class DataInterfaceQImageVector : public DataSource::DataInterface<DataVector>
 {
 public:
-  DataInterfaceQImageVector(QImage* img) : _image(img) {}
+  DataInterfaceQImageVector(QImageSource* source) : _source(source), _image(&source->_image) {}
 
   // read one element
   int read(const QString&, DataVector::ReadInfo&);
@@ -72,6 +72,7 @@ public:
 
   // no interface
 
+  QImageSource* _source;
   QImage* _image;
   QStringList _vectorList;
   int _frameCount;
@@ -109,41 +110,27 @@ const DataVector::DataInfo DataInterfaceQImageVector::dataInfo(const QString &fi
 
 int DataInterfaceQImageVector::read(const QString& field, DataVector::ReadInfo& p)
 {
-  int i = 0;
   int s = p.startingFrame;
   int n = p.numberOfFrames;
 
   if ( field=="INDEX" ) {
-    for ( i=0; i<n; ++i ) {
+    for (int i=0; i<n; ++i ) {
       p.data[i] = i + s;
     }
-  } else if ( field=="GRAY" ) {
-    for ( i = s; i<s+n; ++i ) {
-      int px = i%_image->width();
-      int py = i/_image->width();
-      p.data[i-s] = qGray( _image->pixel( px, py ) );
-    }
-  } else if ( field=="RED" ) {
-    for ( i=s; i<s+n; ++i ) {
-      int px = i%_image->width();
-      int py = i/_image->width();
-      p.data[i-s] = qRed( _image->pixel( px, py ) );
-    }
-  } else if ( field=="GREEN" ) {
-    for ( i=s; i<s+n; ++i ) {
-      int px = i%_image->width();
-      int py = i/_image->width();
-      p.data[i-s] = qGreen( _image->pixel( px, py ) );
-    }
-  } else if ( field=="BLUE" ) {
-    for ( i=s; i<s+n; ++i ) {
-      int px = i%_image->width();
-      int py = i/_image->width();
-      p.data[i-s] = qBlue( _image->pixel( px, py ) );
-    }
+    return n;
   }
 
-  return i;
+  const uchar *plane = _source->channel(field);
+  if (!plane) {
+    return 0;
+  }
+  n = qMax(0, qMin(n, _image->width()*_image->height() - s));
+  plane += s;
+  for (int i=0; i<n; ++i ) {
+    p.data[i] = plane[i];
+  }
+
+  return n;
 }
 
 
@@ -168,7 +155,7 @@ class DataInterfaceQImageMatrix : public DataSource::DataInterface<DataMatrix>
 {
 public:
 
-  DataInterfaceQImageMatrix(QImage* img) : _image(img) {}
+  DataInterfaceQImageMatrix(QImageSource* source) : _source(source), _image(&source->_image) {}
 
   // read one element
   int read(const QString&, DataMatrix::ReadInfo&);
@@ -188,6 +175,7 @@ public:
 
 
   // no interface
+  QImageSource* _source;
   QImage* _image;
   QStringList _matrixList;
 
@@ -237,37 +225,23 @@ int DataInterfaceQImageMatrix::read(const QString& field, DataMatrix::ReadInfo&
   int x1 = p.xStart + p.xNumSteps;
   double* z = p.data->z;
 
-  int i = 0;
+  const uchar *plane = _source->channel(field);
+  if (!plane) {
+    return 0;
+  }
 
-  if ( field=="GRAY") {
-    for (int px = p.xStart; px<x1; ++px ) {
-      for (int py=y1-1; py>=p.yStart; py-- ) {
-        z[i] = qGray( _image->pixel( px, py ) );
-        ++i;
-      }
-    }
-  } else if ( field=="RED" ) {
-    for (int px = p.xStart; px<x1; ++px ) {
-      for (int py=y1-1; py>=p.yStart; py-- ) {
-        z[i] = qRed( _image->pixel( px, py ) );
-        ++i;
-      }
-    }
-  } else if ( field=="GREEN" ) {
-    for (int px = p.xStart; px<x1; ++px ) {
-      for (int py=y1-1; py>=p.yStart; py-- ) {
-        z[i] = qGreen( _image->pixel( px, py ) );
-        ++i;
-      }
-    }
-  } else if ( field=="BLUE" ) {
-    for (int px = p.xStart; px<x1; ++px ) {
-      for (int py=y1-1; py>=p.yStart; py-- ) {
-        z[i] = qBlue( _image->pixel( px, py ) );
-        ++i;
-      }
+  // z runs along columns, from the bottom of the image up; read the
+  // channel row by row and scatter each row across the columns
+  const int width = _image->width();
+  const int ny = y1 - y0;
+  for (int py = y0; py<y1; ++py ) {
+    const uchar *row = plane + py*width;
+    double *zy = z + (y1 - 1 - py);
+    for (int px = x0; px<x1; ++px ) {
+      zy[(px - x0)*ny] = row[px];
     }
   }
+  int i = (x1 - x0)*ny;
 
     // set the suggested matrix transform params: pixel index....
   p.data->xMin = x0;
@@ -294,8 +268,8 @@ bool DataInterfaceQImageMatrix::isValid(const QString& field) const {
 QImageSource::QImageSource(Kst::ObjectStore *store, QSettings *cfg, const QString& filename, const QString& type, const QDomElement& e) :
   Kst::DataSource(store, cfg, filename, type),
   _config(0L),
-  iv(new DataInterfaceQImageVector(&_image)),
-  im(new DataInterfaceQImageMatrix(&_image))
+  iv(new DataInterfaceQImageVector(this)),
+  im(new DataInterfaceQImageMatrix(this))
 {
   setInterface(iv);
   setInterface(im);
@@ -333,6 +307,7 @@ const QString& QImageSource::typeString() const {
 
 
 void QImageSource::reset() {
+  _channels.clear();
   init();
   Object::reset();
 }
@@ -341,11 +316,16 @@ void QImageSource::reset() {
 bool QImageSource::init()
 {
   _image = QImage();
+  _channels.clear();
   iv->clear();
   im->clear();
   if (!_image.load( _filename ) ) {
     return false;
   }
+  // one known layout for channel(), whatever the file held
+  if (_image.format() != QImage::Format_ARGB32 && _image.format() != QImage::Format_RGB32) {
+    _image = _image.convertToFormat(QImage::Format_ARGB32);
+  }
   iv->init();
   im->init();
   registerChange();
@@ -353,6 +333,65 @@ bool QImageSource::init()
 }
 
 
+const uchar *QImageSource::channel(const QString& field)
+{
+  QHash<QString, QByteArray>::ConstIterator it = _channels.constFind(field);
+  if (it != _channels.constEnd()) {
+    return reinterpret_cast<const uchar*>(it.value().constData());
+  }
+
+  enum { Gray, Red, Green, Blue } c;
+  if (field == "GRAY") {
+    c = Gray;
+  } else if (field == "RED") {
+    c = Red;
+  } else if (field == "GREEN") {
+    c = Green;
+  } else if (field == "BLUE") {
+    c = Blue;
+  } else {
+    return 0L;
+  }
+  if (_image.isNull()) {
+    return 0L;
+  }
+
+  const int width = _image.width();
+  const int height = _image.height();
+  QByteArray plane;
+  plane.resize(width*height);
+  uchar *out = reinterpret_cast<uchar*>(plane.data());
+  for (int y = 0; y < height; ++y) {
+    const QRgb *line = reinterpret_cast<const QRgb*>(_image.constScanLine(y));
+    switch (c) {
+      case Gray:
+        for (int x = 0; x < width; ++x) {
+          out[x] = qGray(line[x]);
+        }
+        break;
+      case Red:
+        for (int x = 0; x < width; ++x) {
+          out[x] = qRed(line[x]);
+        }
+        break;
+      case Green:
+        for (int x = 0; x < width; ++x) {
+          out[x] = qGreen(line[x]);
+        }
+        break;
+      case Blue:
+        for (int x = 0; x < width; ++x) {
+          out[x] = qBlue(line[x]);
+        }
+        break;
+    }
+    out += width;
+  }
+
+  return reinterpret_cast<const uchar*>(_channels.insert(field, plane).value().constData());
+}
+
+
 Kst::Object::UpdateType QImageSource::internalDataSourceUpdate()
 {
   int newNF = _image.width()*_image.height();
@@ -17,6 +17,9 @@
 #include <datasource.h>
 #include <dataplugin.h>
 
+#include <QByteArray>
+#include <QHash>
+
 class DataInterfaceQImageVector;
 class DataInterfaceQImageMatrix;
   
@@ -47,9 +50,17 @@ class QImageSource : public Kst::DataSource
     //int readString(QString &S, const QString& string);
 
   private:
+    // One byte per pixel of the GRAY, RED, GREEN or BLUE channel, row by
+    // row, extracted the first time it is read.
+    const uchar *channel(const QString& field);
+
     QImage _image;
+    QHash<QString, QByteArray> _channels;
     mutable Config *_config;
 
+    friend class DataInterfaceQImageVector;
+    friend class DataInterfaceQImageMatrix;
+
     DataInterfaceQImageVector* iv;
     DataInterfaceQImageMatrix* im;
 };
@@ -104,6 +115,8 @@ class QImageSourcePlugin : public QObject, public Kst::DataSourcePluginInterface
     virtual QStringList provides() const;
 
     virtual Kst::DataSourceConfigWidget *configWidget(QSettings *cfg, const QString& filename) const;
+
+    virtual bool concurrentOpen() const { return true; }
 };
 
 
@@ -32,6 +32,15 @@ int main(int argc, char *argv[]) {
   }
 #endif
 
+#if QT_VERSION >= 0x050000
+  // --export renders without a window, so it needs no display either
+  for (int i = 1; i < argc; ++i) {
+    if (qstrcmp(argv[i], "--export") == 0 && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+  }
+#endif
+
   Kst::Application app(argc, argv);
 
   //--------
@@ -63,5 +72,5 @@ int main(int argc, char *argv[]) {
     app.mainWindow()->show();
     return app.exec();
   }
-  return 0;
+  return app.mainWindow()->commandLineExitCode();
 }
@@ -0,0 +1,73 @@
+/***************************************************************************
+                               boundedqueue.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QAtomicInt>
+
+namespace Kst {
+
+/**
+ * Fixed capacity FIFO between one producer thread and one consumer thread.
+ * push() and pop() never lock or allocate; push() fails when the queue is
+ * full, so the producer decides what to do with the overflow.
+ * Capacity must be a power of two.
+ */
+template<class T, int Capacity>
+class BoundedQueue {
+  public:
+    BoundedQueue() : _head(0), _tail(0) {}
+
+    // producer side
+    bool push(const T& item) {
+      const uint tail = uint(_tail.fetchAndAddRelaxed(0));
+      const uint head = uint(_head.fetchAndAddAcquire(0));
+      if (tail - head >= uint(Capacity)) {
+        return false;
+      }
+      _items[tail & (Capacity - 1)] = item;
+      _tail.fetchAndStoreRelease(int(tail + 1));
+      return true;
+    }
+
+    // consumer side
+    bool pop(T& item) {
+      const uint head = uint(_head.fetchAndAddRelaxed(0));
+      const uint tail = uint(_tail.fetchAndAddAcquire(0));
+      if (head == tail) {
+        return false;
+      }
+      item = _items[head & (Capacity - 1)];
+      _head.fetchAndStoreRelease(int(head + 1));
+      return true;
+    }
+
+    bool isEmpty() const {
+      return const_cast<QAtomicInt&>(_head).fetchAndAddAcquire(0) == const_cast<QAtomicInt&>(_tail).fetchAndAddAcquire(0);
+    }
+
+  private:
+    QAtomicInt _head; // next slot to read, only written by the consumer
+    QAtomicInt _tail; // next slot to write, only written by the producer
+    T _items[Capacity];
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
@@ -0,0 +1,374 @@
+/***************************************************************************
+                             changenotifier.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "changenotifier.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <sys/vfs.h>
+#endif
+
+#include "datasource.h"
+#include "updatemanager.h"
+
+#define DEFAULT_QUIET_PERIOD 20
+
+namespace Kst {
+
+// bounds on how often polled files are looked at, in ms
+static const int MinPollInterval = 250;
+static const int MaxPollInterval = 10000;
+
+static ChangeNotifier *notifier_self = 0L;
+static QMutex notifierSelfLock;
+
+void ChangeNotifier::cleanup() {
+  delete notifier_self;
+  notifier_self = 0L;
+}
+
+
+ChangeNotifier *ChangeNotifier::self() {
+  QMutexLocker ml(&notifierSelfLock);
+  if (!notifier_self) {
+    notifier_self = new ChangeNotifier;
+    // the watcher and the timers belong to the main thread
+    if (QCoreApplication::instance()) {
+      notifier_self->moveToThread(QCoreApplication::instance()->thread());
+    }
+    qAddPostRoutine(ChangeNotifier::cleanup);
+  }
+  return notifier_self;
+}
+
+
+ChangeNotifier::ChangeNotifier()
+  : _deliverTimer(this), _pollTimer(this), _quietPeriod(DEFAULT_QUIET_PERIOD) {
+  _watcher = new QFileSystemWatcher(this);
+  connect(_watcher, SIGNAL(fileChanged(QString)), this, SLOT(pathChanged(QString)));
+  connect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(pathChanged(QString)));
+
+  _deliverTimer.setSingleShot(true);
+  connect(&_deliverTimer, SIGNAL(timeout()), this, SLOT(deliver()));
+  _pollTimer.setSingleShot(true);
+  connect(&_pollTimer, SIGNAL(timeout()), this, SLOT(poll()));
+
+  _clock.start();
+}
+
+
+ChangeNotifier::~ChangeNotifier() {
+}
+
+
+int ChangeNotifier::quietPeriod() const {
+  QMutexLocker ml(&_lock);
+  return _quietPeriod;
+}
+
+
+void ChangeNotifier::setQuietPeriod(int ms) {
+  QMutexLocker ml(&_lock);
+  _quietPeriod = qMax(0, ms);
+}
+
+
+void ChangeNotifier::watch(DataSource *source, const QString &path) {
+  unwatch(source);
+  {
+    QMutexLocker ml(&_lock);
+    Source s;
+    s.path = path;
+    _sources.insert(source, s);
+    Path &p = _paths[path];
+    p.sources.insert(source);
+    if (p.sources.count() > 1) {
+      return;
+    }
+  }
+
+  if (QThread::currentThread() == thread()) {
+    startWatching(path);
+  } else {
+    QMetaObject::invokeMethod(this, "startWatching", Qt::QueuedConnection, Q_ARG(QString, path));
+  }
+}
+
+
+void ChangeNotifier::unwatch(DataSource *source) {
+  QString path;
+  {
+    QMutexLocker ml(&_lock);
+    QHash<DataSource*, Source>::Iterator it = _sources.find(source);
+    if (it == _sources.end()) {
+      return;
+    }
+    path = it.value().path;
+    _sources.erase(it);
+
+    QHash<QString, Path>::Iterator p = _paths.find(path);
+    if (p == _paths.end()) {
+      return;
+    }
+    p.value().sources.remove(source);
+    if (!p.value().sources.isEmpty()) {
+      return;
+    }
+    const bool polled = p.value().polled;
+    _paths.erase(p);
+    if (polled) {
+      return;
+    }
+  }
+
+  if (QThread::currentThread() == thread()) {
+    stopWatching(path);
+  } else {
+    QMetaObject::invokeMethod(this, "stopWatching", Qt::QueuedConnection, Q_ARG(QString, path));
+  }
+}
+
+
+double ChangeNotifier::changeRate(const DataSource *source) const {
+  QMutexLocker ml(&_lock);
+  QHash<DataSource*, Source>::ConstIterator it = _sources.constFind(const_cast<DataSource*>(source));
+  if (it == _sources.constEnd() || it.value().interval <= 0.0) {
+    return 0.0;
+  }
+  return 1000.0/it.value().interval;
+}
+
+
+void ChangeNotifier::startWatching(const QString &path) {
+  QMutexLocker ml(&_lock);
+  QHash<QString, Path>::Iterator it = _paths.find(path);
+  if (it == _paths.end() || it.value().polled ||
+      _watcher->files().contains(path) || _watcher->directories().contains(path)) {
+    return;
+  }
+
+  if (!isNetworkPath(path)) {
+    _watcher->addPath(path);
+    if (_watcher->files().contains(path) || _watcher->directories().contains(path)) {
+      return;
+    }
+  }
+
+  // the watcher can't watch it: missing files, network file systems, or
+  // out of inotify watches
+  QFileInfo info(path);
+  Path &p = it.value();
+  p.polled = true;
+  p.size = info.exists() ? info.size() : -1;
+  p.modified = info.lastModified();
+  p.pollInterval = qBound(MinPollInterval, UpdateManager::self()->minimumUpdatePeriod(), MaxPollInterval);
+  const qint64 now = _clock.elapsed();
+  p.nextPoll = now + p.pollInterval;
+  schedulePoll(now);
+}
+
+
+void ChangeNotifier::stopWatching(const QString &path) {
+  QMutexLocker ml(&_lock);
+  if (_paths.contains(path)) {
+    // watched again since
+    return;
+  }
+  if (_watcher->files().contains(path) || _watcher->directories().contains(path)) {
+    _watcher->removePath(path);
+  }
+}
+
+
+void ChangeNotifier::pathChanged(const QString &path) {
+  QMutexLocker ml(&_lock);
+  QHash<QString, Path>::ConstIterator it = _paths.constFind(path);
+  if (it == _paths.constEnd()) {
+    return;
+  }
+
+  // a file replaced by renaming another over it drops out of the watcher
+  if (!_watcher->files().contains(path) && !_watcher->directories().contains(path) &&
+      QFileInfo(path).exists()) {
+    _watcher->addPath(path);
+  }
+
+  const qint64 now = _clock.elapsed();
+  markChanged(it.value(), now);
+  scheduleDelivery(now);
+}
+
+
+void ChangeNotifier::poll() {
+  QMutexLocker ml(&_lock);
+  const qint64 now = _clock.elapsed();
+  bool changed = false;
+  for (QHash<QString, Path>::Iterator it = _paths.begin(); it != _paths.end(); ++it) {
+    Path &p = it.value();
+    if (!p.polled || p.nextPoll > now) {
+      continue;
+    }
+    QFileInfo info(it.key());
+    const qint64 size = info.exists() ? info.size() : -1;
+    const QDateTime modified = info.lastModified();
+    if (size != p.size || modified != p.modified) {
+      p.size = size;
+      p.modified = modified;
+      markChanged(p, now);
+      changed = true;
+      p.pollInterval = qMax(MinPollInterval, p.pollInterval/2);
+    } else {
+      p.pollInterval = qMin(MaxPollInterval, p.pollInterval*3/2);
+    }
+    p.nextPoll = now + p.pollInterval;
+  }
+  schedulePoll(now);
+  if (changed) {
+    scheduleDelivery(now);
+  }
+}
+
+
+void ChangeNotifier::deliver() {
+  QList<DataSource*> sources;
+  {
+    QMutexLocker ml(&_lock);
+    const qint64 now = _clock.elapsed();
+    // sources due shortly go along with the ones due now
+    for (QHash<DataSource*, Source>::Iterator it = _sources.begin(); it != _sources.end(); ++it) {
+      Source &s = it.value();
+      if (s.pending < 0 || due(s) > now + _quietPeriod) {
+        continue;
+      }
+      if (s.lastDelivery >= 0) {
+        const double interval = qMax(qint64(1), now - s.lastDelivery);
+        s.interval = s.interval > 0.0 ? 0.75*s.interval + 0.25*interval : interval;
+      }
+      s.lastDelivery = now;
+      s.pending = -1;
+      sources.append(it.key());
+    }
+    scheduleDelivery(now);
+  }
+
+  // all in one update: one DataSource::checkUpdate() each would run the
+  // first and put the others off by the minimum update period.  Watched
+  // sources are not timer driven, so there is no timer to re-arm here.
+  if (!sources.isEmpty() && !UpdateManager::self()->paused()) {
+    UpdateManager::self()->doSourceUpdates(sources);
+  }
+}
+
+
+// The lock is held.
+void ChangeNotifier::markChanged(const Path &path, qint64 now) {
+  foreach (DataSource *source, path.sources) {
+    QHash<DataSource*, Source>::Iterator it = _sources.find(source);
+    if (it != _sources.end()) {
+      it.value().lastChange = now;
+      if (it.value().pending < 0) {
+        it.value().pending = now;
+      }
+    }
+  }
+}
+
+
+// When the changes to source are delivered: once it has been quiet for a
+// while, but no later than the minimum update period after the first one.
+qint64 ChangeNotifier::due(const Source &source) const {
+  return qMin(source.lastChange + _quietPeriod,
+              source.pending + UpdateManager::self()->minimumUpdatePeriod());
+}
+
+
+// The lock is held.
+void ChangeNotifier::scheduleDelivery(qint64 now) {
+  qint64 next = -1;
+  for (QHash<DataSource*, Source>::ConstIterator it = _sources.constBegin(); it != _sources.constEnd(); ++it) {
+    if (it.value().pending >= 0) {
+      const qint64 d = due(it.value());
+      if (next < 0 || d < next) {
+        next = d;
+      }
+    }
+  }
+  if (next < 0) {
+    _deliverTimer.stop();
+  } else {
+    _deliverTimer.start(int(qMax(qint64(0), next - now)));
+  }
+}
+
+
+// The lock is held.
+void ChangeNotifier::schedulePoll(qint64 now) {
+  qint64 next = -1;
+  for (QHash<QString, Path>::ConstIterator it = _paths.constBegin(); it != _paths.constEnd(); ++it) {
+    if (it.value().polled && (next < 0 || it.value().nextPoll < next)) {
+      next = it.value().nextPoll;
+    }
+  }
+  if (next < 0) {
+    _pollTimer.stop();
+  } else {
+    _pollTimer.start(int(qMax(qint64(0), next - now)));
+  }
+}
+
+
+bool ChangeNotifier::isNetworkPath(const QString &path) {
+#ifdef Q_OS_LINUX
+  // statfs() needs something which exists
+  QFileInfo info(path);
+  QString existing = info.absoluteFilePath();
+  while (!QFileInfo(existing).exists() && existing != info.absoluteDir().rootPath()) {
+    existing = QFileInfo(existing).absolutePath();
+  }
+
+  struct statfs buf;
+  if (statfs(QFile::encodeName(existing).constData(), &buf) != 0) {
+    return false;
+  }
+  switch (quint32(buf.f_type)) {
+    case 0x6969:     // NFS
+    case 0x517B:     // SMB
+    case 0xFF534D42: // CIFS
+    case 0xFE534D42: // SMB2
+    case 0x564C:     // NCP
+    case 0x5346414F: // AFS
+    case 0x73757245: // Coda
+    case 0x01021997: // 9P
+    case 0x65735546: // FUSE (sshfs and the like)
+      return true;
+    default:
+      break;
+  }
+#else
+  Q_UNUSED(path)
+#endif
+  return false;
+}
+
+}
+// vim: ts=2 sw=2 et
@@ -0,0 +1,117 @@
+/***************************************************************************
+                              changenotifier.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef CHANGENOTIFIER_H
+#define CHANGENOTIFIER_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+#include "kst_export.h"
+
+class QFileSystemWatcher;
+
+namespace Kst {
+
+class DataSource;
+
+/**
+ * Tells data sources when the files they read change.  One file system
+ * watcher (inotify on Linux) serves every source.  Changes to a source are
+ * held until it has been quiet for quietPeriod() ms, or for no longer than
+ * the minimum update period while it keeps changing, and then delivered in
+ * one tick together with every other source due about then, so that the
+ * update manager runs one update for all of them.  Files on network file
+ * systems, where file system notifications do not work, are polled
+ * instead, more often while they change and less often while they don't.
+ * watch() and unwatch() may be called from any thread.
+ */
+class KSTCORE_EXPORT ChangeNotifier : public QObject
+{
+  Q_OBJECT
+  public:
+    static ChangeNotifier *self();
+
+    /** Has the update manager update source when path (a file or a directory)
+        changes, until unwatch(source).  A source watches one path. */
+    void watch(DataSource *source, const QString &path);
+    void unwatch(DataSource *source);
+
+    /** Changes delivered to source per second, averaged over the last few;
+        0 until two have been.  The update manager does not hold back the
+        updates of sources which change rarely. */
+    double changeRate(const DataSource *source) const;
+
+    int quietPeriod() const;
+    void setQuietPeriod(int ms);
+
+  private Q_SLOTS:
+    void pathChanged(const QString &path);
+    void deliver();
+    void poll();
+    void startWatching(const QString &path);
+    void stopWatching(const QString &path);
+
+  private:
+    ChangeNotifier();
+    ~ChangeNotifier();
+    static void cleanup();
+
+    struct Source {
+      Source() : pending(-1), lastChange(-1), lastDelivery(-1), interval(0.0) {}
+      QString path;
+      qint64 pending;      // when the first undelivered change came; -1 if none
+      qint64 lastChange;
+      qint64 lastDelivery;
+      double interval;     // between deliveries, in ms; 0 if unknown
+    };
+
+    struct Path {
+      Path() : polled(false), size(-1), pollInterval(0), nextPoll(0) {}
+      QSet<DataSource*> sources;
+      bool polled;
+      qint64 size;
+      QDateTime modified;
+      int pollInterval;
+      qint64 nextPoll;
+    };
+
+    void markChanged(const Path &path, qint64 now);
+    void scheduleDelivery(qint64 now);
+    void schedulePoll(qint64 now);
+    qint64 due(const Source &source) const;
+    static bool isNetworkPath(const QString &path);
+
+    mutable QMutex _lock;
+    QHash<DataSource*, Source> _sources;
+    QHash<QString, Path> _paths;
+    QFileSystemWatcher *_watcher;
+    QTimer _deliverTimer;
+    QTimer _pollTimer;
+    QElapsedTimer _clock;
+    int _quietPeriod;
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
@@ -25,6 +25,7 @@
 #include "datacollection.h"
 #include "debug.h"
 #include "objectstore.h"
+#include "trace.h"
 
 
 // xStart, yStart < 0             count from end
@@ -338,6 +339,14 @@ qint64 DataMatrix::maxInputSerialOfLastChange() const {
   return Forced;
 }
 
+QList<Object*> DataMatrix::inputObjects() const {
+  QList<Object*> inputs;
+  if (dataSource()) {
+    inputs.append(dataSource().data());
+  }
+  return inputs;
+}
+
 void DataMatrix::_resetFieldMetadata() {
   _resetFieldScalars();
   _resetFieldStrings();
@@ -683,6 +692,7 @@ QString DataMatrix::propertyString() const {
 
 int DataMatrix::readMatrix(MatrixData* data, const QString& matrix, int xStart, int yStart, int xNumSteps, int yNumSteps, int skip)
 {
+  TRACE_SPAN_DETAIL("read", "readMatrix", matrix);
   ReadInfo p = { data, xStart, yStart, xNumSteps, yNumSteps, skip};
   return dataSource()->matrix().read(matrix, p);
 }
@@ -130,6 +130,7 @@ class KSTCORE_EXPORT DataMatrix : public Matrix, public DataPrimitive
     // update DataMatrix
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
     friend class ObjectStore;
 
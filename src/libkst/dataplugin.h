@@ -89,6 +89,15 @@ class DataSourcePluginInterface : public PluginInterface {
     bool provides(const QString& type) const { return provides().contains(type); }
 
     virtual DataSourceConfigWidget *configWidget(QSettings *cfg, const QString& filename) const = 0;
+
+    // true if understands() and create() can run on several threads at
+    // once for different files.  Plugins which can't take turns.
+    virtual bool concurrentOpen() const { return false; }
+
+    // The settings understands() reads, as keys in the groups named after
+    // the provided types.  A plugin listing any calls
+    // DataSourcePluginManager::detectionSettingsChanged() when it writes them.
+    virtual QStringList detectionSettings() const { return QStringList(); }
 };
 
 
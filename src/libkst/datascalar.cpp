@@ -150,6 +150,14 @@ qint64 DataScalar::maxInputSerialOfLastChange() const {
   return NoInputs;
 }
 
+QList<Object*> DataScalar::inputObjects() const {
+  QList<Object*> inputs;
+  if (dataSource()) {
+    inputs.append(dataSource().data());
+  }
+  return inputs;
+}
+
 QString DataScalar::descriptionTip() const {
   QString IDstring;
 
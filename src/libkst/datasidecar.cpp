@@ -0,0 +1,306 @@
+/***************************************************************************
+                               datasidecar.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "datasidecar.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QObject>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtConcurrentMap>
+
+#include <limits.h>
+#include <string.h>
+
+#include "debug.h"
+
+namespace Kst {
+
+// File layout: magic, version, payload count, then for each payload its
+// size and blocks (compressed flag, offset in the file, stored size), then
+// the blocks.  Blocks are BlockSize bytes of the payload but the last.
+static const quint32 SidecarMagic = 0x4B535444; // "KSTD"
+static const quint32 SidecarVersion = 1;
+static const int BlockSize = 4*1024*1024;
+
+static DataSidecar *current_sidecar = 0L;
+
+
+DataSidecar::DataSidecar(const QString& sessionFileName)
+  : _fileName(fileName(sessionFileName)), _saving(false), _opened(false) {
+  current_sidecar = this;
+}
+
+
+DataSidecar::~DataSidecar() {
+  _decoded.waitForFinished();
+  if (current_sidecar == this) {
+    current_sidecar = 0L;
+  }
+}
+
+
+QString DataSidecar::fileName(const QString& sessionFileName) {
+  return sessionFileName + QLatin1String(".data");
+}
+
+
+void DataSidecar::beginSave() {
+  _saving = true;
+  _payloads.clear();
+}
+
+
+namespace {
+struct SaveBlock {
+  const char *data;
+  int size;
+};
+
+// empty if the block is better stored as it is
+QByteArray compressBlock(const SaveBlock& block) {
+  QByteArray packed = qCompress(reinterpret_cast<const uchar*>(block.data), block.size, 1);
+  if (packed.size() >= block.size - block.size/10) {
+    return QByteArray();
+  }
+  return packed;
+}
+}
+
+
+bool DataSidecar::finishSave() {
+  _saving = false;
+  if (_payloads.isEmpty()) {
+    return true;
+  }
+
+  QList<SaveBlock> blocks;
+  QList<int> blockCounts;
+  foreach (const QByteArray& payload, _payloads) {
+    int count = 0;
+    for (int offset = 0; offset < payload.size(); offset += BlockSize) {
+      SaveBlock b;
+      b.data = payload.constData() + offset;
+      b.size = qMin(BlockSize, payload.size() - offset);
+      blocks.append(b);
+      ++count;
+    }
+    blockCounts.append(count);
+  }
+  const QList<QByteArray> packed = QtConcurrent::blockingMapped(blocks, compressBlock);
+
+  QFile f(_fileName);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    _payloads.clear();
+    return false;
+  }
+
+  qint64 offset = 3*sizeof(quint32);
+  foreach (int count, blockCounts) {
+    offset += sizeof(qint64) + sizeof(qint32) + count*(sizeof(quint8) + sizeof(qint64) + sizeof(qint32));
+  }
+
+  QDataStream s(&f);
+  s << SidecarMagic << SidecarVersion << qint32(_payloads.count());
+  int b = 0;
+  for (int i = 0; i < _payloads.count(); ++i) {
+    s << qint64(_payloads.at(i).size()) << qint32(blockCounts.at(i));
+    for (int j = 0; j < blockCounts.at(i); ++j, ++b) {
+      const bool compressed = !packed.at(b).isEmpty();
+      const qint32 stored = compressed ? packed.at(b).size() : blocks.at(b).size;
+      s << quint8(compressed) << offset << stored;
+      offset += stored;
+    }
+  }
+  for (b = 0; b < blocks.count(); ++b) {
+    if (!packed.at(b).isEmpty()) {
+      f.write(packed.at(b));
+    } else {
+      f.write(blocks.at(b).data, blocks.at(b).size);
+    }
+  }
+
+  _payloads.clear();
+  return s.status() == QDataStream::Ok && f.error() == QFile::NoError;
+}
+
+
+bool DataSidecar::open() {
+  _opened = true;
+  _file.setFileName(_fileName);
+  if (!_file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  const qint64 fileSize = _file.size();
+  const char *contents = reinterpret_cast<const char*>(_file.map(0, fileSize));
+  if (!contents) {
+    _contents = _file.readAll();
+    contents = _contents.constData();
+  }
+
+  QByteArray header = QByteArray::fromRawData(contents, int(qMin(fileSize, qint64(INT_MAX))));
+  QBuffer buffer(&header);
+  buffer.open(QIODevice::ReadOnly);
+  QDataStream s(&buffer);
+  quint32 magic, version;
+  qint32 count;
+  s >> magic >> version >> count;
+  if (magic != SidecarMagic || version != SidecarVersion) {
+    return false;
+  }
+
+  for (qint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+    qint64 size;
+    qint32 blockCount;
+    s >> size >> blockCount;
+    if (size < 0 || size > INT_MAX) {
+      break;
+    }
+    QList<Block> blocks;
+    bool contiguous = true;
+    int position = 0;
+    for (qint32 j = 0; j < blockCount && s.status() == QDataStream::Ok; ++j) {
+      quint8 compressed;
+      qint64 offset;
+      qint32 stored;
+      s >> compressed >> offset >> stored;
+      Block b;
+      b.to = 0L;
+      b.size = qMin(BlockSize, int(size) - position);
+      b.from = contents + offset;
+      b.storedSize = stored;
+      b.compressed = compressed;
+      b.corrupt = false;
+      if (offset < 0 || stored < 0 || offset + stored > fileSize || b.size <= 0 ||
+          (!b.compressed && stored != b.size)) {
+        s.setStatus(QDataStream::ReadCorruptData);
+        break;
+      }
+      contiguous = contiguous && !b.compressed &&
+                   (blocks.isEmpty() || b.from == blocks.last().from + blocks.last().size);
+      blocks.append(b);
+      position += b.size;
+    }
+
+    Payload p;
+    p.size = int(size);
+    p.corrupt = position != p.size;
+    if (contiguous && !p.corrupt && !blocks.isEmpty()) {
+      p.mapped = blocks.first().from;
+      p.firstBlock = p.blockCount = 0;
+      _payloads.append(QByteArray());
+    } else {
+      QByteArray payload(p.size, '\0');
+      position = 0;
+      for (int j = 0; j < blocks.count(); ++j) {
+        blocks[j].to = payload.data() + position;
+        position += blocks.at(j).size;
+      }
+      p.mapped = 0L;
+      p.firstBlock = _blocks.count();
+      p.blockCount = blocks.count();
+      _blocks += blocks;
+      _payloads.append(payload);
+    }
+    _loaded.append(p);
+  }
+  if (s.status() != QDataStream::Ok) {
+    _blocks.clear();
+    _payloads.clear();
+    _loaded.clear();
+    return false;
+  }
+
+  _decoded = QtConcurrent::map(_blocks, decode);
+  return true;
+}
+
+
+void DataSidecar::decode(Block& block) {
+  if (block.compressed) {
+    const QByteArray data = qUncompress(reinterpret_cast<const uchar*>(block.from), block.storedSize);
+    block.corrupt = data.size() != block.size;
+    if (!block.corrupt) {
+      memcpy(block.to, data.constData(), block.size);
+    }
+  } else {
+    memcpy(block.to, block.from, block.size);
+  }
+}
+
+
+void DataSidecar::writePayload(QXmlStreamWriter& xml, const QString& tag, const QByteArray& data) {
+  if (current_sidecar && current_sidecar->_saving) {
+    xml.writeStartElement(tag);
+    xml.writeAttribute("sidecar", QString::number(current_sidecar->_payloads.count()));
+    xml.writeAttribute("size", QString::number(data.size()));
+    xml.writeEndElement();
+    current_sidecar->_payloads.append(data);
+  } else {
+    xml.writeTextElement(tag, qCompress(data).toBase64());
+  }
+}
+
+
+QByteArray DataSidecar::readPayload(QXmlStreamReader& xml) {
+  const QXmlStreamAttributes attrs = xml.attributes();
+  if (!attrs.hasAttribute("sidecar")) {
+    QString qcs(xml.readElementText().toLatin1());
+    QByteArray qbca = QByteArray::fromBase64(qcs.toLatin1());
+    return qUncompress(qbca);
+  }
+  xml.readElementText();
+
+  bool ok;
+  const int id = attrs.value("sidecar").toString().toInt(&ok);
+  const int size = attrs.value("size").toString().toInt();
+  DataSidecar *sidecar = current_sidecar;
+  if (sidecar && !sidecar->_opened) {
+    sidecar->open();
+  }
+  if (!sidecar || !ok || id < 0 || id >= sidecar->_loaded.count()) {
+    Debug::self()->log(QObject::tr("Saved data is missing from %1.").arg(sidecar ? sidecar->_fileName : QString()), Debug::Warning);
+    return QByteArray();
+  }
+
+  const Payload& payload = sidecar->_loaded.at(id);
+  bool corrupt = payload.corrupt;
+  if (payload.blockCount > 0) {
+    sidecar->_decoded.waitForFinished();
+    for (int i = payload.firstBlock; i < payload.firstBlock + payload.blockCount; ++i) {
+      corrupt = corrupt || sidecar->_blocks.at(i).corrupt;
+    }
+  }
+  if (corrupt) {
+    Debug::self()->log(QObject::tr("Saved data in %1 is corrupt and was not loaded.").arg(sidecar->_fileName), Debug::Error);
+    sidecar->_payloads[id] = QByteArray();
+    return QByteArray();
+  }
+
+  // the factories only read from it, so the mapped data is not copied
+  const QByteArray data = payload.mapped ? QByteArray::fromRawData(payload.mapped, payload.size) : sidecar->_payloads.at(id);
+  sidecar->_payloads[id] = QByteArray();
+  if (data.size() != size) {
+    Debug::self()->log(QObject::tr("Saved data in %1 does not match the session.").arg(sidecar->_fileName), Debug::Warning);
+    return QByteArray();
+  }
+  return data;
+}
+
+}
+// vim: ts=2 sw=2 et
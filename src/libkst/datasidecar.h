@@ -0,0 +1,98 @@
+/***************************************************************************
+                                datasidecar.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DATASIDECAR_H
+#define DATASIDECAR_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QFuture>
+#include <QList>
+#include <QString>
+
+#include "kst_export.h"
+
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+namespace Kst {
+
+/**
+ * The binary file next to a saved session (session.kst.data) which holds
+ * the data of editable vectors and matrices instead of the .kst file.
+ * Payloads are split into blocks which are compressed on the thread pool
+ * when saving.  When loading, the file is memory mapped; payloads stored
+ * uncompressed are read where they are, and the others are decompressed
+ * on the thread pool.
+ *
+ * While a DataSidecar exists, readPayload() takes the payloads the session
+ * refers to from it, and once it is saving writePayload() puts them there;
+ * otherwise payloads are compressed base64 text in the XML.
+ */
+class KSTCORE_EXPORT DataSidecar {
+  public:
+    explicit DataSidecar(const QString& sessionFileName);
+    ~DataSidecar();
+
+    static QString fileName(const QString& sessionFileName);
+
+    // payloads saved from now on go to the sidecar
+    void beginSave();
+    // compresses and writes what was saved; false if it can't be written
+    bool finishSave();
+
+    // writes data as a tag element, inline or as a reference to the sidecar
+    static void writePayload(QXmlStreamWriter& xml, const QString& tag, const QByteArray& data);
+    // reads the payload element xml is at; empty if it can't be read.  The
+    // data may be in the sidecar's mapped file, so use it while it exists.
+    static QByteArray readPayload(QXmlStreamReader& xml);
+
+  private:
+    struct Block {
+      char *to;
+      int size;
+      const char *from;
+      int storedSize;
+      bool compressed;
+      bool corrupt;
+    };
+    struct Payload {
+      const char *mapped; // the data, if it is stored as it is in one piece
+      int size;
+      int firstBlock;
+      int blockCount;
+      bool corrupt;
+    };
+    static void decode(Block& block);
+    // maps the file and starts decoding it
+    bool open();
+
+    QString _fileName;
+    bool _saving;
+    bool _opened;
+    QList<QByteArray> _payloads; // to save, or decompressed
+    QList<Payload> _loaded;
+    QFile _file;
+    QByteArray _contents;   // when the file can't be mapped
+    QList<Block> _blocks;
+    QFuture<void> _decoded;
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
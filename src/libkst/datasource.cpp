@@ -30,14 +30,16 @@
 #include <QUrl>
 #include <QXmlStreamWriter>
 #include <QTimer>
-#include <QFileSystemWatcher>
+#include <QThread>
 
 
+#include "changenotifier.h"
 #include "datacollection.h"
 #include "debug.h"
 #include "objectstore.h"
 #include "scalar.h"
 #include "string.h"
+#include "trace.h"
 #include "nextcolor.h"
 #include "updatemanager.h"
 
@@ -83,6 +85,7 @@ Object::UpdateType DataSource::objectUpdate(qint64 newSerial) {
 
   if (!UpdateManager::self()->paused()) {
     // update the datasource
+    TRACE_SPAN_DETAIL("read", "internalDataSourceUpdate", _filename);
     updated = internalDataSourceUpdate();
 
     if (updated == Updated) {
@@ -96,6 +99,14 @@ Object::UpdateType DataSource::objectUpdate(qint64 newSerial) {
 }
 
 
+void DataSource::_initializeName() {
+  _recordInitialIndexes();
+  _color = NextColor::self().next();
+  _initializeShortName();
+  setDescriptiveName(QFileInfo(_filename).fileName() + " (" + shortName() + ')');
+}
+
+
 void DataSource::_initializeShortName() {
   _shortName = QString("DS%1").arg(_dsnum);
   if (_dsnum>max_dsnum)
@@ -139,9 +150,7 @@ DataSource::DataSource(ObjectStore *store, QSettings *cfg, const QString& filena
   interf_scalar(new NotSupportedImp<DataScalar>),
   interf_string(new NotSupportedImp<DataString>),
   interf_vector(new NotSupportedImp<DataVector>),
-  interf_matrix(new NotSupportedImp<DataMatrix>),
-  _watcher(0),
-  _color(NextColor::self().next())
+  interf_matrix(new NotSupportedImp<DataMatrix>)
 {
   Q_UNUSED(type)
   Q_UNUSED(store)
@@ -149,11 +158,13 @@ DataSource::DataSource(ObjectStore *store, QSettings *cfg, const QString& filena
   _valid = false;
   _reusable = true;
   _writable = false;
-  _watcher = 0L;
 
-  _initializeShortName();
-
-  setDescriptiveName(QFileInfo(_filename).fileName() + " (" + shortName() + ')');
+  // Sources opened on the thread pool are named once the GUI thread takes
+  // them, in document order; see DataSourcePluginManager::loadSource().
+  QCoreApplication *app = QCoreApplication::instance();
+  if (!app || QThread::currentThread() == app->thread()) {
+    _initializeName();
+  }
 
   // TODO What is the better default?
   startUpdating(File);
@@ -181,12 +192,7 @@ QMap<QString, QString> DataSource::fileMetas() const
 
 
 void DataSource::resetFileWatcher() {
-  if (_watcher) {
-    disconnect(_watcher, SIGNAL(fileChanged(QString)), this, SLOT(checkUpdate()));
-    disconnect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(checkUpdate()));
-    delete _watcher;
-    _watcher = 0L;
-  }
+  ChangeNotifier::self()->unwatch(this);
 }
 
 
@@ -228,21 +234,17 @@ void DataSource::startUpdating(UpdateCheckType updateType, const QString& file)
   if (_updateCheckType == Timer) {
     QTimer::singleShot(UpdateManager::self()->minimumUpdatePeriod()-1, this, SLOT(checkUpdate()));
   } else if (_updateCheckType == File) {
-    // TODO only works on local files:
-    // http://bugreports.qt.nokia.com/browse/QTBUG-8351
-    // http://bugreports.qt.nokia.com/browse/QTBUG-13248
-    _watcher = new QFileSystemWatcher();
-    const QString usedfile = (file.isEmpty() ? _filename : file);      
-    _watcher->addPath(usedfile);
-    connect(_watcher, SIGNAL(fileChanged(QString)), this, SLOT(checkUpdate()));
-    connect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(checkUpdate()));
+    // changes are debounced and coalesced with those of other sources;
+    // files on network file systems are polled
+    const QString usedfile = (file.isEmpty() ? _filename : file);
+    ChangeNotifier::self()->watch(this, usedfile);
   }
 }
 
 
 void DataSource::checkUpdate() {
   if (!UpdateManager::self()->paused()) {
-    UpdateManager::self()->doUpdates(false);
+    UpdateManager::self()->doSourceUpdates(this);
   }
 
   if (_updateCheckType == Timer) {
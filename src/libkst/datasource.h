@@ -35,7 +35,6 @@
 class QSettings;
 class QXmlStreamWriter;
 class QXmlStreamAttributes;
-class QFileSystemWatcher;
 
 namespace Kst {
 
@@ -249,6 +248,7 @@ class KSTCORE_EXPORT DataSource : public Object
     QString _alternateFilename;
 
     //friend class DataSourcePlugin;
+    friend class DataSourcePluginManager;
 
     /** The source type name. */
     QString _source;
@@ -260,6 +260,8 @@ class KSTCORE_EXPORT DataSource : public Object
 
     virtual QString _automaticDescriptiveName() const;
     void _initializeShortName();
+    // short name, color and descriptive name
+    void _initializeName();
 
     void setInterface(DataInterface<DataScalar>*);
     void setInterface(DataInterface<DataString>*);
@@ -276,8 +278,6 @@ class KSTCORE_EXPORT DataSource : public Object
     DataInterface<DataVector>* interf_vector;
     DataInterface<DataMatrix>* interf_matrix;
 
-    QFileSystemWatcher *_watcher;
-
     QColor _color;
 
     // NOTE: You must bump the version key if you add new member variables
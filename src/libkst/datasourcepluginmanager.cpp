@@ -19,6 +19,8 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -29,10 +31,18 @@
 #include <QXmlStreamWriter>
 #include <QTimer>
 #include <QFileSystemWatcher>
+#include <QMultiHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrentMap>
 
 #include "datacollection.h"
 #include "debug.h"
+#include "detectioncache.h"
 #include "objectstore.h"
+#include "pluginmanifest.h"
 #include "scalar.h"
 #include "string.h"
 #include "updatemanager.h"
@@ -94,24 +104,138 @@ void DataSourcePluginManager::init() {
 
 
 
-struct FoundPlugin
+namespace {
+
+// A plugin found by scanPlugins().  Plugins known from the manifest are
+// only loaded once something needs more than their name and types.
+class FoundDataSourcePlugin
 {
-  FoundPlugin(const SharedPtr<DataSourcePluginInterface>& plug, const QString& path) :
-    plugin(plug),
-    filePath(path)
-   {}
-
-  SharedPtr<DataSourcePluginInterface> plugin;
-  // TODO add filepath to PluginInterface
-  QString filePath;
+  public:
+    FoundDataSourcePlugin(const SharedPtr<DataSourcePluginInterface>& plug, const QString& path) :
+      name(plug->pluginName()),
+      provides(plug->provides()),
+      hasConfigWidget(plug->hasConfigWidget()),
+      filePath(path),
+      _loaded(new Loaded)
+    {
+      _loaded->plugin = plug;
+      _loaded->tried = true;
+    }
+
+    FoundDataSourcePlugin(const PluginManifest::Entry& entry, const QString& path) :
+      name(entry.name),
+      provides(entry.provides),
+      hasConfigWidget(entry.hasConfigWidget),
+      filePath(path),
+      _loaded(new Loaded)
+    {}
+
+    // loads the plugin if it isn't yet; 0 if it can't be loaded
+    SharedPtr<DataSourcePluginInterface> plugin() const {
+      QMutexLocker ml(&_loaded->lock);
+      if (!_loaded->tried) {
+        _loaded->tried = true;
+        if (QObject *o = PluginManifest::load(filePath)) {
+          _loaded->plugin = qobject_cast<DataSourcePluginInterface*>(o);
+        }
+      }
+      return _loaded->plugin;
+    }
+
+    QString name;
+    QStringList provides;
+    bool hasConfigWidget;
+    // TODO add filepath to PluginInterface
+    QString filePath;
+
+  private:
+    // shared by the copies in _pluginList and its snapshots
+    struct Loaded {
+      Loaded() : tried(false) {}
+      QMutex lock;
+      SharedPtr<DataSourcePluginInterface> plugin;
+      bool tried;
+    };
+    QSharedPointer<Loaded> _loaded;
 };
 
-typedef QList<FoundPlugin> PluginList;
+}
+
+typedef QList<FoundDataSourcePlugin> PluginList;
 static PluginList _pluginList;
 
+// Plugins which can't open files on several threads at once take turns.
+static QMutex serialPluginLock(QMutex::Recursive);
+
+// see openSources(); keyed by file name, type and properties
+static QMutex openedSourcesLock;
+static QList<DataSourcePluginManager::OpenRequest> openRequests;
+static QMultiHash<QString, DataSource*> openedSources;
+static QWaitCondition sourceOpened;
+
+// see detectionContext(); for the settings file named, until plugins are
+// scanned again or detectionSettingsChanged() is called.  openSource() reads
+// the same file through its own QSettings objects.
+static QMutex detectionContextLock;
+static QString detectionContextCache;
+static QString detectionContextSettings;
+
+// What detection results depend on, besides the file: the plugins and the
+// settings their understands() reads, in groups named after the types they
+// provide.  Other settings, such as the per-file ones in the same groups,
+// needn't throw away what was detected for every file.
+static QString detectionContext(const PluginList& plugins, QSettings *cfg) {
+  QMutexLocker ml(&detectionContextLock);
+  if (!detectionContextSettings.isNull() && detectionContextSettings == cfg->fileName()) {
+    return detectionContextCache;
+  }
+
+  QStringList context;
+  QByteArray settings;
+  QDataStream s(&settings, QIODevice::WriteOnly);
+  foreach (const FoundDataSourcePlugin& found, plugins) {
+    context << found.name + '@' + found.filePath;
+    DataSourcePluginInterface *p = found.plugin().data();
+    const QStringList keys = p ? p->detectionSettings() : QStringList();
+    if (keys.isEmpty()) {
+      continue;
+    }
+    foreach (const QString& type, found.provides) {
+      cfg->beginGroup(type);
+      foreach (const QString& key, keys) {
+        s << type << key << cfg->value(key);
+      }
+      cfg->endGroup();
+    }
+  }
+  context << QString::fromLatin1(QCryptographicHash::hash(settings, QCryptographicHash::Md5).toHex());
+  detectionContextCache = context.join("\n");
+  detectionContextSettings = cfg->fileName();
+  return detectionContextCache;
+}
+
+
+void DataSourcePluginManager::detectionSettingsChanged(const QString& filename) {
+  if (!filename.isEmpty()) {
+    DetectionCache::self().forget(filename);
+    return;
+  }
+  QMutexLocker ml(&detectionContextLock);
+  detectionContextSettings = QString();
+}
+
+static QString openedSourceKey(const QString& filename, const QString& type, const QXmlStreamAttributes& properties) {
+  QString key = filename + QLatin1Char('\n') + type;
+  foreach (const QXmlStreamAttribute& property, properties) {
+    key += QLatin1Char('\n') + property.qualifiedName().toString() + QLatin1Char('=') + property.value().toString();
+  }
+  return key;
+}
+
 
 void DataSourcePluginManager::cleanupForExit() {
   _pluginList.clear();
+  detectionSettingsChanged();
   qDebug() << "cleaning up for exit in datasource";
 //   for (QMap<QString,QString>::Iterator i = urlMap.begin(); i != urlMap.end(); ++i) {
 //     KIO::NetAccess::removeTempFile(i.value());
@@ -165,10 +289,12 @@ static void scanPlugins() {
   foreach (QObject *plugin, QPluginLoader::staticInstances()) {
     //try a cast
     if (DataSourcePluginInterface *ds = qobject_cast<DataSourcePluginInterface*>(plugin)) {
-      tmpList.append(FoundPlugin(ds, ""));
+      tmpList.append(FoundDataSourcePlugin(ds, ""));
     }
   }
 
+  // Only files which are new or changed since the last scan are loaded.
+  PluginManifest manifest("datasource");
   QStringList pluginPaths = pluginSearchPaths();
   foreach (const QString& pluginPath, pluginPaths) {
     QDir d(pluginPath);
@@ -177,24 +303,40 @@ static void scanPlugins() {
         if (!fileName.endsWith(QLatin1String(".dll")))
             continue;
 #endif
-        QPluginLoader loader(d.absoluteFilePath(fileName));
+        const QFileInfo file(d.absoluteFilePath(fileName));
+        PluginManifest::Entry entry;
+        if (manifest.lookup(file, &entry)) {
+          if (entry.isPlugin) {
+            tmpList.append(FoundDataSourcePlugin(entry, file.absoluteFilePath()));
+            Debug::self()->log(DataSource::tr("Plugin found: %1").arg(fileName));
+          }
+          continue;
+        }
+
+        QPluginLoader loader(file.absoluteFilePath());
         QObject *plugin = loader.instance();
         if (plugin) {
           if (DataSourcePluginInterface *ds = qobject_cast<DataSourcePluginInterface*>(plugin)) {
-
-            tmpList.append(FoundPlugin(ds, d.absoluteFilePath(fileName)));
+            entry.isPlugin = true;
+            entry.name = ds->pluginName();
+            entry.provides = ds->provides();
+            entry.hasConfigWidget = ds->hasConfigWidget();
+            tmpList.append(FoundDataSourcePlugin(ds, file.absoluteFilePath()));
             Debug::self()->log(DataSource::tr("Plugin loaded: %1").arg(fileName));
           }
+          manifest.insert(file, entry);
         } else {
             Debug::self()->log(DataSource::tr("instance failed for %1 (%2)").arg(fileName).arg(loader.errorString()));
         }
     }
   }
+  manifest.save();
 
   // This cleans up plugins that have been uninstalled and adds in new ones.
   // Since it is a shared pointer it can't dangle anywhere.
   _pluginList.clear();
   _pluginList = tmpList;
+  DataSourcePluginManager::detectionSettingsChanged();
 }
 
 void DataSourcePluginManager::initPlugins() {
@@ -210,7 +352,7 @@ QStringList DataSourcePluginManager::pluginList() {
 
   QStringList plugins;
   for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    plugins += (*it).plugin->pluginName();
+    plugins += (*it).name;
   }
 
   return plugins;
@@ -220,7 +362,7 @@ QStringList DataSourcePluginManager::pluginList() {
 QString DataSourcePluginManager::pluginFileName(const QString& pluginName)
 {
   for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if (it->plugin->pluginName() == pluginName) {
+    if (it->name == pluginName) {
       return it->filePath;
     }
   }
@@ -237,17 +379,20 @@ int DataSourcePluginManager::PluginSortContainer::operator==(const PluginSortCon
 
 
 
-QList<DataSourcePluginManager::PluginSortContainer> DataSourcePluginManager::bestPluginsForSource(const QString& filename, const QString& type) {
+QList<DataSourcePluginManager::PluginSortContainer> DataSourcePluginManager::bestPluginsForSource(const QString& filename, const QString& type, QSettings *cfg) {
 
   QList<PluginSortContainer> bestPlugins;
   DataSourcePluginManager::init();
+  if (!cfg) {
+    cfg = &settingsObject();
+  }
 
   PluginList info = _pluginList;
 
   if (!type.isEmpty()) {
     for (PluginList::Iterator it = info.begin(); it != info.end(); ++it) {
-      if (DataSourcePluginInterface *p = (*it).plugin.data()) {
-        if (p->provides(type)) {
+      if ((*it).provides.contains(type)) {
+        if (DataSourcePluginInterface *p = (*it).plugin().data()) {
           PluginSortContainer psc;
           psc.match = 100;
           psc.plugin = p;
@@ -258,10 +403,32 @@ QList<DataSourcePluginManager::PluginSortContainer> DataSourcePluginManager::bes
     }
   }
 
+  DetectionCache& cache = DetectionCache::self();
+  cache.setContext(detectionContext(info, cfg));
+  const DetectionCache::Probe probe = DetectionCache::probe(filename);
+  DetectionCache::Matches matches;
+  if (cache.lookup(probe, &matches)) {
+    for (DetectionCache::Matches::ConstIterator m = matches.constBegin(); m != matches.constEnd(); ++m) {
+      for (PluginList::Iterator it = info.begin(); it != info.end(); ++it) {
+        if ((*it).name == (*m).first) {
+          PluginSortContainer psc;
+          psc.plugin = (*it).plugin();
+          psc.match = (*m).second;
+          if (psc.plugin) {
+            bestPlugins.append(psc);
+          }
+          break;
+        }
+      }
+    }
+    return bestPlugins;
+  }
+
   for (PluginList::Iterator it = info.begin(); it != info.end(); ++it) {
     PluginSortContainer psc;
-    if (DataSourcePluginInterface *p = (*it).plugin.data()) {
-      if ((psc.match = p->understands(&settingsObject(), filename)) > 0) {
+    if (DataSourcePluginInterface *p = (*it).plugin().data()) {
+      QMutexLocker ml(p->concurrentOpen() ? 0L : &serialPluginLock);
+      if ((psc.match = p->understands(cfg, filename)) > 0) {
         psc.plugin = p;
         bestPlugins.append(psc);
       }
@@ -270,6 +437,11 @@ QList<DataSourcePluginManager::PluginSortContainer> DataSourcePluginManager::bes
 
   qSort(bestPlugins);
 
+  foreach (const PluginSortContainer& psc, bestPlugins) {
+    matches.append(qMakePair(psc.plugin->pluginName(), psc.match));
+  }
+  cache.insert(probe, matches);
+
   return bestPlugins;
 }
 
@@ -282,45 +454,132 @@ DataSourcePtr DataSourcePluginManager::findPluginFor(ObjectStore *store, const Q
   for (QList<PluginSortContainer>::Iterator i = bestPlugins.begin(); i != bestPlugins.end(); ++i) {
     DataSourcePtr plugin = (*i).plugin->create(store, &settingsObject(), filename, QString(), e);
     if (plugin) {
+      createSlavePrimitives(store, plugin);
+      return plugin;
+    }
+  }
+  return 0L;
+}
 
-      // add strings
-      const QStringList strings = plugin->string().list();
-      if (!strings.isEmpty()) {
-        foreach(const QString& key, strings) {
-          QString value;
-          DataString::ReadInfo readInfo(&value);
-          plugin->string().read(key, readInfo);
-          StringPtr s = store->createObject<String>();
-          s->setProvider(plugin);
-          s->setSlaveName(key);
-          s->setValue(value);
-          plugin->slavePrimitives.append(s);
-        }
-      }
 
-      // add scalars
-      const QStringList scalars = plugin->scalar().list();
-      if (!scalars.isEmpty()) {
-        foreach(const QString& key, scalars) {
-          double value;
-          DataScalar::ReadInfo readInfo(&value);
-          plugin->scalar().read(key, readInfo);
-          ScalarPtr s = store->createObject<Scalar>();
-          s->setProvider(plugin);
-          s->setSlaveName(key);
-          plugin->slavePrimitives.append(s);
-          s->setValue(value);
-        }
-      }
+void DataSourcePluginManager::createSlavePrimitives(ObjectStore *store, DataSourcePtr plugin) {
+  // add strings
+  const QStringList strings = plugin->string().list();
+  if (!strings.isEmpty()) {
+    foreach(const QString& key, strings) {
+      QString value;
+      DataString::ReadInfo readInfo(&value);
+      plugin->string().read(key, readInfo);
+      StringPtr s = store->createObject<String>();
+      s->setProvider(plugin);
+      s->setSlaveName(key);
+      s->setValue(value);
+      plugin->slavePrimitives.append(s);
+    }
+  }
 
-      return plugin;
+  // add scalars
+  const QStringList scalars = plugin->scalar().list();
+  if (!scalars.isEmpty()) {
+    foreach(const QString& key, scalars) {
+      double value;
+      DataScalar::ReadInfo readInfo(&value);
+      plugin->scalar().read(key, readInfo);
+      ScalarPtr s = store->createObject<Scalar>();
+      s->setProvider(plugin);
+      s->setSlaveName(key);
+      plugin->slavePrimitives.append(s);
+      s->setValue(value);
     }
   }
-  return 0L;
+}
+
+
+QFuture<void> DataSourcePluginManager::openSources(ObjectStore *store, const QStringList& filenames, const QStringList& types,
+                                                   const QList<QXmlStreamAttributes>& properties) {
+  Q_ASSERT(filenames.count() == types.count() && filenames.count() == properties.count());
+  clearOpenedSources();
+
+  // scan for plugins and create the settings here, not on the pool
+  DataSourcePluginManager::init();
+  settingsObject().sync();
+
+  QMutexLocker ml(&openedSourcesLock);
+  for (int i = 0; i < filenames.count(); ++i) {
+    OpenRequest request;
+    request.store = store;
+    request.filename = obtainFile(filenames.at(i));
+    request.type = types.at(i);
+    request.properties = properties.at(i);
+    if (!request.filename.isEmpty() && QFileInfo(request.filename).exists()) {
+      openRequests.append(request);
+    }
+  }
+  return QtConcurrent::map(openRequests, openSource);
+}
+
+
+// Runs on the thread pool.
+void DataSourcePluginManager::openSource(const OpenRequest& request) {
+  // QSettings objects can't be shared between threads; the source gets the
+  // shared one once it is open
+  QSettings cfg(settingsObject().fileName(), settingsObject().format());
+
+  QList<PluginSortContainer> bestPlugins = bestPluginsForSource(request.filename, request.type, &cfg);
+  for (QList<PluginSortContainer>::Iterator i = bestPlugins.begin(); i != bestPlugins.end(); ++i) {
+    DataSourcePluginInterface *p = (*i).plugin.data();
+    QMutexLocker pl(p->concurrentOpen() ? 0L : &serialPluginLock);
+    DataSource *dataSource = p->create(request.store, &cfg, request.filename, QString(), QDomElement());
+    if (dataSource) {
+      // for ascii this is the scan with the saved settings
+      QXmlStreamAttributes properties = request.properties;
+      dataSource->parseProperties(properties);
+      dataSource->_cfg = &settingsObject();
+      if (QCoreApplication::instance()) {
+        dataSource->moveToThread(QCoreApplication::instance()->thread());
+      }
+      QMutexLocker ml(&openedSourcesLock);
+      openedSources.insert(openedSourceKey(request.filename, request.type, request.properties), dataSource);
+      sourceOpened.wakeAll();
+      return;
+    }
+  }
+  QMutexLocker ml(&openedSourcesLock);
+  sourceOpened.wakeAll();
+}
+
+
+void DataSourcePluginManager::waitForOpenedSource(unsigned long msecs) {
+  QMutexLocker ml(&openedSourcesLock);
+  sourceOpened.wait(&openedSourcesLock, msecs);
+}
+
+
+// Drops the sources opened by openSources() which loadSource() hasn't
+// handed out.  Call it once the future has finished.
+void DataSourcePluginManager::clearOpenedSources() {
+  QList<DataSource*> unused;
+  {
+    QMutexLocker ml(&openedSourcesLock);
+    unused = openedSources.values();
+    openedSources.clear();
+    openRequests.clear();
+  }
+  foreach (DataSource *dataSource, unused) {
+    DataSourcePtr drop(dataSource);
+  }
 }
 
 
 DataSourcePtr DataSourcePluginManager::loadSource(ObjectStore *store, const QString& filename, const QString& type) {
+  bool parsed;
+  return loadSource(store, filename, type, QXmlStreamAttributes(), &parsed);
+}
+
+
+DataSourcePtr DataSourcePluginManager::loadSource(ObjectStore *store, const QString& filename, const QString& type,
+                                                  const QXmlStreamAttributes& properties, bool *parsed) {
+  *parsed = false;
 
 #ifndef Q_OS_WIN32
   //if (filename == "stdin" || filename == "-") {
@@ -338,7 +597,23 @@ DataSourcePtr DataSourcePluginManager::loadSource(ObjectStore *store, const QStr
     return 0;
   }
 
-  DataSourcePtr dataSource = findPluginFor(store, fn, type);
+  DataSourcePtr dataSource;
+  {
+    QMutexLocker ml(&openedSourcesLock);
+    dataSource = openedSources.take(openedSourceKey(fn, type, properties));
+  }
+  if (dataSource) {
+    *parsed = true;
+    // named here, so that names follow the document and not the pool
+    dataSource->_initializeName();
+    createSlavePrimitives(store, dataSource);
+    // timers started on the pool never fire
+    if (dataSource->updateType() == DataSource::Timer) {
+      dataSource->startUpdating(DataSource::Timer);
+    }
+  } else {
+    dataSource = findPluginFor(store, fn, type);
+  }
   if (dataSource) {
     store->addObject<DataSource>(dataSource);
   }
@@ -371,19 +646,7 @@ bool DataSourcePluginManager::validSource(const QString& filename) {
     return false;
   }
 
-  DataSourcePluginManager::init();
-
-  PluginList info = _pluginList;
-
-  for (PluginList::Iterator it = info.begin(); it != info.end(); ++it) {
-    if (DataSourcePluginInterface *p = (*it).plugin.data()) {
-      if ((p->understands(&settingsObject(), filename)) > 0) {
-        return true;
-      }
-    }
-  }
-
-  return false;
+  return !bestPluginsForSource(fn, QString()).isEmpty();
 }
 
 
@@ -394,8 +657,8 @@ bool DataSourcePluginManager::pluginHasConfigWidget(const QString& plugin) {
   PluginList info = _pluginList;
 
   for (PluginList::ConstIterator it = info.constBegin(); it != info.constEnd(); ++it) {
-    if ((*it).plugin->pluginName() == plugin) {
-      return (*it).plugin->hasConfigWidget();
+    if ((*it).name == plugin) {
+      return (*it).hasConfigWidget;
     }
   }
 
@@ -409,8 +672,8 @@ DataSourceConfigWidget* DataSourcePluginManager::configWidgetForPlugin(const QSt
   PluginList info = _pluginList;
 
   for (PluginList::Iterator it = info.begin(); it != info.end(); ++it) {
-    if (DataSourcePluginInterface *p = (*it).plugin.data()) {
-      if (p->pluginName() == plugin) {
+    if ((*it).name == plugin) {
+      if (DataSourcePluginInterface *p = (*it).plugin().data()) {
         return p->configWidget(&settingsObject(), QString());
       }
     }
@@ -18,6 +18,7 @@
 #include "sharedptr.h"
 #include "datasource.h"
 
+#include <QFuture>
 #include <QSettings>
 #include <QMap>
 
@@ -44,10 +45,35 @@ class KSTCORE_EXPORT DataSourcePluginManager
     static QString pluginFileName(const QString& pluginName);
 
     static SharedPtr<DataSource> loadSource(ObjectStore *store, const QString& filename, const QString& type = QString());
+    /** For a source saved in a session with the given <properties>: parsed
+        is set if openSources() opened it, and so has already handed it the
+        properties (DataSource::parseProperties()). */
+    static SharedPtr<DataSource> loadSource(ObjectStore *store, const QString& filename, const QString& type,
+                                            const QXmlStreamAttributes& properties, bool *parsed);
     static SharedPtr<DataSource> loadSource(ObjectStore *store, QDomElement& e);
     static SharedPtr<DataSource> findOrLoadSource(ObjectStore *store, const QString& filename);
+
+    /** Opens the files, with the plugins for the matching types, on the
+        global thread pool; for loading sessions.  The sources are handed
+        their saved properties there too, so that the scans these start
+        overlap as well.  Until clearOpenedSources(), loadSource() hands out
+        the sources opened this way instead of opening the files again, and
+        adds them to the store in the calling thread. */
+    static QFuture<void> openSources(ObjectStore *store, const QStringList& filenames, const QStringList& types,
+                                     const QList<QXmlStreamAttributes>& properties);
+    static void clearOpenedSources();
+    /** Blocks until a source requested from openSources() has been tried,
+        or msecs have passed. */
+    static void waitForOpenedSource(unsigned long msecs);
+
     static bool validSource(const QString& filename);
 
+    /** Forgets which plugins understand files, after settings which
+        understands() reads (DataSourcePluginInterface::detectionSettings())
+        changed: for every file, or only for filename if the settings are
+        that file's own. */
+    static void detectionSettingsChanged(const QString& filename = QString());
+
     static bool sourceHasConfigWidget(const QString& filename, const QString& type = QString());
     static DataSourceConfigWidget *configWidgetForSource(const QString& filename, const QString& type = QString());
 
@@ -70,8 +96,17 @@ class KSTCORE_EXPORT DataSourcePluginManager
       int operator<(const PluginSortContainer& x) const;
       int operator==(const PluginSortContainer& x) const;
     };
-    static QList<PluginSortContainer> bestPluginsForSource(const QString& filename, const QString& type);
+    static QList<PluginSortContainer> bestPluginsForSource(const QString& filename, const QString& type, QSettings *cfg = 0L);
     static DataSourcePtr findPluginFor(ObjectStore *store, const QString& filename, const QString& type, const QDomElement& e = QDomElement());
+    static void createSlavePrimitives(ObjectStore *store, DataSourcePtr dataSource);
+
+    struct OpenRequest {
+      ObjectStore *store;
+      QString filename;
+      QString type;
+      QXmlStreamAttributes properties;
+    };
+    static void openSource(const OpenRequest& request);
 };
 
 }
@@ -134,6 +134,14 @@ qint64 DataString::maxInputSerialOfLastChange() const {
   return NoInputs;
 }
 
+QList<Object*> DataString::inputObjects() const {
+  QList<Object*> inputs;
+  if (dataSource()) {
+    inputs.append(dataSource().data());
+  }
+  return inputs;
+}
+
 
 
 PrimitivePtr DataString::makeDuplicate() const {
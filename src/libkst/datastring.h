@@ -44,6 +44,7 @@ class KSTCORE_EXPORT DataString : public String, public DataPrimitive
     /** Update the string */
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
   public:
     virtual ~DataString();
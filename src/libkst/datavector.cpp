@@ -25,11 +25,15 @@
 #include <QDebug>
 #include <QXmlStreamWriter>
 
+#include <limits>
+
 #include "datacollection.h"
 #include "debug.h"
 #include "datasource.h"
 #include "math_kst.h"
+#include "memorybudget.h"
 #include "objectstore.h"
+#include "trace.h"
 #include "updatemanager.h"
 
 // ReqNF <=0 means read from ReqF0 to end of File
@@ -76,6 +80,13 @@ DataVector::DataVector(ObjectStore *store)
   N_AveReadBuf = 0;
   AveReadBuf = 0L;
 
+  _storageType = DoubleStorage;
+  _storageScale = 1.0;
+  _storageOffset = 0.0;
+  _compact = 0L;
+  _viewLease = 0;
+  _viewRead = false;
+
   ReqF0 = 0;
   ReqNF = -1;
   Skip = 1;
@@ -159,6 +170,14 @@ qint64 DataVector::maxInputSerialOfLastChange() const {
   return NoInputs;
 }
 
+QList<Object*> DataVector::inputObjects() const {
+  QList<Object*> inputs;
+  if (dataSource()) {
+    inputs.append(dataSource().data());
+  }
+  return inputs;
+}
+
 
 void DataVector::changeFile(DataSourcePtr in_file) {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
@@ -226,6 +245,300 @@ DataVector::~DataVector() {
     free(AveReadBuf);
     AveReadBuf = 0L;
   }
+  MemoryBudget::self()->release(_compact);
+  _compact = 0L;
+}
+
+
+// Compact storage.  The integer types use their lowest value for NaN.
+template<class T>
+static inline void storeSample(double v, T *out, double scale, double offset) {
+  if (v != v) {
+    *out = std::numeric_limits<T>::min();
+    return;
+  }
+  const double x = floor((v - offset)/scale + 0.5);
+  *out = T(qBound(double(std::numeric_limits<T>::min()) + 1.0, x, double(std::numeric_limits<T>::max())));
+}
+
+
+static inline void storeSample(double v, float *out, double, double) {
+  *out = float(v);
+}
+
+
+template<class T>
+static inline double loadSample(const T *in, double scale, double offset) {
+  return *in == std::numeric_limits<T>::min() ? NOPOINT : double(*in)*scale + offset;
+}
+
+
+static inline double loadSample(const float *in, double, double) {
+  return *in;
+}
+
+
+template<class T>
+static void packSamples(const double *v, int n, char *out, double scale, double offset) {
+  T *t = reinterpret_cast<T*>(out);
+  for (int i = 0; i < n; ++i) {
+    storeSample(v[i], t + i, scale, offset);
+  }
+}
+
+
+template<class T>
+static void unpackSamples(const char *in, int n, double *v, double scale, double offset) {
+  const T *t = reinterpret_cast<const T*>(in);
+  for (int i = 0; i < n; ++i) {
+    v[i] = loadSample(t + i, scale, offset);
+  }
+}
+
+
+template<class T>
+static void roundSamples(double *v, int n, double scale, double offset) {
+  T t;
+  for (int i = 0; i < n; ++i) {
+    storeSample(v[i], &t, scale, offset);
+    v[i] = loadSample(&t, scale, offset);
+  }
+}
+
+
+static size_t storageSize(DataVector::StorageType type) {
+  switch (type) {
+    case DataVector::FloatStorage:
+      return sizeof(float);
+    case DataVector::Int16Storage:
+      return sizeof(qint16);
+    case DataVector::Int32Storage:
+      return sizeof(qint32);
+    default:
+      return sizeof(double);
+  }
+}
+
+
+// number of updates a view stays unpacked after something read it
+static const int ViewLease = 16;
+
+// _viewPending: packed, or unpacked but no read noticed since the update
+enum { ViewUnpacked = 0, ViewPacked = 1, ViewUnread = 2 };
+
+
+void DataVector::setStorage(StorageType type, double scale, double offset) {
+  Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
+
+  if (scale == 0.0 || scale != scale) {
+    scale = 1.0;
+  }
+  if (type == _storageType && scale == _storageScale && offset == _storageOffset) {
+    return;
+  }
+
+  {
+    QMutexLocker ml(&_viewLock);
+    if (_viewPending.fetchAndAddAcquire(0) == ViewPacked) {
+      unpackView(false);
+    }
+    _viewPending.fetchAndStoreRelease(ViewUnpacked);
+    _viewRead = false;
+    _viewLease = 0;
+  }
+  _storageType = type;
+  _storageScale = scale;
+  _storageOffset = offset;
+
+  // the samples held were rounded for the old type: read them again
+  if (dataSource()) {
+    dataSource()->writeLock();
+  }
+  reset();
+  if (dataSource()) {
+    dataSource()->unlock();
+  }
+  registerChange();
+}
+
+
+DataVector::StorageType DataVector::storageType() const {
+  return _storageType;
+}
+
+
+double DataVector::storageScale() const {
+  return _storageScale;
+}
+
+
+double DataVector::storageOffset() const {
+  return _storageOffset;
+}
+
+
+QString DataVector::storageTypeName(StorageType type) {
+  switch (type) {
+    case FloatStorage:
+      return "float32";
+    case Int16Storage:
+      return "int16";
+    case Int32Storage:
+      return "int32";
+    default:
+      return "double";
+  }
+}
+
+
+DataVector::StorageType DataVector::storageTypeFromName(const QString& name) {
+  if (name == "float32") {
+    return FloatStorage;
+  } else if (name == "int16") {
+    return Int16Storage;
+  } else if (name == "int32") {
+    return Int32Storage;
+  }
+  return DoubleStorage;
+}
+
+
+// Only the samples from on were read in this update; the ones kept from
+// before were rounded when they were read.
+void DataVector::roundToStorage(int from) {
+  from = qBound(0, from, _size);
+  switch (_storageType) {
+    case FloatStorage:
+      roundSamples<float>(_v + from, _size - from, _storageScale, _storageOffset);
+      break;
+    case Int16Storage:
+      roundSamples<qint16>(_v + from, _size - from, _storageScale, _storageOffset);
+      break;
+    case Int32Storage:
+      roundSamples<qint32>(_v + from, _size - from, _storageScale, _storageOffset);
+      break;
+    default:
+      break;
+  }
+}
+
+
+// Called at the end of an update: packs the samples and gives back the
+// doubles, unless something read them in the last ViewLease updates.
+void DataVector::packView() {
+  if (_storageType == DoubleStorage) {
+    return;
+  }
+
+  QMutexLocker ml(&_viewLock);
+  if (_viewRead) {
+    _viewRead = false;
+    _viewLease = ViewLease;
+  } else if (_viewLease > 0) {
+    --_viewLease;
+  } else if (MemoryBudget::self()->reallocate(_compact, size_t(_size)*storageSize(_storageType), this)) {
+    switch (_storageType) {
+      case FloatStorage:
+        packSamples<float>(_v, _size, _compact, _storageScale, _storageOffset);
+        break;
+      case Int16Storage:
+        packSamples<qint16>(_v, _size, _compact, _storageScale, _storageOffset);
+        break;
+      case Int32Storage:
+        packSamples<qint32>(_v, _size, _compact, _storageScale, _storageOffset);
+        break;
+      default:
+        break;
+    }
+
+    double *base = _v - _vOffset;
+    if (MemoryBudget::self()->reallocate(base, sizeof(double), this)) {
+      _v = base;
+      _vOffset = 0;
+      _vCapacity = 1;
+    } else {
+      _v = base;
+      _vOffset = 0;
+    }
+    _viewPending.fetchAndStoreRelease(ViewPacked);
+    return;
+  }
+
+  // have materialize() notice the next read, which renews the lease
+  _viewPending.fetchAndStoreRelease(ViewUnread);
+}
+
+
+// The lock is held.
+void DataVector::unpackView(bool demanded) {
+  const int capacity = _windowHeadroom ? 2*_size : _size;
+  double *base = _v;
+  if (!MemoryBudget::self()->reallocate(base, size_t(capacity)*sizeof(double), this)) {
+    Debug::self()->log(Debug::Error, "%1: not enough memory to unpack the vector data", Name());
+    dropSamples();
+    _viewPending.fetchAndStoreRelease(ViewUnpacked);
+    return;
+  }
+  _v = base;
+  _vOffset = 0;
+  _vCapacity = capacity;
+
+  switch (_storageType) {
+    case FloatStorage:
+      unpackSamples<float>(_compact, _size, _v, _storageScale, _storageOffset);
+      break;
+    case Int16Storage:
+      unpackSamples<qint16>(_compact, _size, _v, _storageScale, _storageOffset);
+      break;
+    case Int32Storage:
+      unpackSamples<qint32>(_compact, _size, _v, _storageScale, _storageOffset);
+      break;
+    default:
+      break;
+  }
+  MemoryBudget::self()->release(_compact);
+  _compact = 0L;
+
+  if (demanded) {
+    _viewLease = ViewLease;
+  }
+  _viewPending.fetchAndStoreRelease(ViewUnpacked);
+}
+
+
+// The lock is held.  Goes on without the samples; the next update reads
+// them all again.
+void DataVector::dropSamples() {
+  MemoryBudget::self()->release(_compact);
+  _compact = 0L;
+  _size = 0;
+  F0 = NF = 0;
+  _numSamples = 0;
+  NumNew = NumShifted = 0;
+  _dirty = true;
+}
+
+
+void DataVector::settleStorage(bool shown) {
+  QMutexLocker ml(&_viewLock);
+  MemoryBudget::self()->settle(_compact, shown, this);
+  Vector::settleStorage(shown);
+}
+
+
+void DataVector::materialize() const {
+  QMutexLocker ml(&_viewLock);
+  switch (_viewPending.fetchAndAddAcquire(0)) {
+    case ViewPacked:
+      const_cast<DataVector*>(this)->unpackView(true);
+      break;
+    case ViewUnread:
+      _viewRead = true;
+      _viewPending.fetchAndStoreRelease(ViewUnpacked);
+      break;
+    default:
+      break;
+  }
 }
 
 
@@ -300,6 +613,14 @@ void DataVector::save(QXmlStreamWriter &s) {
     s.writeAttribute("startUnits", startUnits());
     s.writeAttribute("rangeUnits", rangeUnits());
 
+    if (_storageType != DoubleStorage) {
+      s.writeAttribute("storage", storageTypeName(_storageType));
+      if (_storageType != FloatStorage) {
+        s.writeAttribute("storageScale", QString::number(_storageScale, 'g', 17));
+        s.writeAttribute("storageOffset", QString::number(_storageOffset, 'g', 17));
+      }
+    }
+
     saveNameInfo(s, VNUM|XNUM);
     s.writeEndElement();
   }
@@ -439,6 +760,14 @@ void DataVector::internalUpdate() {
     DoSkip = false;
   }
 
+  // compact samples are unpacked for the update, and packed again after it
+  {
+    QMutexLocker ml(&_viewLock);
+    if (_viewPending.fetchAndAddAcquire(0) == ViewPacked) {
+      unpackView(false);
+    }
+  }
+
 
   // set new_nf and new_f0
   int fc = info.frameCount;
@@ -473,9 +802,13 @@ void DataVector::internalUpdate() {
     new_nf = (new_nf/Skip)*Skip;
   }
 
+  // a vector counting back from the end of the file scrolls on every update
+  setWindowHeadroom(ReqF0 < 0 && ReqNF > 0);
+
   // shift vector if necessary
   if (new_f0 < F0 || new_f0 >= F0 + NF) { // No useful data around.
     reset();
+    NumShifted = 0;
   } else { // shift stuff rather than re-read
     if (DoSkip) {
       shift = (new_f0 - F0)/Skip;
@@ -487,15 +820,20 @@ void DataVector::internalUpdate() {
       _numSamples = (NF-1)*SPF;
     }
 
-    memmove(_v, _v+shift, _numSamples*sizeof(double));
+    shiftLeft(shift, _numSamples);
+    NumShifted = shift;
   }
 
   if (DoSkip) {
     // reallocate V if necessary
     if (new_nf / Skip != _size) {
-      if (! resize(new_nf/Skip)) {
-        // TODO: Is aborting all we can do?
-        fatalError("Not enough memory for vector data");
+      if (!resize(new_nf/Skip)) {
+        // the memory budget already tried a mapped file
+        Debug::self()->log(Debug::Error, "%1: not enough memory for the vector data", Name());
+        dropSamples();
+        if (dataSource()) {
+          dataSource()->unlock();
+        }
         return;
       }
     }
@@ -563,8 +901,12 @@ void DataVector::internalUpdate() {
     // reallocate V if necessary
     if ((new_nf - 1)*SPF + 1 != _size) {
       if (!resize((new_nf - 1)*SPF + 1)) {
-        // TODO: Is aborting all we can do?
-        fatalError("Not enough memory for vector data");
+        // the memory budget already tried a mapped file
+        Debug::self()->log(Debug::Error, "%1: not enough memory for the vector data", Name());
+        dropSamples();
+        if (dataSource()) {
+          dataSource()->unlock();
+        }
         return;
       }
     }
@@ -624,7 +966,11 @@ void DataVector::internalUpdate() {
     dataSource()->unlock();
   }
 
+  roundToStorage(_size - NumNew);
+
   Vector::internalUpdate();
+
+  packView();
 }
 
 QByteArray DataVector::scriptInterface(QList<QByteArray> &c)
@@ -781,6 +1127,7 @@ PrimitivePtr DataVector::makeDuplicate() const {
 
   vector->writeLock();
   vector->change(dataSource(), _field, ReqF0, ReqNF, Skip, DoSkip, DoAve);
+  vector->setStorage(_storageType, _storageScale, _storageOffset);
   if (descriptiveNameIsManual()) {
     vector->setDescriptiveName(descriptiveName());
   }
@@ -835,6 +1182,7 @@ QString DataVector::propertyString() const {
 
 int DataVector::readField(double *v, const QString& field, int s, int n, int skip)
 {
+  TRACE_SPAN_DETAIL("read", "readField", field);
   ReadInfo par = {v, s, n, skip};
   return dataSource()->vector().read(field, par);
 }
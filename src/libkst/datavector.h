@@ -18,6 +18,8 @@
 #ifndef DATAVECTOR_H
 #define DATAVECTOR_H
 
+#include <QMutex>
+
 #include "kst_export.h"
 #include "dataprimitive.h"
 #include "vector.h"
@@ -69,6 +71,8 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
 
     virtual void reset(); // must be called with a lock
 
+    virtual void settleStorage(bool shown);
+
     /** change the properties of a DataVector */
     void change(DataSourcePtr file, const QString &field,
                 int f0, int n, int skip,
@@ -139,6 +143,25 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
     /** does the vector represent time? */
     virtual bool isTime() const;
 
+    enum StorageType { DoubleStorage, FloatStorage, Int16Storage, Int32Storage };
+
+    /** Keep the samples as type while nothing reads the vector, to save
+        memory.  This is for vectors which are loaded but not shown, such
+        as the ones only plotted on hidden tabs: a vector read at least once
+        every 16 updates, as every plotted one is, stays unpacked, and data
+        sources, statistics and plots all work on doubles.  The integer
+        types hold (value - offset)/scale, rounded.  Samples are rounded to
+        the storage type as they are read, so the values do not depend on
+        whether they are currently packed.  Off (DoubleStorage) unless the
+        vector dialog or the session asks for it. */
+    void setStorage(StorageType type, double scale = 1.0, double offset = 0.0);
+    StorageType storageType() const;
+    double storageScale() const;
+    double storageOffset() const;
+
+    static QString storageTypeName(StorageType type);
+    static StorageType storageTypeFromName(const QString& name);
+
   protected:
     DataVector(ObjectStore *store);
     virtual ~DataVector();
@@ -151,6 +174,9 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
 
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
+
+    virtual void materialize() const;
 
   private:
     virtual void _resetFieldScalars();
@@ -190,6 +216,24 @@ class KSTCORE_EXPORT DataVector : public Vector, public DataPrimitive
     int N_AveReadBuf;
     double *AveReadBuf;
 
+    StorageType _storageType;
+    double _storageScale;
+    double _storageOffset;
+
+    /** the samples while _viewPending is set */
+    char *_compact;
+
+    /** updates left before a view that was asked for is packed again */
+    int _viewLease;
+    /** something read the samples since the last update; renews the lease */
+    mutable bool _viewRead;
+    mutable QMutex _viewLock;
+
+    void roundToStorage(int from);
+    void packView();
+    void unpackView(bool demanded);
+    void dropSamples();
+
     bool checkIntegrity(); // must be called with a lock
 
     //bool _dontUseSkipAccel;
@@ -54,12 +54,12 @@ Debug::Debug()
 : QObject() {
   _applyLimit = false;
   _limit = 10000;
+  _records = new LogRecord[Capacity];
 #ifdef KST_REVISION
   _kstRevision = QString::fromLatin1(KST_REVISION);
 #else
   _kstRevision = -1;
 #endif
-  _hasNewError = false;
 }
 
 
@@ -70,6 +70,7 @@ Debug::~Debug() {
     qDebug() << i.key() << ": " << i.value() << endl;
   }
 #endif
+  delete[] _records;
 }
 
 
@@ -86,41 +87,121 @@ QStringList Debug::dataSourcePlugins() const {
 
 void Debug::setHandler(QObject *handler) {
   _handler = handler;
+  _handlerNotified.fetchAndStoreOrdered(0);
 }
 
 
-void Debug::log(const QString& msg, LogLevel level) {
-  QMutexLocker ml(&_lock);
-  LogMessage message;
+void Debug::handlerNotified() {
+  _handlerNotified.fetchAndStoreOrdered(0);
+}
 
-  message.date  = QDateTime::currentDateTime();
-  message.msg   = msg;
-  message.level = level;
 
-  _messages.append(message);
-  if (_applyLimit && int(_messages.size()) > _limit) {
-    QList<LogMessage>::Iterator first = _messages.begin();
-    QList<LogMessage>::Iterator last = first;
-    last += _messages.size() - _limit;
-    _messages.erase(first, last);
+Debug::LogRecord *Debug::beginRecord(LogLevel level) {
+  const uint seq = uint(_written.fetchAndAddOrdered(1));
+  LogRecord *record = &_records[seq & (Capacity - 1)];
+  while (!record->state.testAndSetAcquire(SlotFree, SlotWriting)) {
+    QThread::yieldCurrentThread();
   }
+  record->seq = seq;
+  record->msecs = QDateTime::currentMSecsSinceEpoch();
+  record->level = level;
+  return record;
+}
+
+
+void Debug::endRecord(LogRecord *record) {
+  const LogLevel level = record->level;
+  record->state.fetchAndStoreRelease(SlotFree);
 
   if (level == Error) {
-    _hasNewError = true;
+    _errorCount.fetchAndAddRelaxed(1);
+    _hasNewError.fetchAndStoreRelaxed(1);
   }
 
-  if (_handler) {
-    LogEvent *e = new LogEvent(LogEvent::LogAdded);
-    e->_msg = message;
-    QApplication::postEvent(_handler, e);
+  // the handler formats what it shows itself, when it shows it
+  if (_handler && _handlerNotified.testAndSetOrdered(0, 1)) {
+    QApplication::postEvent(_handler, new LogEvent(LogEvent::LogAdded));
   }
 }
 
 
-void Debug::clear() {
-  clearHasNewError(); // has to be before the lock is acquired
+void Debug::log(const QString& msg, LogLevel level) {
+  LogRecord *record = beginRecord(level);
+  record->format = 0L;
+  record->msg = msg;
+  record->argCount = 0;
+  endRecord(record);
+}
+
+
+void Debug::log(LogLevel level, const char *format, const QVariant& a1, const QVariant& a2, const QVariant& a3, const QVariant& a4) {
+  LogRecord *record = beginRecord(level);
+  record->format = format;
+  record->msg.clear();
+  record->args[0] = a1;
+  record->args[1] = a2;
+  record->args[2] = a3;
+  record->args[3] = a4;
+  record->argCount = a4.isValid() ? 4 : a3.isValid() ? 3 : a2.isValid() ? 2 : a1.isValid() ? 1 : 0;
+  endRecord(record);
+}
+
+
+QString Debug::formatRecord(const LogRecord& record) {
+  if (!record.format) {
+    return record.msg;
+  }
+  QString msg = QString::fromUtf8(record.format);
+  for (int i = 0; i < record.argCount; ++i) {
+    msg = msg.arg(record.args[i].toString());
+  }
+  return msg;
+}
+
+
+Debug::RecordState Debug::readRecord(uint seq, LogMessage& message) const {
+  LogRecord *record = &_records[seq & (Capacity - 1)];
+  // another reader only holds the slot for a copy; a writer may hold it for
+  // longer, and whoever waits for the message hears from endRecord()
+  while (!record->state.testAndSetAcquire(SlotFree, SlotReading)) {
+    if (record->state.fetchAndAddAcquire(0) == SlotWriting) {
+      return RecordPending;
+    }
+    QThread::yieldCurrentThread();
+  }
+  // the slot may not be written yet, or already reused by a newer message
+  RecordState state;
+  if (record->seq == seq) {
+    message.date = QDateTime::fromMSecsSinceEpoch(record->msecs);
+    message.msg = formatRecord(*record);
+    message.level = record->level;
+    state = RecordRead;
+  } else if (int(record->seq - seq) < 0) {
+    state = RecordPending;
+  } else {
+    state = RecordDropped;
+  }
+  record->state.fetchAndStoreRelease(SlotFree);
+  return state;
+}
+
+
+uint Debug::firstVisible() const {
+  const uint written = uint(const_cast<QAtomicInt&>(_written).fetchAndAddAcquire(0));
+  const uint cleared = uint(const_cast<QAtomicInt&>(_cleared).fetchAndAddAcquire(0));
+  uint count = written - cleared;
   QMutexLocker ml(&_lock);
-  _messages.clear(); 
+  const uint limit = _applyLimit ? uint(qBound(0, _limit, int(Capacity))) : uint(Capacity);
+  if (count > limit) {
+    count = limit;
+  }
+  return written - count;
+}
+
+
+void Debug::clear() {
+  clearHasNewError();
+  _cleared.fetchAndStoreRelease(_written.fetchAndAddAcquire(0));
   LogEvent *e = new LogEvent(LogEvent::LogCleared);
   QApplication::postEvent(_handler, e);
 }
@@ -143,12 +224,12 @@ QString Debug::label(LogLevel level) const {
 
 
 QString Debug::text() {
-  QMutexLocker ml(&_lock);
   QString body = tr("Kst version %1\n\n\nKst log:\n").arg(KSTVERSION);
 
   QLocale locale;
-  for (int i = 0; i < _messages.count(); i++ ) {
-    body += QString("%1 %2: %3\n").arg(_messages[i].date.toString(locale.dateFormat())).arg(label(_messages[i].level)).arg(_messages[i].msg);
+  const QList<LogMessage> msgs = messages();
+  for (int i = 0; i < msgs.count(); i++ ) {
+    body += QString("%1 %2: %3\n").arg(msgs[i].date.toString(locale.dateFormat())).arg(label(msgs[i].level)).arg(msgs[i].msg);
   }
 
   body += tr("\n\nData-source plugins:");
@@ -170,23 +251,58 @@ void Debug::setLimit(bool applyLimit, int limit) {
 
 
 QList<Debug::LogMessage> Debug::messages() const {
-  QMutexLocker ml(&_lock);
-  return _messages;
+  QList<LogMessage> msgs;
+  const uint end = uint(const_cast<QAtomicInt&>(_written).fetchAndAddAcquire(0));
+  LogMessage message;
+  for (uint seq = firstVisible(); seq != end; ++seq) {
+    const RecordState state = readRecord(seq, message);
+    if (state == RecordPending) {
+      break;
+    }
+    if (state == RecordRead) {
+      msgs.append(message);
+    }
+  }
+  return msgs;
+}
+
+
+QList<Debug::LogMessage> Debug::messagesSince(uint& seq) const {
+  QList<LogMessage> msgs;
+  const uint end = uint(const_cast<QAtomicInt&>(_written).fetchAndAddAcquire(0));
+  const uint first = firstVisible();
+  // what was dropped or cleared since is skipped
+  if (end - seq > end - first) {
+    seq = first;
+  }
+  LogMessage message;
+  for (; seq != end; ++seq) {
+    const RecordState state = readRecord(seq, message);
+    if (state == RecordPending) {
+      // seq is left at it, so the next call starts there
+      break;
+    }
+    if (state == RecordRead) {
+      msgs.append(message);
+    }
+  }
+  return msgs;
 }
 
 
 Debug::LogMessage Debug::message(unsigned n) const {
-  QMutexLocker ml(&_lock);
-  if (_messages.size() > int(n)) {
-    return _messages[n];
+  LogMessage message;
+  const uint first = firstVisible();
+  const uint end = uint(const_cast<QAtomicInt&>(_written).fetchAndAddAcquire(0));
+  if (end - first > n && readRecord(first + n, message) == RecordRead) {
+    return message;
   }
   return Debug::LogMessage();
 }
 
 
 int Debug::logLength() const {
-  QMutexLocker ml(&_lock);
-  return _messages.size();
+  return int(uint(const_cast<QAtomicInt&>(_written).fetchAndAddAcquire(0)) - firstVisible());
 }
 
 
@@ -197,14 +313,17 @@ const QString& Debug::kstRevision() const {
 
 
 bool Debug::hasNewError() const {
-  QMutexLocker ml(&_lock);
-  return _hasNewError;
+  return const_cast<QAtomicInt&>(_hasNewError).fetchAndAddRelaxed(0) != 0;
 }
 
 
 void Debug::clearHasNewError() {
-  QMutexLocker ml(&_lock);
-  _hasNewError = false;
+  _hasNewError.fetchAndStoreRelaxed(0);
+}
+
+
+int Debug::errorCount() const {
+  return const_cast<QAtomicInt&>(_errorCount).fetchAndAddRelaxed(0);
 }
 
 }
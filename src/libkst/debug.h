@@ -20,7 +20,9 @@
 #include <qobject.h>
 #include <qmutex.h>
 
+#include <QAtomicInt>
 #include <QThread>
+#include <QVariant>
 
 #include "kst_export.h"
 
@@ -43,8 +45,18 @@ class KSTCORE_EXPORT Debug : public QObject {
     };
     static Debug *self();
 
+    // The log keeps the most recent Capacity messages, or the most recent
+    // limit() ones if setLimit() applies a smaller limit.
+    enum { Capacity = 16384 };
+
     void clear();
     void log(const QString& msg, LogLevel level = Notice);
+    // Records format and its arguments only; they are substituted
+    // (QString::arg() style, %1 to %4) when the message is read.  format
+    // must be a string literal.  Use this one in update loops.
+    void log(LogLevel level, const char *format,
+             const QVariant& a1 = QVariant(), const QVariant& a2 = QVariant(),
+             const QVariant& a3 = QVariant(), const QVariant& a4 = QVariant());
     void setLimit(bool applyLimit, int limit);
     QString text();
 
@@ -56,6 +68,9 @@ class KSTCORE_EXPORT Debug : public QObject {
 
     int logLength() const;
     QList<LogMessage> messages() const;
+    // The messages from sequence number seq on; seq is advanced past them,
+    // up to the first one still being written.  Start with seq 0.
+    QList<LogMessage> messagesSince(uint& seq) const;
     Debug::LogMessage message(unsigned n) const;
     QStringList dataSourcePlugins() const;
     QString label(LogLevel level) const;
@@ -65,12 +80,18 @@ class KSTCORE_EXPORT Debug : public QObject {
 
     bool hasNewError() const;
     void clearHasNewError();
+    // The number of errors logged so far.
+    int errorCount() const;
 
 #ifdef BENCHMARK
     QMap<QString,int>& drawCounter() { return _drawCounter; }
 #endif
 
+    // The handler is posted a LogAdded event, without a message, when
+    // messages are logged; no further one until it calls handlerNotified().
+    // It reads the messages with messagesSince() when it shows them.
     void setHandler(QObject *handler);
+    void handlerNotified();
 
   private:
     Debug();
@@ -79,9 +100,40 @@ class KSTCORE_EXPORT Debug : public QObject {
     static Debug *_self;
     static void cleanup();
 
-    QList<LogMessage> _messages;
+    // One slot of the ring buffer.  state is a per-slot spin lock, held
+    // while the slot is written (SlotWriting) or copied (SlotReading):
+    // taking a slot is one atomic add, and writers only contend for a slot,
+    // spinning, when the ring wraps onto one still being written or read.
+    // Readers do not wait for writers; they stop at a slot being written
+    // and come back for it.  So the log is not lock-free, but it never
+    // waits on a global mutex.
+    enum { SlotFree = 0, SlotWriting = 1, SlotReading = 2 };
+    enum RecordState { RecordRead, RecordPending, RecordDropped };
+    struct LogRecord {
+      LogRecord() : seq(~0u), msecs(0), level(Notice), format(0), argCount(0) {}
+      QAtomicInt state;
+      uint seq;
+      qint64 msecs;
+      LogLevel level;
+      const char *format; // 0 if msg is the text
+      QString msg;
+      QVariant args[4];
+      int argCount;
+    };
+
+    LogRecord *beginRecord(LogLevel level);
+    void endRecord(LogRecord *record);
+    RecordState readRecord(uint seq, LogMessage& message) const;
+    static QString formatRecord(const LogRecord& record);
+    uint firstVisible() const;
+
+    LogRecord *_records;
+    QAtomicInt _written; // sequence number of the next message
+    QAtomicInt _cleared; // sequence number of the first message after clear()
+    QAtomicInt _hasNewError;
+    QAtomicInt _errorCount;
+    QAtomicInt _handlerNotified; // a LogAdded event is pending
     bool _applyLimit;
-    bool _hasNewError;
     int _limit;
     mutable QMutex _lock;
 #ifdef BENCHMARK
@@ -0,0 +1,246 @@
+/***************************************************************************
+                              detectioncache.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "detectioncache.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include "settings.h"
+
+namespace Kst {
+
+static const quint32 CacheVersion = 1;
+// leading bytes read from each file
+static const int MagicBytes = 16;
+// leading bytes which tell kinds of binary files apart
+static const int KindMagicBytes = 8;
+// judgements agreeing on a kind of file before plugins are skipped for it
+static const int KindTrustCount = 3;
+// beyond this many files, the cache starts over
+static const int MaxFiles = 50000;
+
+static DetectionCache *cache_self = 0L;
+static QMutex cacheSelfLock;
+
+void DetectionCache::cleanup() {
+  if (cache_self) {
+    cache_self->save();
+  }
+  delete cache_self;
+  cache_self = 0L;
+}
+
+
+DetectionCache& DetectionCache::self() {
+  QMutexLocker ml(&cacheSelfLock);
+  if (!cache_self) {
+    cache_self = new DetectionCache;
+    cache_self->load();
+    qAddPostRoutine(DetectionCache::cleanup);
+  }
+  return *cache_self;
+}
+
+
+DetectionCache::DetectionCache() : _dirty(false) {
+}
+
+
+DetectionCache::~DetectionCache() {
+}
+
+
+void DetectionCache::setContext(const QString& context) {
+  QMutexLocker ml(&_lock);
+  if (context != _context) {
+    _context = context;
+    _files.clear();
+    _kinds.clear();
+    _dirty = true;
+  }
+}
+
+
+DetectionCache::Probe DetectionCache::probe(const QString& filename) {
+  Probe p;
+  QFileInfo info(filename);
+  if (!info.exists() || !(info.isFile() || info.isDir())) {
+    // opening a fifo or a device to look at it could block
+    return p;
+  }
+  p.path = info.absoluteFilePath();
+  p.modified = info.lastModified().toMSecsSinceEpoch();
+  if (info.isFile()) {
+    p.size = info.size();
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly)) {
+      return p;
+    }
+    p.magic = f.read(MagicBytes);
+  }
+  p.valid = true;
+  return p;
+}
+
+
+// Binary files are of the same kind if they have the same extension and
+// start with the same bytes.  Text files and directories have no kind.
+QString DetectionCache::kindOf(const Probe& probe) {
+  if (probe.size < 0 || probe.magic.size() < KindMagicBytes) {
+    return QString();
+  }
+  bool text = true;
+  for (int i = 0; i < probe.magic.size(); ++i) {
+    const uchar c = uchar(probe.magic.at(i));
+    if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f') {
+      text = false;
+      break;
+    }
+  }
+  if (text) {
+    return QString();
+  }
+  return QFileInfo(probe.path).suffix().toLower() + '\n' +
+         QString::fromLatin1(probe.magic.left(KindMagicBytes).toHex());
+}
+
+
+bool DetectionCache::lookup(const Probe& probe, Matches *matches) {
+  if (!probe.valid) {
+    return false;
+  }
+  QMutexLocker ml(&_lock);
+  QHash<QString, File>::ConstIterator it = _files.constFind(probe.path);
+  if (it != _files.constEnd() && it.value().size == probe.size &&
+      it.value().modified == probe.modified && it.value().magic == probe.magic) {
+    *matches = it.value().matches;
+    return true;
+  }
+
+  const QString kind = kindOf(probe);
+  if (!kind.isEmpty()) {
+    QHash<QString, Kind>::ConstIterator k = _kinds.constFind(kind);
+    if (k != _kinds.constEnd() && !k.value().ambiguous && k.value().seen >= KindTrustCount) {
+      *matches = k.value().matches;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void DetectionCache::forget(const QString& filename) {
+  const QString path = QFileInfo(filename).absoluteFilePath();
+  QMutexLocker ml(&_lock);
+  if (_files.remove(path) > 0) {
+    _dirty = true;
+  }
+}
+
+
+void DetectionCache::insert(const Probe& probe, const Matches& matches) {
+  if (!probe.valid) {
+    return;
+  }
+  QMutexLocker ml(&_lock);
+  if (_files.count() >= MaxFiles) {
+    _files.clear();
+  }
+  File f;
+  f.size = probe.size;
+  f.modified = probe.modified;
+  f.magic = probe.magic;
+  f.matches = matches;
+  _files.insert(probe.path, f);
+
+  const QString kind = kindOf(probe);
+  if (!kind.isEmpty()) {
+    Kind &k = _kinds[kind];
+    if (k.seen == 0) {
+      k.matches = matches;
+    } else if (k.matches != matches) {
+      k.ambiguous = true;
+    }
+    ++k.seen;
+  }
+  _dirty = true;
+}
+
+
+void DetectionCache::load() {
+  QFile f(cacheFilePath("datasource-detection"));
+  if (!f.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  QDataStream s(&f);
+  quint32 version;
+  s >> version;
+  if (version != CacheVersion) {
+    return;
+  }
+
+  QMutexLocker ml(&_lock);
+  qint32 count;
+  s >> _context >> count;
+  for (qint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+    QString path;
+    File file;
+    s >> path >> file.size >> file.modified >> file.magic >> file.matches;
+    _files.insert(path, file);
+  }
+  s >> count;
+  for (qint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+    QString name;
+    Kind kind;
+    s >> name >> kind.matches >> kind.seen >> kind.ambiguous;
+    _kinds.insert(name, kind);
+  }
+  if (s.status() != QDataStream::Ok) {
+    _context.clear();
+    _files.clear();
+    _kinds.clear();
+  }
+}
+
+
+void DetectionCache::save() {
+  QMutexLocker ml(&_lock);
+  if (!_dirty) {
+    return;
+  }
+  QFile f(cacheFilePath("datasource-detection"));
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return;
+  }
+  QDataStream s(&f);
+  s << CacheVersion << _context << qint32(_files.count());
+  for (QHash<QString, File>::ConstIterator it = _files.constBegin(); it != _files.constEnd(); ++it) {
+    s << it.key() << it.value().size << it.value().modified << it.value().magic << it.value().matches;
+  }
+  s << qint32(_kinds.count());
+  for (QHash<QString, Kind>::ConstIterator it = _kinds.constBegin(); it != _kinds.constEnd(); ++it) {
+    s << it.key() << it.value().matches << it.value().seen << it.value().ambiguous;
+  }
+  _dirty = false;
+}
+
+}
+// vim: ts=2 sw=2 et
@@ -0,0 +1,108 @@
+/***************************************************************************
+                               detectioncache.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DETECTIONCACHE_H
+#define DETECTIONCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include "kst_export.h"
+
+class TestDetectionCache;
+
+namespace Kst {
+
+/**
+ * Remembers which data source plugins understand a file, so that
+ * DataSourcePluginManager doesn't have every plugin open and sniff it again.
+ * Files are known by path, size, modification time and their first bytes,
+ * and the cache is kept across runs.  Besides, binary files with the same
+ * extension and leading (magic) bytes which every plugin has judged the same
+ * way a few times are taken to be judged that way again; text files, and
+ * kinds of files plugins disagree about, always go to the plugins.
+ * This class has to be threadsafe.
+ */
+class KSTCORE_EXPORT DetectionCache {
+  public:
+    // plugin names and what understands() returned, best first
+    typedef QList<QPair<QString, int> > Matches;
+
+    struct Probe {
+      Probe() : size(-1), modified(0), valid(false) {}
+      QString path;
+      qint64 size;
+      qint64 modified;
+      QByteArray magic;
+      bool valid;
+    };
+
+    static DetectionCache& self();
+
+    /** context identifies the plugins, and the settings of theirs, the
+        matches come from; when it changes, everything cached is forgotten. */
+    void setContext(const QString& context);
+
+    // stats the file and reads its first bytes; invalid for special files
+    static Probe probe(const QString& filename);
+
+    bool lookup(const Probe& probe, Matches *matches);
+    void insert(const Probe& probe, const Matches& matches);
+    // drops what is known about the file, but not about its kind
+    void forget(const QString& filename);
+
+    void save();
+
+  private:
+    friend class ::TestDetectionCache;
+
+    DetectionCache();
+    ~DetectionCache();
+    static void cleanup();
+    void load();
+
+    static QString kindOf(const Probe& probe);
+
+    struct File {
+      qint64 size;
+      qint64 modified;
+      QByteArray magic;
+      Matches matches;
+    };
+
+    struct Kind {
+      Kind() : seen(0), ambiguous(false) {}
+      Matches matches;
+      int seen;
+      bool ambiguous;
+    };
+
+    QMutex _lock;
+    QString _context;
+    QHash<QString, File> _files;
+    QHash<QString, Kind> _kinds;
+    bool _dirty;
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
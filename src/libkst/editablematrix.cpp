@@ -16,6 +16,7 @@
 // qCompress the bytearray
 
 #include "editablematrix.h"
+#include "datasidecar.h"
 #include "debug.h"
 #include <qbytearray.h>
 #include <QXmlStreamWriter>
@@ -55,7 +56,7 @@ void EditableMatrix::save(QXmlStreamWriter &xml) {
   xml.writeAttribute("ny", QString::number(yNumSteps()));
   xml.writeAttribute("xstep", QString::number(xStepSize()));
   xml.writeAttribute("ystep", QString::number(yStepSize()));
-  xml.writeTextElement("data", qCompress(qba).toBase64());
+  DataSidecar::writePayload(xml, "data", qba);
   xml.writeEndElement();
 }
 
@@ -19,6 +19,7 @@
 // qCompress the bytearray
 #include <QXmlStreamWriter>
 
+#include "datasidecar.h"
 #include "debug.h"
 namespace Kst {
 
@@ -73,7 +74,7 @@ void EditableVector::save(QXmlStreamWriter &s) {
       qds << _v[i];
     }
 
-    s.writeTextElement("data", qCompress(qba).toBase64());
+    DataSidecar::writePayload(s, "data", qba);
   }
   s.writeEndElement();
 }
@@ -20,10 +20,12 @@ INCLUDEPATH += tmp \
 
 SOURCES += builtindatasources.cpp \
     builtinprimitives.cpp \
+    changenotifier.cpp \
     coredocument.cpp \
     datacollection.cpp \
     datamatrix.cpp \
     dataprimitive.cpp \
+    datasidecar.cpp \
     datasource.cpp \
     datasourcefactory.cpp \
     datasourcepluginfactory.cpp \
@@ -33,6 +35,7 @@ SOURCES += builtindatasources.cpp \
     datastring.cpp \
     dateparser.cpp \
     debug.cpp \
+    detectioncache.cpp \
     editablematrix.cpp \
     editablevector.cpp \
     extension.cpp \
@@ -43,6 +46,7 @@ SOURCES += builtindatasources.cpp \
     matrix.cpp \
     matrixfactory.cpp \
     measuretime.cpp \
+    memorybudget.cpp \
     namedobject.cpp \
     nextcolor.cpp \
     object.cpp \
@@ -50,6 +54,7 @@ SOURCES += builtindatasources.cpp \
     objectmap.cpp \
     objectstore.cpp \
     plotiteminterface.cpp \
+    pluginmanifest.cpp \
     primitive.cpp \
     primitivefactory.cpp \
     rwlock.cpp \
@@ -58,6 +63,7 @@ SOURCES += builtindatasources.cpp \
     shortnameindex.cpp \
     string_kst.cpp \
     stringfactory.cpp \
+    trace.cpp \
     updatemanager.cpp \
     vector.cpp \
     vectorfactory.cpp \
@@ -70,11 +76,14 @@ SOURCES += builtindatasources.cpp \
 	
 HEADERS += builtindatasources.h \
     builtinprimitives.h \
+    boundedqueue.h \
+    changenotifier.h \
     coredocument.h \
     datacollection.h \
     datamatrix.h \
     dataplugin.h \
     dataprimitive.h \
+    datasidecar.h \
     datasource.h \
     datasourcefactory.h \
     datasourcepluginfactory.h \
@@ -84,6 +93,7 @@ HEADERS += builtindatasources.h \
     datastring.h \
     dateparser.h \
     debug.h \
+    detectioncache.h \
     editablematrix.h \
     editablevector.h \
     events.h \
@@ -100,12 +110,14 @@ HEADERS += builtindatasources.h \
     matrix.h \
     matrixfactory.h \
     measuretime.h \
+    memorybudget.h \
     namedobject.h \
     object.h \
     objectlist.h \
     objectmap.h \
     objectstore.h \
     plotiteminterface.h \
+    pluginmanifest.h \
     primitive.h \
     primitivefactory.h \
     procps.h \
@@ -119,6 +131,7 @@ HEADERS += builtindatasources.h \
     stringfactory.h \
     sysinfo.h \
     timezones.h \
+    trace.h \
     updatemanager.h \
     vector.h \
     vectorfactory.h \
@@ -27,6 +27,7 @@
 #include "debug.h"
 #include "math_kst.h"
 #include "datacollection.h"
+#include "memorybudget.h"
 #include "objectstore.h"
 
 
@@ -57,7 +58,7 @@ Matrix::Matrix(ObjectStore *store)
 Matrix::~Matrix() {
   if (_z) {
     _vectors["z"]->setV(0L, 0);
-    free(_z);
+    MemoryBudget::self()->release(_z);
     _z = 0L;
   }
 }
@@ -478,7 +479,7 @@ void Matrix::updateScalars() {
 bool Matrix::resizeZ(int sz, bool reinit) {
 //   qDebug() << "resizing to: " << sz << endl;
   if (sz >= 1) {
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!MemoryBudget::self()->reallocate(_z, sz*sizeof(double), this)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
@@ -539,7 +540,7 @@ bool Matrix::resize(int xSize, int ySize, bool reinit) {
   int sz = xSize * ySize;
   if (sz > _zSize) {
     // array is getting bigger, so resize before moving
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!MemoryBudget::self()->reallocate(_z, sz*sizeof(double), this)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
@@ -563,7 +564,7 @@ bool Matrix::resize(int xSize, int ySize, bool reinit) {
 
   if (sz < _zSize) {
     // array is getting smaller, so resize after moving
-    if (!kstrealloc(_z, sz*sizeof(double))) {
+    if (!MemoryBudget::self()->reallocate(_z, sz*sizeof(double), this)) {
       qCritical() << "Matrix resize failed";
       return false;
     }
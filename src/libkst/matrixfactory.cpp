@@ -12,6 +12,7 @@
 
 #include "matrixfactory.h"
 
+#include "datasidecar.h"
 #include "debug.h"
 #include "matrix.h"
 #include "generatedmatrix.h"
@@ -125,9 +126,7 @@ PrimitivePtr EditableMatrixFactory::generatePrimitive(ObjectStore *store, QXmlSt
         Object::processShortNameIndexAttributes(attrs);
       } else if (n == "data") {
 
-        QString qcs(xml.readElementText().toLatin1());
-        QByteArray qbca = QByteArray::fromBase64(qcs.toLatin1());
-        data = qUncompress(qbca);
+        data = DataSidecar::readPayload(xml);
 
       } else {
         return 0;
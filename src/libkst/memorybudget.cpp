@@ -0,0 +1,314 @@
+/***************************************************************************
+                              memorybudget.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "memorybudget.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <string.h>
+
+#include "debug.h"
+#include "namedobject.h"
+
+namespace Kst {
+
+// smaller blocks stay on the heap while it has room
+static const qint64 MinMappedBytes = 1024*1024;
+
+static MemoryBudget *budget_self = 0L;
+static QMutex budgetSelfLock;
+
+void MemoryBudget::cleanup() {
+  delete budget_self;
+  budget_self = 0L;
+}
+
+
+MemoryBudget *MemoryBudget::self() {
+  QMutexLocker ml(&budgetSelfLock);
+  if (!budget_self) {
+    budget_self = new MemoryBudget;
+    qAddPostRoutine(MemoryBudget::cleanup);
+  }
+  return budget_self;
+}
+
+
+MemoryBudget::MemoryBudget()
+  : _budget(0), _heapBytes(0), _mappedBytes(0), _clock(0) {
+}
+
+
+MemoryBudget::~MemoryBudget() {
+  // objects still alive at exit keep their memory; only close the files
+  for (QHash<void*, Block>::ConstIterator it = _blocks.constBegin(); it != _blocks.constEnd(); ++it) {
+    delete it.value().file;
+  }
+}
+
+
+qint64 MemoryBudget::budget() const {
+  QMutexLocker ml(&_lock);
+  return _budget;
+}
+
+
+void MemoryBudget::setBudget(qint64 bytes) {
+  QMutexLocker ml(&_lock);
+  _budget = qMax(qint64(0), bytes);
+}
+
+
+bool MemoryBudget::unsettled() const {
+  QMutexLocker ml(&_lock);
+  return _mappedBytes > 0 || (_budget > 0 && _heapBytes > _budget);
+}
+
+
+qint64 MemoryBudget::heapBytes() const {
+  QMutexLocker ml(&_lock);
+  return _heapBytes;
+}
+
+
+qint64 MemoryBudget::mappedBytes() const {
+  QMutexLocker ml(&_lock);
+  return _mappedBytes;
+}
+
+
+QList<MemoryBudget::Usage> MemoryBudget::usage() const {
+  QMutexLocker ml(&_lock);
+  QList<Usage> usage;
+  QHash<QString, int> index;
+  for (QHash<void*, Block>::ConstIterator it = _blocks.constBegin(); it != _blocks.constEnd(); ++it) {
+    const Block& block = it.value();
+    const QString key = block.owner + (block.file ? QLatin1String("\n1") : QLatin1String("\n0"));
+    QHash<QString, int>::ConstIterator found = index.constFind(key);
+    if (found == index.constEnd()) {
+      Usage u;
+      u.name = block.owner;
+      u.bytes = block.bytes;
+      u.mapped = block.file != 0L;
+      index.insert(key, usage.count());
+      usage.append(u);
+    } else {
+      usage[found.value()].bytes += block.bytes;
+    }
+  }
+  return usage;
+}
+
+
+void *MemoryBudget::mapBlock(size_t size, QFile **file) {
+  QTemporaryFile *tmp = new QTemporaryFile(QDir::temp().filePath(QLatin1String("kst_arena_XXXXXX")));
+  if (!tmp->open() || !tmp->resize(qint64(size))) {
+    delete tmp;
+    return 0L;
+  }
+  uchar *mem = tmp->map(0, qint64(size));
+  if (!mem) {
+    delete tmp;
+    return 0L;
+  }
+  *file = tmp;
+  return mem;
+}
+
+
+void *MemoryBudget::reallocateBlock(void *ptr, size_t size, const NamedObject *owner) {
+  // only name the blocks big enough to show up in usage()
+  const QString name = (owner && qint64(size) >= MinMappedBytes) ? owner->Name() : QString();
+
+  QMutexLocker ml(&_lock);
+  QHash<void*, Block>::Iterator it = ptr ? _blocks.find(ptr) : _blocks.end();
+  const bool known = it != _blocks.end();
+  const Block old = known ? it.value() : Block();
+  const qint64 oldHeap = (known && !old.file) ? old.bytes : 0;
+
+  if (known && old.file) {
+    // mapped blocks are mapped with room to grow
+    if (qint64(size) <= old.file->size()) {
+      it.value().bytes = size;
+      it.value().owner = name;
+      it.value().object = owner;
+      _mappedBytes += qint64(size) - old.bytes;
+      return ptr;
+    }
+  } else {
+    const bool overBudget = _budget > 0 && _heapBytes - oldHeap + qint64(size) > _budget;
+    // a pointer we did not hand out (from malloc()) has a size only the heap
+    // knows, so it can only be grown there; it is tracked from then on
+    const bool untracked = ptr && !known;
+    if (untracked) {
+      Debug::self()->log(Debug::Warning, "Resizing vector data which was not allocated through the memory budget");
+    }
+    if (!overBudget || qint64(size) < MinMappedBytes || untracked) {
+      void *newptr = qRealloc(ptr, size);
+      if (newptr) {
+        if (known) {
+          _blocks.erase(it);
+        }
+        Block block = old;
+        block.bytes = size;
+        block.file = 0L;
+        block.owner = name;
+        block.object = owner;
+        _blocks.insert(newptr, block);
+        _heapBytes += qint64(size) - oldHeap;
+        return newptr;
+      }
+      if (untracked) {
+        return 0L;
+      }
+      // out of heap: fall back on a mapped block
+    }
+  }
+
+  QFile *file = 0L;
+  const size_t capacity = (known && old.file) ? size + size/2 : size;
+  void *newptr = mapBlock(capacity, &file);
+  if (!newptr) {
+    return 0L;
+  }
+
+  if (known) {
+    memcpy(newptr, ptr, qMin(qint64(size), old.bytes));
+    _blocks.remove(ptr);
+    if (old.file) {
+      old.file->unmap(static_cast<uchar*>(ptr));
+      delete old.file;
+      _mappedBytes -= old.bytes;
+    } else {
+      qFree(ptr);
+      _heapBytes -= old.bytes;
+    }
+  }
+
+  Block block = old;
+  block.bytes = size;
+  block.file = file;
+  block.owner = name;
+  block.object = owner;
+  _blocks.insert(newptr, block);
+  _mappedBytes += qint64(size);
+
+  Debug::self()->log(Debug::Notice, "%1: %2 MB of data placed in a memory-mapped file", name, qint64(size)/(1024*1024));
+  return newptr;
+}
+
+
+void *MemoryBudget::settleBlock(void *ptr, bool shown, const NamedObject *owner) {
+  QMutexLocker ml(&_lock);
+  QHash<void*, Block>::Iterator it = ptr ? _blocks.find(ptr) : _blocks.end();
+  // a vector may show the block of another object, which that object settles
+  if (it == _blocks.end() || it.value().object != owner || it.value().bytes < MinMappedBytes) {
+    return ptr;
+  }
+  Block block = it.value();
+  block.shown = shown;
+  if (shown) {
+    block.lastShown = ++_clock;
+  }
+
+  if (block.file) {
+    // back to the heap when it fits; unshown blocks only when it fits well,
+    // so that they do not go back and forth between updates
+    const qint64 room = shown ? _budget : _budget - _budget/4;
+    void *newptr = (_budget == 0 || _heapBytes + block.bytes <= room) ? qMalloc(block.bytes) : 0L;
+    if (!newptr) {
+      it.value() = block;
+      return ptr;
+    }
+    memcpy(newptr, ptr, block.bytes);
+    _blocks.erase(it);
+    block.file->unmap(static_cast<uchar*>(ptr));
+    delete block.file;
+    block.file = 0L;
+    _blocks.insert(newptr, block);
+    _mappedBytes -= block.bytes;
+    _heapBytes += block.bytes;
+    return newptr;
+  }
+
+  if (_budget == 0 || shown) {
+    it.value() = block;
+    return ptr;
+  }
+
+  // spill unless this block fits in the budget after the small blocks, the
+  // shown ones and the unshown ones shown more recently
+  qint64 wanted = block.bytes;
+  for (QHash<void*, Block>::ConstIterator b = _blocks.constBegin(); b != _blocks.constEnd(); ++b) {
+    if (b.key() == ptr) {
+      continue;
+    }
+    const Block& other = b.value();
+    if (other.bytes < MinMappedBytes) {
+      wanted += other.file ? 0 : other.bytes;
+    } else if (other.shown) {
+      wanted += other.bytes;
+    } else if (!other.file && (other.lastShown > block.lastShown ||
+          (other.lastShown == block.lastShown && b.key() > ptr))) {
+      wanted += other.bytes;
+    }
+  }
+  QFile *file = 0L;
+  void *newptr = wanted > _budget ? mapBlock(block.bytes, &file) : 0L;
+  if (!newptr) {
+    it.value() = block;
+    return ptr;
+  }
+  memcpy(newptr, ptr, block.bytes);
+  _blocks.erase(it);
+  qFree(ptr);
+  block.file = file;
+  _blocks.insert(newptr, block);
+  _heapBytes -= block.bytes;
+  _mappedBytes += block.bytes;
+
+  Debug::self()->log(Debug::Notice, "%1: %2 MB of data not on screen moved to a memory-mapped file", block.owner, block.bytes/(1024*1024));
+  return newptr;
+}
+
+
+void MemoryBudget::release(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  QMutexLocker ml(&_lock);
+  QHash<void*, Block>::Iterator it = _blocks.find(ptr);
+  if (it == _blocks.end()) {
+    qFree(ptr);
+    return;
+  }
+  const Block block = it.value();
+  _blocks.erase(it);
+  if (block.file) {
+    block.file->unmap(static_cast<uchar*>(ptr));
+    delete block.file;
+    _mappedBytes -= block.bytes;
+  } else {
+    qFree(ptr);
+    _heapBytes -= block.bytes;
+  }
+}
+
+}
+// vim: ts=2 sw=2 et
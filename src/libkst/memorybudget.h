@@ -0,0 +1,121 @@
+/***************************************************************************
+                               memorybudget.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "kst_export.h"
+
+class QFile;
+
+namespace Kst {
+
+class NamedObject;
+
+/**
+ * Hands out the storage behind vectors and matrices.  Blocks come from the
+ * heap until the heap blocks add up to the budget.  Past the budget, or when
+ * the heap is exhausted, blocks go into memory-mapped temporary files
+ * instead; the system writes their pages back to disk and drops the least
+ * recently used ones when memory runs short.  Owners call settle() now and
+ * then, so that what is shown moves back to the heap and what is not, least
+ * recently shown first, makes room for it.
+ * This class has to be threadsafe.
+ */
+class KSTCORE_EXPORT MemoryBudget {
+  public:
+    struct Usage {
+      QString name;
+      qint64 bytes;
+      bool mapped;
+    };
+
+    static MemoryBudget *self();
+
+    // Behaves like kstrealloc(); owner is only used to report usage.  ptr
+    // may also come from malloc(), but is then kept on the heap.
+    template<class T>
+    bool reallocate(T* &ptr, size_t size, const NamedObject *owner) {
+      void *newptr = reallocateBlock(static_cast<void*>(ptr), size, owner);
+      if (!newptr) {
+        return false;
+      }
+      ptr = static_cast<T*>(newptr);
+      return true;
+    }
+    // Frees memory from reallocate(), or from malloc().
+    void release(void *ptr);
+
+    // Moves owner's block ptr to or from a mapped file, as the budget asks;
+    // true if it moved.  shown is whether plots on screen read the data.
+    template<class T>
+    bool settle(T* &ptr, bool shown, const NamedObject *owner) {
+      void *newptr = settleBlock(static_cast<void*>(ptr), shown, owner);
+      if (newptr == ptr) {
+        return false;
+      }
+      ptr = static_cast<T*>(newptr);
+      return true;
+    }
+    // true if settle() might move anything
+    bool unsettled() const;
+
+    // in bytes; 0 means no limit
+    qint64 budget() const;
+    void setBudget(qint64 bytes);
+
+    qint64 heapBytes() const;
+    qint64 mappedBytes() const;
+    QList<Usage> usage() const;
+
+  private:
+    MemoryBudget();
+    ~MemoryBudget();
+    static void cleanup();
+
+    struct Block {
+      Block() : bytes(0), file(0L), object(0L), shown(false), lastShown(0) {}
+      qint64 bytes;
+      QFile *file; // 0 for heap blocks
+      QString owner;
+      const NamedObject *object;
+      bool shown;
+      qint64 lastShown;
+    };
+
+    void *reallocateBlock(void *ptr, size_t size, const NamedObject *owner);
+    void *settleBlock(void *ptr, bool shown, const NamedObject *owner);
+    void *mapBlock(size_t size, QFile **file);
+
+    mutable QMutex _lock;
+    QHash<void*, Block> _blocks;
+    qint64 _budget;
+    qint64 _heapBytes;
+    qint64 _mappedBytes;
+    // counts settle() calls for shown blocks
+    qint64 _clock;
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
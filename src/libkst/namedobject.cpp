@@ -24,7 +24,20 @@ namespace Kst {
   
 NamedObject::NamedObject() : _manualDescriptiveName(QString()), _shortName(QString("FIXME - set _shortName"))
 {
+  _recordInitialIndexes();
 
+  _sizeCache = new SizeCache;
+  _sizeCache->fontSize = 0;
+  _sizeCache->nameWidthPixels = 0;
+  _sizeCache->name.clear();
+}
+
+NamedObject::~NamedObject() {
+  delete _sizeCache;
+}
+
+
+void NamedObject::_recordInitialIndexes() {
   _initial_vnum = _vnum; // vectors
   _initial_pnum = _pnum; // plugins
   _initial_csdnum = _csdnum; // csd
@@ -40,15 +53,6 @@ NamedObject::NamedObject() : _manualDescriptiveName(QString()), _shortName(QStri
   _initial_lnum = _lnum; // legend
   _initial_dnum = _dnum; // view image
   _initial_dsnum = _dsnum; // datasource
-
-  _sizeCache = new SizeCache;
-  _sizeCache->fontSize = 0;
-  _sizeCache->nameWidthPixels = 0;
-  _sizeCache->name.clear();
-}
-
-NamedObject::~NamedObject() {
-  delete _sizeCache;
 }
 
 
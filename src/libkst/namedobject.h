@@ -111,6 +111,8 @@ public:
   protected:
     virtual QString _automaticDescriptiveName() const= 0;
     virtual void _initializeShortName() = 0;
+    // takes the object indices below from the current ones
+    void _recordInitialIndexes();
     QString _manualDescriptiveName;
     QString _shortName;
     virtual void saveNameInfo(QXmlStreamWriter &s, unsigned I = 0xffff);
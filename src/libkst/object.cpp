@@ -19,6 +19,7 @@
 
 
 #include "objectstore.h"
+#include "trace.h"
 
 namespace Kst {
 
@@ -26,7 +27,7 @@ const QString Object::staticTypeString = "Object";
 
 Object::Object() :
   Shared(), KstRWLock(), NamedObject(),
-  _store(0L), _serial(0), _serialOfLastChange(0)
+  _store(0L), _serial(0), _serialOfLastChange(0), _alwaysUpdate(false)
 {
 }
 
@@ -78,6 +79,11 @@ ObjectStore* Object::store() const {
 
 // decide, based on serial numbers, whether to do an update.
 // if all inputs are up to date, update.  Otherwise, defer.
+QList<Object*> Object::inputObjects() const {
+  return QList<Object*>();
+}
+
+
 Object::UpdateType Object::objectUpdate(qint64 newSerial) {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
 
@@ -92,6 +98,7 @@ Object::UpdateType Object::objectUpdate(qint64 newSerial) {
   } else if (minInputSerial() < newSerial) { // if an input was forced, this will be true
     return Deferred;
   } else if ((_serialOfLastChange < maxInputSerialOfLastChange()) || (_serial == Object::Forced)) {
+    TRACE_SPAN_DETAIL("update", "internalUpdate", Name());
     internalUpdate();
     _serialOfLastChange = newSerial;
     _serial = newSerial;
@@ -77,19 +77,28 @@ class KSTCORE_EXPORT Object : public QObject, public Shared, public KstRWLock, p
 
     virtual bool uses(ObjectPtr p) const;
 
+    // keep this up to date even when nothing shown reads it; see
+    // UpdateManager::setDemand()
+    bool alwaysUpdate() const {return _alwaysUpdate;}
+    void setAlwaysUpdate(bool alwaysUpdate) {_alwaysUpdate = alwaysUpdate;}
+
   protected:
     Object();
     virtual ~Object();
 
     friend class ObjectStore;
+    friend class UpdateManager;
     ObjectStore *_store;  // set by ObjectStore
 
     virtual qint64 minInputSerial() const = 0;
     virtual qint64 maxInputSerialOfLastChange() const = 0;
+    // the objects whose serials the two functions above look at
+    virtual QList<Object*> inputObjects() const;
 
     qint64 _serial;
     qint64 _serialOfLastChange;
     bool _used;
+    bool _alwaysUpdate;
   signals:
     void dirty();
   };
@@ -32,6 +32,7 @@
 namespace Kst {
 
 ObjectStore::ObjectStore()
+  : _generation(0)
 {
   override.fileName.clear();
   override.f0 = override.N = override.skip = override.doAve = -5;
@@ -72,6 +73,7 @@ bool ObjectStore::removeObject(Object *o) {
   }
 
   o->_store = 0;
+  ++_generation;
 
   return true;
 }
@@ -66,6 +66,9 @@ class KSTCORE_EXPORT ObjectStore
     /** get everything but the data sources */
     QList<ObjectPtr> objectList();
 
+    /** changes whenever objects are added or removed */
+    qint64 generation() const { return _generation; }
+
     /** locking */
     KstRWLock& lock() const { return _lock; }
 
@@ -97,6 +100,7 @@ class KSTCORE_EXPORT ObjectStore
     // objects are stored in these lists
     DataSourceList _dataSourceList;
     QList<ObjectPtr> _list;
+    qint64 _generation;
 
 };
 
@@ -137,6 +141,7 @@ bool ObjectStore::addObject(T *o) {
   KstWriteLocker l(&this->_lock);
 
   o->_store = this;
+  ++_generation;
 
   // put the object in the right place depending on its type
   if (DataSourcePtr ds = kst_cast<DataSource>(o)) {
@@ -0,0 +1,129 @@
+/***************************************************************************
+                              pluginmanifest.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "pluginmanifest.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QPluginLoader>
+#include <QThread>
+
+#include "debug.h"
+#include "settings.h"
+
+namespace Kst {
+
+static const quint32 ManifestVersion = 1;
+
+
+PluginManifest::PluginManifest(const QString& kind)
+  : _path(cacheFilePath("plugins-" + kind)), _dirty(false) {
+  QFile f(_path);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  QDataStream s(&f);
+  quint32 version;
+  qint32 count;
+  s >> version;
+  if (version != ManifestVersion) {
+    return;
+  }
+  s >> count;
+  for (qint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+    QString fileName;
+    Entry e;
+    s >> fileName >> e.modified >> e.size >> e.isPlugin >> e.name >> e.description
+      >> e.provides >> e.type >> e.hasConfigWidget;
+    _entries.insert(fileName, e);
+  }
+  if (s.status() != QDataStream::Ok) {
+    _entries.clear();
+  }
+}
+
+
+bool PluginManifest::lookup(const QFileInfo& file, Entry *entry) {
+  const QString fileName = file.absoluteFilePath();
+  _seen.insert(fileName);
+  QHash<QString, Entry>::ConstIterator it = _entries.constFind(fileName);
+  if (it == _entries.constEnd() || it.value().size != file.size() ||
+      it.value().modified != file.lastModified().toMSecsSinceEpoch()) {
+    return false;
+  }
+  *entry = it.value();
+  return true;
+}
+
+
+void PluginManifest::insert(const QFileInfo& file, const Entry& entry) {
+  const QString fileName = file.absoluteFilePath();
+  Entry e = entry;
+  e.size = file.size();
+  e.modified = file.lastModified().toMSecsSinceEpoch();
+  _entries.insert(fileName, e);
+  _seen.insert(fileName);
+  _dirty = true;
+}
+
+
+void PluginManifest::save() {
+  // forget uninstalled plugins
+  foreach (const QString& fileName, _entries.keys()) {
+    if (!_seen.contains(fileName)) {
+      _entries.remove(fileName);
+      _dirty = true;
+    }
+  }
+  if (!_dirty) {
+    return;
+  }
+
+  QFile f(_path);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return;
+  }
+  QDataStream s(&f);
+  s << ManifestVersion << qint32(_entries.count());
+  for (QHash<QString, Entry>::ConstIterator it = _entries.constBegin(); it != _entries.constEnd(); ++it) {
+    const Entry& e = it.value();
+    s << it.key() << e.modified << e.size << e.isPlugin << e.name << e.description
+      << e.provides << e.type << e.hasConfigWidget;
+  }
+  _dirty = false;
+}
+
+
+QObject *PluginManifest::load(const QString& fileName) {
+  QPluginLoader loader(fileName);
+  QObject *plugin = loader.instance();
+  if (!plugin) {
+    Debug::self()->log(QString("Plugin failed to load: %1 (%2)").arg(fileName).arg(loader.errorString()));
+    return 0L;
+  }
+  // loaded on demand, possibly on a worker thread
+  if (QCoreApplication::instance() && plugin->thread() != QCoreApplication::instance()->thread()) {
+    plugin->moveToThread(QCoreApplication::instance()->thread());
+  }
+  return plugin;
+}
+
+}
+// vim: ts=2 sw=2 et
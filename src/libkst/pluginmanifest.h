@@ -0,0 +1,77 @@
+/***************************************************************************
+                               pluginmanifest.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PLUGINMANIFEST_H
+#define PLUGINMANIFEST_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "kst_export.h"
+
+class QFileInfo;
+class QObject;
+
+namespace Kst {
+
+/**
+ * What the last plugin scan found in each file on the plugin search paths:
+ * whether it is a plugin of one kind (data sources, data objects), and if
+ * so the name and capabilities the plugin managers list it with.  Kept
+ * across runs, so that startup only loads the plugins which are new or
+ * changed; the others are loaded once something uses them.
+ */
+class KSTCORE_EXPORT PluginManifest {
+  public:
+    struct Entry {
+      Entry() : modified(0), size(-1), isPlugin(false), type(0), hasConfigWidget(false) {}
+      qint64 modified;
+      qint64 size;
+      bool isPlugin;           // false for files which are no plugin of this kind
+      QString name;
+      QString description;
+      QStringList provides;    // data source types
+      int type;                // data object plugin type
+      bool hasConfigWidget;
+    };
+
+    // reads the manifest for kind
+    explicit PluginManifest(const QString& kind);
+
+    // true if file is in the manifest and hasn't changed since
+    bool lookup(const QFileInfo& file, Entry *entry);
+    void insert(const QFileInfo& file, const Entry& entry);
+
+    // writes the manifest, without the files not looked up or inserted
+    void save();
+
+    // loads the plugin in fileName; 0 if it can't be loaded
+    static QObject *load(const QString& fileName);
+
+  private:
+    QString _path;
+    QHash<QString, Entry> _entries;
+    QSet<QString> _seen;
+    bool _dirty;
+};
+
+}
+
+#endif
+// vim: ts=2 sw=2 et
@@ -79,6 +79,14 @@ qint64 Primitive::maxInputSerialOfLastChange() const {
   return NoInputs;
 }
 
+QList<Object*> Primitive::inputObjects() const {
+  QList<Object*> inputs;
+  if (_provider) {
+    inputs.append(_provider.data());
+  }
+  return inputs;
+}
+
 
 QString Primitive::propertyString() const {
   return QString("Base Class Property String");
@@ -80,6 +80,7 @@ class KSTCORE_EXPORT Primitive : public Object
 
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
     virtual void fatalError(const QString& msg);
 
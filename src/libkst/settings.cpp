@@ -17,8 +17,14 @@
 #include "settings.h"
 
 #include <QApplication>
+#include <QDir>
 #include <QVector>
 #include <QDebug>
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
 
 static QVector<QSettings*> s_settings;
 
@@ -42,4 +48,19 @@ void Kst::deleteAllSettings()
 }
 
 
+QString Kst::cacheFilePath(const QString& name)
+{
+#if QT_VERSION >= 0x050000
+  QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+  QString dir = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+  if (dir.isEmpty()) {
+    dir = QDir::tempPath() + "/kst";
+  }
+  QDir().mkpath(dir);
+  return dir + '/' + name;
+}
+
+
 // vim: ts=2 sw=2 et
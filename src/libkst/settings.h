@@ -30,6 +30,9 @@ KSTCORE_EXPORT QSettings& createSettings(const QString& scope);
 
 KSTCORE_EXPORT void deleteAllSettings();
 
+// Where a cache kept across runs is stored; the directory is created.
+KSTCORE_EXPORT QString cacheFilePath(const QString& name);
+
 
 }
 
@@ -0,0 +1,264 @@
+/***************************************************************************
+                                  trace.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadStorage>
+
+#include <string.h>
+
+namespace Kst {
+
+// events kept per thread; older ones are overwritten
+static const int RingSize = 1 << 14;
+// bytes of UTF-8 kept of each detail
+static const int DetailLength = 96;
+
+QAtomicInt Trace::_enabled(0);
+
+namespace {
+
+struct Event {
+  // odd while the event is written
+  QAtomicInt seq;
+  qint64 start;
+  qint64 duration;
+  const char *category;
+  const char *name;
+  int tid;
+  char detail[DetailLength];
+};
+
+// Only the thread owning a ring writes to it.
+struct Ring {
+  Ring() : written(0), tid(0), inUse(false) {}
+  Event events[RingSize];
+  QAtomicInt written;
+  int tid;
+  bool inUse;
+};
+
+struct Registry {
+  Registry() : nextTid(0) {}
+  QMutex lock;
+  QList<Ring*> rings;
+  QHash<int, QString> threadNames;
+  int nextTid;
+};
+
+// Hands the ring back when its thread finishes, for the next new thread.
+struct RingHandle {
+  explicit RingHandle(Ring *r) : ring(r) {}
+  ~RingHandle();
+  Ring *ring;
+};
+
+}
+
+// made on first use and kept, as threads may finish after static destruction
+static Registry *registry = 0L;
+static QThreadStorage<RingHandle*> threadRing;
+static QElapsedTimer traceClock;
+static qint64 clearedAt = 0;
+static QString exitFileName;
+
+
+RingHandle::~RingHandle() {
+  QMutexLocker ml(&registry->lock);
+  ring->inUse = false;
+}
+
+
+static Ring *currentRing() {
+  if (RingHandle *handle = threadRing.localData()) {
+    return handle->ring;
+  }
+
+  QMutexLocker ml(&registry->lock);
+  Ring *ring = 0L;
+  foreach (Ring *r, registry->rings) {
+    if (!r->inUse) {
+      ring = r;
+      break;
+    }
+  }
+  if (!ring) {
+    ring = new Ring;
+    registry->rings.append(ring);
+  }
+  ring->inUse = true;
+  ring->tid = ++registry->nextTid;
+
+  QThread *thread = QThread::currentThread();
+  QString name = thread->objectName();
+  if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+    name = QLatin1String("main");
+  } else if (name.isEmpty()) {
+    name = QString("thread %1").arg(ring->tid);
+  }
+  registry->threadNames.insert(ring->tid, name);
+
+  threadRing.setLocalData(new RingHandle(ring));
+  return ring;
+}
+
+
+void Trace::setEnabled(bool enabled) {
+  if (enabled && !registry) {
+    registry = new Registry;
+    traceClock.start();
+  }
+  _enabled.fetchAndStoreOrdered(enabled ? 1 : 0);
+}
+
+
+void Trace::clear() {
+  clearedAt = now();
+}
+
+
+qint64 Trace::now() {
+  return traceClock.isValid() ? traceClock.nsecsElapsed()/1000 : 0;
+}
+
+
+void Trace::record(const char *category, const char *name, const QString& detail,
+                   qint64 start, qint64 duration) {
+  Ring *ring = currentRing();
+  const int written = ring->written.fetchAndAddRelaxed(0);
+  Event &e = ring->events[written % RingSize];
+
+  e.seq.fetchAndAddOrdered(1);
+  e.start = start;
+  e.duration = duration;
+  e.category = category;
+  e.name = name;
+  e.tid = ring->tid;
+  const QByteArray utf8 = detail.toUtf8();
+  const int n = qMin(utf8.size(), DetailLength - 1);
+  memcpy(e.detail, utf8.constData(), n);
+  e.detail[n] = '\0';
+  e.seq.fetchAndAddRelease(1);
+
+  // wraps around after 2^31 events; the ring only uses the low bits
+  ring->written.fetchAndStoreRelease((written + 1) & 0x7fffffff);
+}
+
+
+static QString jsonString(const QString& s) {
+  QString out;
+  out.reserve(s.size() + 2);
+  out += QLatin1Char('"');
+  for (int i = 0; i < s.size(); ++i) {
+    const QChar c = s.at(i);
+    if (c == QLatin1Char('"') || c == QLatin1Char('\\')) {
+      out += QLatin1Char('\\');
+      out += c;
+    } else if (c.unicode() < 0x20) {
+      out += QString("\\u%1").arg(int(c.unicode()), 4, 16, QLatin1Char('0'));
+    } else {
+      out += c;
+    }
+  }
+  out += QLatin1Char('"');
+  return out;
+}
+
+
+bool Trace::save(const QString& fileName) {
+  QFile f(fileName);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    return false;
+  }
+  QTextStream ts(&f);
+  ts.setCodec("UTF-8");
+  ts << "{\"traceEvents\":[\n";
+  if (!registry) {
+    ts << "]}\n";
+    return true;
+  }
+
+  QMutexLocker ml(&registry->lock);
+  bool first = true;
+  for (QHash<int, QString>::ConstIterator it = registry->threadNames.constBegin(); it != registry->threadNames.constEnd(); ++it) {
+    ts << (first ? "" : ",\n")
+       << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it.key()
+       << ",\"args\":{\"name\":" << jsonString(it.value()) << "}}";
+    first = false;
+  }
+
+  foreach (Ring *ring, registry->rings) {
+    const int written = ring->written.fetchAndAddAcquire(0);
+    for (int i = qMax(0, written - RingSize); i < written; ++i) {
+      Event &e = ring->events[i % RingSize];
+      const int seq = e.seq.fetchAndAddAcquire(0);
+      if (seq & 1) {
+        continue;
+      }
+      const qint64 start = e.start;
+      const qint64 duration = e.duration;
+      const char *category = e.category;
+      const char *name = e.name;
+      const int tid = e.tid;
+      const QString detail = QString::fromUtf8(e.detail, qstrnlen(e.detail, DetailLength));
+      if (e.seq.fetchAndAddAcquire(0) != seq || start < clearedAt) {
+        // overwritten while being read
+        continue;
+      }
+      ts << (first ? "" : ",\n")
+         << "{\"name\":" << jsonString(QLatin1String(name))
+         << ",\"cat\":" << jsonString(QLatin1String(category))
+         << ",\"ph\":\"X\",\"ts\":" << start << ",\"dur\":" << duration
+         << ",\"pid\":1,\"tid\":" << tid;
+      if (!detail.isEmpty()) {
+        ts << ",\"args\":{\"detail\":" << jsonString(detail) << "}";
+      }
+      ts << "}";
+      first = false;
+    }
+  }
+  ts << "\n]}\n";
+  ts.flush();
+  return f.error() == QFile::NoError;
+}
+
+
+static void saveOnExit() {
+  Trace::save(exitFileName);
+}
+
+
+void Trace::initFromEnvironment() {
+  const QByteArray fileName = qgetenv("KST_TRACE");
+  if (fileName.isEmpty() || !exitFileName.isEmpty()) {
+    return;
+  }
+  exitFileName = QFile::decodeName(fileName);
+  setEnabled(true);
+  qAddPostRoutine(saveOnExit);
+}
+
+}
+// vim: ts=2 sw=2 et
@@ -0,0 +1,105 @@
+/***************************************************************************
+                                   trace.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef KST_TRACE_H
+#define KST_TRACE_H
+
+#include <QAtomicInt>
+#include <QString>
+
+#include "kst_export.h"
+
+namespace Kst {
+
+/**
+ * Records how long update passes, object updates, data source reads and
+ * painting take, while switched on, for looking at in a trace viewer
+ * (chrome://tracing, Perfetto).  Each thread records into a ring buffer
+ * of its own, so recording takes no locks; when off, a span costs a
+ * single load.  Setting KST_TRACE to a file name records from startup
+ * and saves the trace to that file on exit.
+ */
+class KSTCORE_EXPORT Trace {
+  public:
+    static bool isEnabled() {
+#if QT_VERSION >= 0x050000
+      return _enabled.load();
+#else
+      return _enabled;
+#endif
+    }
+    static void setEnabled(bool enabled);
+
+    // forgets what was recorded
+    static void clear();
+
+    // writes what was recorded as Chrome trace-event JSON
+    static bool save(const QString& fileName);
+
+    // microseconds on the trace clock
+    static qint64 now();
+
+    // category and name must be string literals
+    static void record(const char *category, const char *name, const QString& detail,
+                       qint64 start, qint64 duration);
+
+    // from KST_TRACE
+    static void initFromEnvironment();
+
+  private:
+    static QAtomicInt _enabled;
+};
+
+
+/**
+ * Records the time from construction to destruction, if tracing is on
+ * when the span starts.  The detail is only worth working out when
+ * isActive().
+ */
+class TraceSpan {
+  public:
+    TraceSpan(const char *category, const char *name)
+      : _category(category), _name(name), _start(Trace::isEnabled() ? Trace::now() : -1) {}
+    ~TraceSpan() {
+      if (_start >= 0) {
+        Trace::record(_category, _name, _detail, _start, Trace::now() - _start);
+      }
+    }
+
+    bool isActive() const { return _start >= 0; }
+    void setDetail(const QString& detail) { _detail = detail; }
+
+  private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char *_category;
+    const char *_name;
+    qint64 _start;
+    QString _detail;
+};
+
+}
+
+#define TRACE_SPAN(category, name) \
+  Kst::TraceSpan trace_span_(category, name)
+
+// detail is only evaluated while tracing
+#define TRACE_SPAN_DETAIL(category, name, detail) \
+  Kst::TraceSpan trace_span_(category, name); \
+  if (trace_span_.isActive()) trace_span_.setDetail(detail)
+
+#endif
+// vim: ts=2 sw=2 et
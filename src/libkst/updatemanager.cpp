@@ -13,10 +13,15 @@
 #include "updatemanager.h"
 
 #include "primitive.h"
+#include "changenotifier.h"
 #include "datasource.h"
+#include "memorybudget.h"
+#include "vector.h"
 #include "objectstore.h"
 #include "measuretime.h"
+#include "trace.h"
 #include <QCoreApplication>
+#include <QMap>
 #include <QTimer>
 #include <QDebug>
 
@@ -47,6 +52,9 @@ UpdateManager::UpdateManager() {
   _store = 0;
   _delayedUpdateScheduled = false;
   _updateInProgress = false;
+  _fullUpdate = false;
+  _dependenciesGeneration = -1;
+  _demandValid = false;
   _time.start();
 }
 
@@ -54,12 +62,43 @@ UpdateManager::UpdateManager() {
 UpdateManager::~UpdateManager() {
 }
 
+
+void UpdateManager::setStore(ObjectStore *store) {
+  _store = store;
+  _dependenciesGeneration = -1;
+  _shown.clear();
+  _hidden.clear();
+  _stale.clear();
+  _demandValid = false;
+}
+
 void UpdateManager::delayedUpdates() {
   _delayedUpdateScheduled = false;
-  doUpdates();
+  scheduleUpdates(false);
 }
 
+
 void UpdateManager::doUpdates(bool forceImmediate) {
+  _fullUpdate = true;
+  scheduleUpdates(forceImmediate);
+}
+
+
+void UpdateManager::doSourceUpdates(DataSource *source) {
+  _changedSources.insert(source);
+  scheduleUpdates(false);
+}
+
+
+void UpdateManager::doSourceUpdates(const QList<DataSource*> &sources) {
+  foreach (DataSource *source, sources) {
+    _changedSources.insert(source);
+  }
+  scheduleUpdates(false);
+}
+
+
+void UpdateManager::scheduleUpdates(bool forceImmediate) {
   if (_delayedUpdateScheduled && !forceImmediate) {
     return;
   }
@@ -74,7 +113,7 @@ void UpdateManager::doUpdates(bool forceImmediate) {
   }
 
   int dT = _time.elapsed();
-  if (((dT<_minUpdatePeriod) || (_updateInProgress)) && (!forceImmediate)) {
+  if (((dT<_minUpdatePeriod && !changesAreRare()) || (_updateInProgress)) && (!forceImmediate)) {
     if (!_delayedUpdateScheduled) {
       _delayedUpdateScheduled = true;
       int deferTime = _minUpdatePeriod-dT;
@@ -88,8 +127,59 @@ void UpdateManager::doUpdates(bool forceImmediate) {
   _updateInProgress = true;
   _time.restart();
 
+  TRACE_SPAN("update", _fullUpdate ? "full update" : "source update");
+
   _serial++;
 
+  if (_fullUpdate) {
+    updateAll();
+  } else {
+    updateSources();
+  }
+
+  if (forceImmediate) {
+    foreach(DataSourcePtr ds, _store->dataSourceList()) {
+        ds->vector().readingDone();
+    }
+  }
+
+  settleStorage();
+
+  emit objectsUpdated(_serial);
+}
+
+
+// The minimum update period keeps sources which change all the time from
+// flooding the update loop; sources which change much less often than
+// that need not wait for it.
+bool UpdateManager::changesAreRare() const {
+  if (_fullUpdate || _changedSources.isEmpty()) {
+    return false;
+  }
+  foreach (DataSource *source, _changedSources) {
+    // changes per second; 0 if not known yet
+    const double rate = ChangeNotifier::self()->changeRate(source);
+    if (rate <= 0.0 || rate * _minUpdatePeriod > 500.0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// Updates every data source and object in the store.
+void UpdateManager::updateAll() {
+  _fullUpdate = false;
+  _changedSources.clear();
+  // inputs may have been changed without adding or removing objects
+  if (_hidden.isEmpty()) {
+    _dependenciesGeneration = -1;
+    _stale.clear();
+  } else {
+    buildDependencies();
+    updateDemand();
+  }
+
   int n_updated=0, n_deferred=0, n_unchanged = 0;
   qint64 retval;
 
@@ -105,15 +195,120 @@ void UpdateManager::doUpdates(bool forceImmediate) {
   }
 
   //qDebug() << "ds up: " << n_updated << "  ds def: " << n_deferred << " n_no: " << n_unchanged;
-  
-  //MeasureTime t(" UpdateManager::doUpdates loop");
+
+  updateObjects(_store->objectList());
+}
+
+
+// Updates the data sources in _changedSources, and then only the objects
+// downstream of those which changed.  Objects upstream of those are
+// updated too, so that every object visited has all of its inputs at this
+// serial; the rest keep their serial until the next update reaches them,
+// which objectUpdate() handles like any other skipped update.
+void UpdateManager::updateSources() {
+  QSet<Object*> changedSources;
+  foreach (DataSource *source, _changedSources) {
+    changedSources.insert(source);
+  }
+  _changedSources.clear();
+
+  if (_dependenciesGeneration != _store->generation()) {
+    buildDependencies();
+  }
+  updateDemand();
+
+  QSet<Object*> checked;
+  QList<Object*> changed;
+  foreach (DataSourcePtr ds, _store->dataSourceList()) {
+    if (changedSources.contains(ds.data())) {
+      ds->writeLock();
+      if (ds->objectUpdate(_serial) == Object::Updated) {
+        changed.append(ds.data());
+      }
+      ds->unlock();
+      checked.insert(ds.data());
+    }
+  }
+
+  QSet<Object*> subgraph;
+  while (!changed.isEmpty()) {
+    // everything using what changed...
+    QList<Object*> pending = changed;
+    QList<Object*> downstream;
+    changed.clear();
+    while (!pending.isEmpty()) {
+      foreach (Object *dependent, _dependents.value(pending.takeLast())) {
+        if (!subgraph.contains(dependent)) {
+          subgraph.insert(dependent);
+          pending.append(dependent);
+          downstream.append(dependent);
+        }
+      }
+    }
+
+    // ...and everything those use, in turn
+    pending = downstream;
+    while (!pending.isEmpty()) {
+      foreach (Object *input, _inputs.value(pending.takeLast())) {
+        if (!subgraph.contains(input) && !checked.contains(input)) {
+          subgraph.insert(input);
+          pending.append(input);
+        }
+      }
+    }
+
+    // other data sources reached on the way up are checked as well, and
+    // if they changed, their dependents are added in the next round
+    foreach (DataSourcePtr ds, _store->dataSourceList()) {
+      if (subgraph.contains(ds.data()) && !checked.contains(ds.data())) {
+        ds->writeLock();
+        if (ds->objectUpdate(_serial) == Object::Updated) {
+          changed.append(ds.data());
+        }
+        ds->unlock();
+        checked.insert(ds.data());
+      }
+    }
+  }
+
+  QList<ObjectPtr> objects = ordered(subgraph);
+  if (!objects.isEmpty()) {
+    updateObjects(objects);
+  }
+}
+
+
+// The objects which are in the store, in the order of the store, as a full
+// update would visit them.
+QList<ObjectPtr> UpdateManager::ordered(const QSet<Object*> &objects) const {
+  QMap<int, ObjectPtr> ordered;
+  foreach (Object *object, objects) {
+    QHash<Object*, int>::ConstIterator it = _order.constFind(object);
+    if (it != _order.constEnd()) {
+      ordered.insert(it.value(), ObjectPtr(object));
+    }
+  }
+  return ordered.values();
+}
+
+
+// Returns true if any object changed.
+bool UpdateManager::updateObjects(const QList<ObjectPtr> &objects, bool skipStale) {
+  int n_updated=0, n_deferred=0, n_unchanged = 0;
+  qint64 retval;
+  bool changed = false;
+
+  TRACE_SPAN("update", "update objects");
 
   int i_loop = retval = 0;
-  int maxloop = _store->objectList().size();
+  int maxloop = objects.size();
   do {
     n_updated = n_unchanged = n_deferred = 0;
     // update data objects
-    foreach (ObjectPtr p, _store->objectList()) {
+    foreach (ObjectPtr p, objects) {
+      if (skipStale && _stale.contains(p.data())) {
+        continue;
+      }
       p->writeLock();
       retval = p->objectUpdate(_serial);
       p->unlock();
@@ -122,18 +317,166 @@ void UpdateManager::doUpdates(bool forceImmediate) {
       else if (retval == Object::Deferred) n_deferred++;
       else if (retval == Object::NoChange) n_unchanged++;
     }
+    changed |= n_updated > 0;
     maxloop = qMin(maxloop,n_deferred);
     //qDebug() << "loop: " << i_loop << " obj up: " << n_updated << "  obj def: " << n_deferred << " obj_no: " << n_unchanged << "dt:" << double(_time.elapsed())/1000.0;
     i_loop++;
   } while ((n_deferred + n_updated > 0) && (i_loop<=maxloop));
 
-  if (forceImmediate) {
-    foreach(DataSourcePtr ds, _store->dataSourceList()) {
-        ds->vector().readingDone();
+  return changed;
+}
+
+
+void UpdateManager::buildDependencies() {
+  _inputs.clear();
+  _dependents.clear();
+  _order.clear();
+
+  QList<ObjectPtr> objects = _store->objectList();
+  for (int i = 0; i < objects.size(); ++i) {
+    Object *object = objects.at(i).data();
+    object->readLock();
+    QList<Object*> inputs = object->inputObjects();
+    object->unlock();
+
+    _order.insert(object, i);
+    _inputs.insert(object, inputs);
+    foreach (Object *input, inputs) {
+      _dependents[input].append(object);
+    }
+  }
+  _dependenciesGeneration = _store->generation();
+  _demandValid = false;
+}
+
+
+bool UpdateManager::setDemand(const QList<Object*> &shown, const QList<Object*> &hidden) {
+  QSet<Object*> shownSet = shown.toSet();
+  QSet<Object*> hiddenSet = hidden.toSet();
+  if (!_store || (shownSet == _shown && hiddenSet == _hidden)) {
+    return false;
+  }
+  _shown = shownSet;
+  _hidden = hiddenSet;
+  _demandValid = false;
+
+  if (_dependenciesGeneration != _store->generation()) {
+    buildDependencies();
+  }
+  updateDemand();
+
+  // bring what was left behind up to the current serial; everything it
+  // reads is either there already or left behind as well
+  QSet<Object*> behind;
+  foreach (const ObjectPtr &object, _store->objectList()) {
+    if (object->serial() != _serial && !_stale.contains(object.data())) {
+      behind.insert(object.data());
     }
   }
+  if (behind.isEmpty()) {
+    return false;
+  }
+  return updateObjects(ordered(behind));
+}
 
-  emit objectsUpdated(_serial);
+
+void UpdateManager::ensureUpdated(Object *object) {
+  if (!_store || !object || object->serial() == _serial) {
+    return;
+  }
+  if (_dependenciesGeneration != _store->generation()) {
+    buildDependencies();
+  }
+
+  QSet<Object*> upstream;
+  QList<Object*> pending;
+  upstream.insert(object);
+  pending.append(object);
+  while (!pending.isEmpty()) {
+    foreach (Object *input, _inputs.value(pending.takeLast())) {
+      if (!upstream.contains(input)) {
+        upstream.insert(input);
+        pending.append(input);
+      }
+    }
+  }
+  updateObjects(ordered(upstream), false);
+}
+
+
+// Lets the memory budget keep the vectors read by shown objects on the heap,
+// and move the others to mapped files when it runs over.
+void UpdateManager::settleStorage() {
+  if (!MemoryBudget::self()->unsettled()) {
+    return;
+  }
+  if (_dependenciesGeneration != _store->generation()) {
+    buildDependencies();
+  }
+
+  // without a setDemand() nothing is known to be hidden
+  const bool allShown = _shown.isEmpty() && _hidden.isEmpty();
+  QSet<Object*> inUse;
+  QList<Object*> pending = _shown.toList();
+  while (!pending.isEmpty()) {
+    foreach (Object *input, _inputs.value(pending.takeLast())) {
+      if (!inUse.contains(input)) {
+        inUse.insert(input);
+        pending.append(input);
+      }
+    }
+  }
+
+  foreach (const VectorPtr &vector, _store->getObjects<Vector>()) {
+    vector->writeLock();
+    vector->settleStorage(allShown || inUse.contains(vector.data()));
+    vector->unlock();
+  }
+}
+
+
+// Works out which objects updates can skip: those which none of the shown
+// objects, objects which nothing reads, or objects to always update read.
+void UpdateManager::updateDemand() {
+  if (_demandValid) {
+    return;
+  }
+  _demandValid = true;
+  _stale.clear();
+  if (_hidden.isEmpty()) {
+    return;
+  }
+
+  QSet<Object*> demanded;
+  QList<Object*> pending;
+  for (QHash<Object*, int>::ConstIterator it = _order.constBegin(); it != _order.constEnd(); ++it) {
+    Object *object = it.key();
+    bool root = object->alwaysUpdate() || _shown.contains(object);
+    if (!root && !_hidden.contains(object) && _dependents.value(object).isEmpty()) {
+      // nothing reads it; unless its provider computes it along with
+      // everything else, it is updated as it always was
+      Primitive *primitive = qobject_cast<Primitive*>(object);
+      root = !(primitive && primitive->provider());
+    }
+    if (root) {
+      demanded.insert(object);
+      pending.append(object);
+    }
+  }
+  while (!pending.isEmpty()) {
+    foreach (Object *input, _inputs.value(pending.takeLast())) {
+      if (!demanded.contains(input)) {
+        demanded.insert(input);
+        pending.append(input);
+      }
+    }
+  }
+
+  for (QHash<Object*, int>::ConstIterator it = _order.constBegin(); it != _order.constEnd(); ++it) {
+    if (!demanded.contains(it.key())) {
+      _stale.insert(it.key());
+    }
+  }
 }
 }
 
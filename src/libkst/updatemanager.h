@@ -16,9 +16,12 @@
 #include "object.h"
 
 #include <QGraphicsRectItem>
+#include <QHash>
+#include <QSet>
 #include <QTime>
 
 namespace Kst {
+class DataSource;
 class ObjectStore;
 
 class KSTCORE_EXPORT UpdateManager : public QObject
@@ -33,8 +36,30 @@ class KSTCORE_EXPORT UpdateManager : public QObject
     void setPaused(bool paused) { _paused = paused;}
     bool paused() { return _paused; }
 
-    void setStore(ObjectStore *store) {_store = store;}
+    void setStore(ObjectStore *store);
 
+    qint64 serial() const { return _serial; }
+
+
+    /** Like doUpdates(), for a data source which may have changed: unless
+        other updates are due as well, only the source and the objects which
+        depend on it are updated. */
+    void doSourceUpdates(DataSource *source);
+    /** The same for several sources at once, in one update. */
+    void doSourceUpdates(const QList<DataSource*> &sources);
+
+    /** Demand-driven updates.  shown are the objects read by what is on
+        screen, hidden the ones read only by views which are not.  Objects
+        which only feed hidden ones are left behind by updates until they
+        are shown again or ensureUpdated() asks for them; objects which
+        nothing reads, or with Object::alwaysUpdate() set, are always
+        updated.  Brings what is shown up to date, and returns true if
+        anything changed doing so. */
+    bool setDemand(const QList<Object*> &shown, const QList<Object*> &hidden);
+
+    /** Brings object and what it reads up to date, if updates left them
+        behind; for reading objects nothing shows. */
+    void ensureUpdated(Object *object);
 
   public Q_SLOTS:
     void doUpdates(bool forceImmediate = false);
@@ -50,6 +75,16 @@ class KSTCORE_EXPORT UpdateManager : public QObject
     static void cleanup();
     QTime _time;
 
+    void scheduleUpdates(bool forceImmediate);
+    void updateAll();
+    void updateSources();
+    bool updateObjects(const QList<ObjectPtr> &objects, bool skipStale = true);
+    void buildDependencies();
+    void updateDemand();
+    void settleStorage();
+    bool changesAreRare() const;
+    QList<ObjectPtr> ordered(const QSet<Object*> &objects) const;
+
   private:
     bool _delayedUpdate;
     int _minUpdatePeriod;
@@ -58,6 +93,23 @@ class KSTCORE_EXPORT UpdateManager : public QObject
     bool _updateInProgress;
     qint64 _serial;
     ObjectStore *_store;
+
+    // set until the next update if it has to visit everything
+    bool _fullUpdate;
+    QSet<DataSource*> _changedSources;
+
+    // the inputs of each object, the objects using each object, and the
+    // position of each object in the store, as of _dependenciesGeneration
+    QHash<Object*, QList<Object*> > _inputs;
+    QHash<Object*, QList<Object*> > _dependents;
+    QHash<Object*, int> _order;
+    qint64 _dependenciesGeneration;
+
+    // see setDemand(); _stale holds what updates skip
+    QSet<Object*> _shown;
+    QSet<Object*> _hidden;
+    QSet<Object*> _stale;
+    bool _demandValid;
 };
 
 }
@@ -29,8 +29,10 @@
 
 
 #include "datacollection.h"
+#include "datasidecar.h"
 #include "math_kst.h"
 #include "debug.h"
+#include "memorybudget.h"
 #include "objectstore.h"
 #include "updatemanager.h"
 
@@ -61,13 +63,16 @@ Vector::Vector(ObjectStore *store)
 
   int size = INITSIZE;
 
-  _v = static_cast<double*>(malloc(size * sizeof(double)));
-  if (!_v) { // Malloc failed
-    _v = static_cast<double*>(malloc(sizeof(double)));
+  _v = 0L;
+  if (!MemoryBudget::self()->reallocate(_v, size * sizeof(double), 0L)) { // Malloc failed
+    MemoryBudget::self()->reallocate(_v, sizeof(double), 0L);
     _size = 1;
   } else {
     _size = size;
   }
+  _vOffset = 0;
+  _vCapacity = _size;
+  _windowHeadroom = false;
   _is_rising = false;
 
   _scalars.clear();
@@ -89,7 +94,7 @@ void Vector::_initializeShortName() {
 
 Vector::~Vector() {
   if (_v) {
-    free(_v);
+    MemoryBudget::self()->release(_v - _vOffset);
     _v = 0;
   }
 }
@@ -145,6 +150,7 @@ const QString& Vector::typeString() const {
 /** Return v[i], i is sample number, interpolated to have ns_i total
     samples in vector */
 double Vector::interpolate(int in_i, int ns_i) const {
+  ensureView();
   GENERATE_INTERPOLATION
 }
 
@@ -232,6 +238,7 @@ double kstInterpolate(double *_v, int _size, int in_i, int ns_i) {
 // FIXME: optimize me - possible that floor() (especially) and isnan() are
 //        expensive here.
 double Vector::interpolateNoHoles(int in_i, int ns_i) const {
+  ensureView();
   GENERATE_INTERPOLATION
 }
 
@@ -250,6 +257,7 @@ double Vector::value(int i) const {
   if (i < 0 || i >= _size) { // can't look before beginning or past end
     return 0.0;
   }
+  ensureView();
   return _v[i];
 }
 
@@ -326,8 +334,12 @@ void Vector::updateScalars() {
 }
 
 double* Vector::realloced(double *memptr, int newSize) {
-  double *old = _v;
-  _v = memptr;
+  double *old = _v - _vOffset;
+  if (memptr != _v) {
+    _v = memptr;
+    _vOffset = 0;
+    _vCapacity = newSize;
+  }
   if (newSize < _size) {
     NumNew = newSize; // all new if we shrunk the vector
   } else {
@@ -341,12 +353,15 @@ double* Vector::realloced(double *memptr, int newSize) {
 
 void Vector::setV(double *memptr, int newSize) {
   _v = memptr;
+  _vOffset = 0;
+  _vCapacity = newSize;
   NumNew = newSize;
   _size = newSize;
 }
 
 
 void Vector::zero() {
+  ensureView();
   _ns_min = _ns_max = 0.0;
   memset(_v, 0, sizeof(double)*_size);
   updateScalars();
@@ -354,6 +369,7 @@ void Vector::zero() {
 
 
 void Vector::blank() {
+  ensureView();
   _ns_min = _ns_max = 0.0;
   for (int i = 0; i < _size; ++i) {
     _v[i] = NOPOINT;
@@ -364,9 +380,28 @@ void Vector::blank() {
 
 bool Vector::resize(int sz, bool init) {
   if (sz > 0) {
-    if (!kstrealloc(_v, sz*sizeof(double))){
-       qCritical() << "Vector resize failed";
-       return false;
+    ensureView();
+    double *base = _v - _vOffset;
+    if (_vOffset > 0 && _vOffset + sz > _vCapacity) {
+      // out of headroom: move the data back to the start of the allocation
+      memmove(base, _v, qMin(_size, sz)*sizeof(double));
+      _v = base;
+      _vOffset = 0;
+    }
+    if (_vOffset == 0) {
+      int capacity = sz;
+      if (_windowHeadroom) {
+        // keep the allocation while it is between one and four times the size
+        capacity = (sz > _vCapacity || 4*sz < _vCapacity) ? 2*sz : _vCapacity;
+      }
+      if (capacity != _vCapacity) {
+        if (!MemoryBudget::self()->reallocate(base, capacity*sizeof(double), this)){
+           qCritical() << "Vector resize failed";
+           return false;
+        }
+        _v = base;
+        _vCapacity = capacity;
+      }
     }
     if (init && _size < sz) {
       for (int i = _size; i < sz; ++i) {
@@ -380,6 +415,38 @@ bool Vector::resize(int sz, bool init) {
 }
 
 
+void Vector::settleStorage(bool shown) {
+  double *base = _v - _vOffset;
+  if (MemoryBudget::self()->settle(base, shown, this)) {
+    _v = base + _vOffset;
+  }
+}
+
+
+void Vector::shiftLeft(int shift, int count) {
+  if (shift <= 0) {
+    return;
+  }
+  if (_windowHeadroom && shift <= _size) {
+    _v += shift;
+    _vOffset += shift;
+    _size -= shift;
+  } else {
+    memmove(_v, _v + shift, count*sizeof(double));
+  }
+}
+
+
+void Vector::setWindowHeadroom(bool headroom) {
+  _windowHeadroom = headroom;
+}
+
+
+void Vector::materialize() const {
+  _viewPending.fetchAndStoreRelease(0);
+}
+
+
 void Vector::internalUpdate() {
   int i, i0;
   double sum, sum2, last, first, v;
@@ -514,6 +581,7 @@ void Vector::save(QXmlStreamWriter &s) {
   }
   s.writeStartElement("vector");
   if (_saveData) {
+    ensureView();
     QByteArray qba(length()*sizeof(double), '\0');
     QDataStream qds(&qba, QIODevice::WriteOnly);
 
@@ -521,7 +589,7 @@ void Vector::save(QXmlStreamWriter &s) {
       qds << _v[i];
     }
 
-    s.writeTextElement("data_v2", qCompress(qba).toBase64());
+    DataSidecar::writePayload(s, "data_v2", qba);
   }
   saveNameInfo(s, VNUM|XNUM);
   s.writeEndElement();
@@ -533,6 +601,7 @@ void Vector::setNewAndShift(int inNew, int inShift) {
 }
 
 double *Vector::value() const {
+  ensureView();
   return _v;
 }
 
@@ -765,6 +834,7 @@ QByteArray Vector::scriptInterface(QList<QByteArray> &c) {
 
 QByteArray Vector::getBinaryArray() const {
     readLock();
+    ensureView();
     QByteArray ret;
     QDataStream ds(&ret,QIODevice::WriteOnly);
     ds<<(qint64)_size;
@@ -20,6 +20,7 @@
 
 #include <math.h>
 
+#include <QAtomicInt>
 #include <QPointer>
 
 #include "primitive.h"
@@ -115,6 +116,10 @@ class KSTCORE_EXPORT Vector : public Primitive
 
     virtual void setNewAndShift(int inNew, int inShift);
 
+    /** Lets the memory budget move the samples to or from a mapped file.
+        shown is whether plots on screen read the vector.  Needs a lock. */
+    virtual void settleStorage(bool shown);
+
     /** Clear out the vector by setting everything to 0.0 */
     void zero();
 
@@ -190,6 +195,10 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** Where the vector is held */
     double *_v;
 
+    /** _v is _vOffset samples into an allocation of _vCapacity samples */
+    int _vOffset;
+    int _vCapacity;
+
     /** number of samples shifted since last newSync */
     int NumShifted;
 
@@ -213,11 +222,39 @@ class KSTCORE_EXPORT Vector : public Primitive
     /** should the vector data be saved? */
     bool _saveData : 1;
 
+    /** allocate room for the vector to scroll into; see shiftLeft() */
+    bool _windowHeadroom : 1;
+
     double _min, _max, _mean, _minPos;
 
     /** Scalar Maintenance methods */
     void CreateScalars(ObjectStore *store);
 
+    /** Drop the first shift samples, keeping the count samples after them
+        at the start of the vector.  With window headroom the start of the
+        vector moves forward instead, and the length drops by shift; the
+        data is only copied once the headroom is used up, so a scrolling
+        vector costs O(new samples) per update on average. */
+    void shiftLeft(int shift, int count);
+    void setWindowHeadroom(bool headroom);
+
+    /** Subclasses can keep their samples in another form while nothing
+        reads the vector (see DataVector::setStorage()).  While _viewPending
+        is set, the next read goes through materialize(), which brings the
+        samples back into _v, or just notes the read; everything reading _v
+        outside of an update calls ensureView() first. */
+    inline void ensureView() const {
+#if QT_VERSION >= 0x050000
+      if (_viewPending.loadAcquire()) {
+#else
+      if (int(_viewPending)) {
+#endif
+        materialize();
+      }
+    }
+    virtual void materialize() const;
+    mutable QAtomicInt _viewPending;
+
     virtual void deleteDependents();
 
     LabelInfo _labelInfo;
@@ -12,6 +12,7 @@
 
 #include "vectorfactory.h"
 
+#include "datasidecar.h"
 #include "debug.h"
 #include "vector.h"
 #include "generatedvector.h"
@@ -50,9 +51,7 @@ PrimitivePtr VectorFactory::generatePrimitive(ObjectStore *store, QXmlStreamRead
         Object::processShortNameIndexAttributes(attrs);
       } else if (n == "data"||n=="data_v2") {
 
-        QString qcs(xml.readElementText().toLatin1());
-        QByteArray qbca = QByteArray::fromBase64(qcs.toLatin1());
-        data = qUncompress(qbca);
+        data = DataSidecar::readPayload(xml);
         saveVer=(n=="data")?1:2;
 
       } else {
@@ -170,9 +169,7 @@ PrimitivePtr EditableVectorFactory::generatePrimitive(ObjectStore *store, QXmlSt
         }
         Object::processShortNameIndexAttributes(attrs);
       } else if (n == "data" || n == "data_v2") {
-        QString qcs(xml.readElementText().toLatin1());
-        QByteArray qbca = QByteArray::fromBase64(qcs.toLatin1());
-        data = qUncompress(qbca);
+        data = DataSidecar::readPayload(xml);
         dataVer=(n=="data_v2")?2:1;
       } else {
         return 0;
@@ -228,6 +225,8 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
   bool doAve=false;
   QString start_units;
   QString range_units;
+  DataVector::StorageType storage = DataVector::DoubleStorage;
+  double storage_scale = 1.0, storage_offset = 0.0;
 
   while (!xml.atEnd()) {
       const QString n = xml.name().toString();
@@ -244,6 +243,11 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
         doAve = attrs.value("doAve").toString() == "true" ? true : false;
         start_units = attrs.value("startUnits").toString();
         range_units = attrs.value("rangeUnits").toString();
+        storage = DataVector::storageTypeFromName(attrs.value("storage").toString());
+        if (attrs.hasAttribute("storageScale")) {
+          storage_scale = attrs.value("storageScale").toString().toDouble();
+          storage_offset = attrs.value("storageOffset").toString().toDouble();
+        }
 
         // set overrides if set from command line
         if (!store->override.fileName.isEmpty()) {
@@ -268,9 +272,7 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
 
       } else if (n == "data") {
 
-        QString qcs(xml.readElementText().toLatin1());
-        QByteArray qbca = QByteArray::fromBase64(qcs.toLatin1());
-        data = qUncompress(qbca);
+        data = DataSidecar::readPayload(xml);
 
       } else {
         return 0;
@@ -310,6 +312,7 @@ PrimitivePtr DataVectorFactory::generatePrimitive(ObjectStore *store, QXmlStream
   vector->setDescriptiveName(descriptiveName);
   vector->setStartUnits(start_units);
   vector->setRangeUnits(range_units);
+  vector->setStorage(storage, storage_scale, storage_offset);
   vector->registerChange();
   vector->unlock();
 
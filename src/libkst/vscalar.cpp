@@ -145,6 +145,14 @@ qint64 VScalar::maxInputSerialOfLastChange() const {
   return NoInputs;
 }
 
+QList<Object*> VScalar::inputObjects() const {
+  QList<Object*> inputs;
+  if (_file) {
+    inputs.append(_file.data());
+  }
+  return inputs;
+}
+
 PrimitivePtr VScalar::_makeDuplicate() const {
   Q_ASSERT(store());
   VScalarPtr scalar = store()->createObject<VScalar>();
@@ -42,6 +42,7 @@ class KSTCORE_EXPORT VScalar : public Scalar {
 
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
   public:
     virtual ~VScalar();
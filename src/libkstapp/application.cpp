@@ -26,6 +26,7 @@
 #include "datasourcepluginmanager.h"
 #include "dialogscriptinterface.h"
 #include "settings.h"
+#include "trace.h"
 
 #include <QIcon>
 
@@ -42,6 +43,8 @@ Application::Application(int &argc, char **argv)
   QCoreApplication::setApplicationName("Kst");
   setWindowIcon(QPixmap(":kst.png"));
 
+  Trace::initFromEnvironment();
+
   Builtins::initPrimitives(); //libkst
   Builtins::initDataSources(); //libkstapp
   Builtins::initObjects();    //libkstmath
@@ -13,6 +13,7 @@
 #include "applicationsettings.h"
 
 #include "updatemanager.h"
+#include "memorybudget.h"
 #include "defaultlabelpropertiestab.h"
 #include "settings.h"
 
@@ -50,6 +51,8 @@ ApplicationSettings::ApplicationSettings() :
   _useRaster = _settings.value("general/raster", false).toBool();
 
   _maxUpdate = _settings.value("general/minimumupdateperiod", QVariant(200)).toInt();
+  _memoryBudget = _settings.value("general/memorybudget", QVariant(0)).toInt();
+  _saveDataSeparately = _settings.value("general/savedataseparately", QVariant(false)).toBool();
 
   _showGrid = _settings.value("grid/showgrid", QVariant(false)).toBool();
   _snapToGrid = _settings.value("grid/snaptogrid", QVariant(false)).toBool();
@@ -176,6 +179,30 @@ void ApplicationSettings::setMinimumUpdatePeriod(const int period) {
 }
 
 
+int ApplicationSettings::memoryBudget() const {
+  return _memoryBudget;
+}
+
+
+void ApplicationSettings::setMemoryBudget(const int megabytes) {
+  _memoryBudget = megabytes;
+  _settings.setValue("general/memorybudget", megabytes);
+
+  MemoryBudget::self()->setBudget(qint64(megabytes) * 1024 * 1024);
+}
+
+
+bool ApplicationSettings::saveDataSeparately() const {
+  return _saveDataSeparately;
+}
+
+
+void ApplicationSettings::setSaveDataSeparately(bool separately) {
+  _saveDataSeparately = separately;
+  _settings.setValue("general/savedataseparately", separately);
+}
+
+
 bool ApplicationSettings::showGrid() const {
   return _showGrid;
 }
@@ -50,6 +50,13 @@ class ApplicationSettings : public QObject
     int minimumUpdatePeriod() const;
     void setMinimumUpdatePeriod(const int period);
 
+    // in MB; 0 means no limit
+    int memoryBudget() const;
+    void setMemoryBudget(const int megabytes);
+
+    bool saveDataSeparately() const;
+    void setSaveDataSeparately(bool separately);
+
     bool showGrid() const;
     void setShowGrid(bool showGrid);
 
@@ -89,6 +96,8 @@ class ApplicationSettings : public QObject
     qreal _refViewHeight;
     qreal _minFontSize;
     int _maxUpdate;
+    int _memoryBudget;
+    bool _saveDataSeparately;
     bool _showGrid;
     bool _snapToGrid;
     qreal _gridHorSpacing;
@@ -0,0 +1,294 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                   netterfield@astro.utoronto.ca                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "batchexport.h"
+
+#include "document.h"
+#include "mainwindow.h"
+#include "objectstore.h"
+#include "tabwidget.h"
+#include "updatemanager.h"
+#include "view.h"
+
+#ifndef KST_NO_SVG
+#include <QSvgGenerator>
+#endif
+#ifndef KST_NO_PRINTER
+#include <QPrinter>
+#endif
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrentRun>
+
+namespace Kst {
+
+static bool writeImage(const QImage &image, const QString &fileName, const QString &format) {
+  QImageWriter writer(fileName, format.toLatin1());
+  if (!writer.write(image)) {
+    qWarning("kst: could not write %s: %s", qPrintable(fileName), qPrintable(writer.errorString()));
+    return false;
+  }
+  return true;
+}
+
+
+BatchExport::BatchExport(MainWindow *mainWindow, Document *document)
+  : _mainWindow(mainWindow), _document(document), _size(1280, 1024), _rangeType(NoRange),
+    _firstFrame(0), _lastFrame(0), _frameStep(1), _timeStep(1.0) {
+}
+
+
+BatchExport::~BatchExport() {
+  waitForWrites();
+}
+
+
+void BatchExport::setFrameRange(int first, int last, int step) {
+  _rangeType = FrameRange;
+  _firstFrame = first;
+  _lastFrame = last;
+  _frameStep = qMax(1, step);
+}
+
+
+void BatchExport::setTimeRange(const QDateTime &first, const QDateTime &last, double stepSeconds) {
+  _rangeType = TimeRange;
+  _firstTime = first;
+  _lastTime = last;
+  _timeStep = stepSeconds;
+}
+
+
+bool BatchExport::exec() {
+  _format = QFileInfo(_fileName).suffix().toLower();
+  if (_format.isEmpty()) {
+    _format = "png";
+    _fileName += ".png";
+  }
+
+  QList<View*> views = _mainWindow->tabWidget()->views();
+  foreach (View *view, views) {
+    view->resize(_size);
+    view->processResize(_size);
+    view->setPrinting(true);
+  }
+  _mainWindow->setAllViewsShown(true);
+
+  // each step ends the vectors at a new frame, relative to what was loaded
+  _vectors.clear();
+  if (_rangeType != NoRange) {
+    foreach (const DataVectorPtr &v, _document->objectStore()->getObjects<DataVector>()) {
+      VectorRange range;
+      range.vector = v;
+      v->readLock();
+      range.f0 = v->reqStartFrame();
+      range.n = v->reqNumFrames();
+      v->unlock();
+      _vectors.append(range);
+    }
+  }
+
+  bool ok = true;
+  if (_rangeType == FrameRange) {
+    int step = 0;
+    for (int frame = _firstFrame; frame <= _lastFrame; frame += _frameStep) {
+      seekFrame(frame);
+      ok &= exportViews(step++);
+    }
+  } else if (_rangeType == TimeRange && _timeStep > 0.0) {
+    int step = 0;
+    const qint64 msecs = qint64(_timeStep * 1000.0);
+    for (QDateTime time = _firstTime; time <= _lastTime; time = time.addMSecs(msecs)) {
+      seekTime(time);
+      ok &= exportViews(step++);
+    }
+  } else {
+    // bring what the views now show up to date
+    UpdateManager::self()->doUpdates(true);
+    ok = exportViews(-1);
+  }
+  ok &= waitForWrites();
+
+  foreach (View *view, views) {
+    view->setPrinting(false);
+  }
+  _mainWindow->setAllViewsShown(false);
+  _vectors.clear();
+  return ok;
+}
+
+
+void BatchExport::seekFrame(int frame) {
+  foreach (const VectorRange &range, _vectors) {
+    endVectorAt(range, frame);
+  }
+  UpdateManager::self()->doUpdates(true);
+}
+
+
+void BatchExport::seekTime(const QDateTime &time) {
+  foreach (const VectorRange &range, _vectors) {
+    DataSourcePtr ds = range.vector->dataSource();
+    if (!ds) {
+      continue;
+    }
+    bool ok = false;
+    ds->readLock();
+    int frame = ds->supportsTimeConversions() ? ds->sampleForTime(time, &ok) : 0;
+    ds->unlock();
+    if (ok) {
+      endVectorAt(range, frame);
+    } else if (time == _firstTime) {
+      qWarning("kst: %s has no time information; %s is not stepped",
+               qPrintable(ds->fileName()), qPrintable(range.vector->Name()));
+    }
+  }
+  UpdateManager::self()->doUpdates(true);
+}
+
+
+void BatchExport::endVectorAt(const VectorRange &range, int frame) {
+  if (frame < 0) {
+    return;
+  }
+  int f0;
+  if (range.n > 0) {
+    // a window of the same length, sliding with the frame
+    f0 = qMax(0, frame - range.n + 1);
+  } else {
+    // reads to the end of the file: read up to the frame instead
+    f0 = qBound(0, range.f0, frame);
+  }
+
+  DataVectorPtr v = range.vector;
+  v->writeLock();
+  v->changeFrames(f0, frame - f0 + 1, v->skip(), v->doSkip(), v->doAve());
+  v->unlock();
+}
+
+
+bool BatchExport::exportViews(int step) {
+  bool ok = true;
+  QList<View*> views = _mainWindow->tabWidget()->views();
+  for (int i_view = 0; i_view < views.count(); ++i_view) {
+    ok &= renderView(views.at(i_view), fileName(i_view, step));
+  }
+  return ok;
+}
+
+
+bool BatchExport::renderView(View *view, const QString &fileName) {
+  if (_format == "svg") {
+#ifndef KST_NO_SVG
+    QSvgGenerator generator;
+    generator.setFileName(fileName);
+    generator.setResolution(300);
+    generator.setSize(_size);
+    generator.setViewBox(QRect(QPoint(0, 0), _size));
+
+    QPainter painter;
+    if (!painter.begin(&generator)) {
+      qWarning("kst: could not write %s", qPrintable(fileName));
+      return false;
+    }
+    view->render(&painter);
+    painter.end();
+    return true;
+#else
+    qWarning("kst: svg export is not available in this build");
+    return false;
+#endif
+  } else if (_format == "pdf") {
+#ifndef KST_NO_PRINTER
+    QPrinter printer(QPrinter::ScreenResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(fileName);
+    printer.setOrientation(QPrinter::Portrait);
+    printer.setFullPage(true);
+    printer.setPaperSize(QSizeF(_size), QPrinter::DevicePixel);
+
+    QPainter painter;
+    if (!painter.begin(&printer)) {
+      qWarning("kst: could not write %s", qPrintable(fileName));
+      return false;
+    }
+    view->render(&painter);
+    painter.end();
+    return true;
+#else
+    qWarning("kst: pdf export is not available in this build");
+    return false;
+#endif
+  }
+
+  // Rendering uses the scene, so it stays on this thread; the curves and
+  // images in it are computed in parallel by View::prepareRelations() as it
+  // starts.  Encoding and writing the image overlaps with the next render.
+  QImage image(_size, QImage::Format_ARGB32);
+  QPainter painter(&image);
+  view->render(&painter);
+  painter.end();
+
+  bool ok = true;
+  const int maxPending = qMax(2, QThread::idealThreadCount());
+  while (_writes.count() >= maxPending) {
+    ok &= _writes.takeFirst().result();
+  }
+  _writes.append(QtConcurrent::run(writeImage, image, fileName, _format));
+  return ok;
+}
+
+
+// A tab name as a part of file names: without its accelerator marks, and
+// with path separators and what file systems don't allow replaced.
+static QString fileNamePart(const QString &tabName) {
+  static const QString notAllowed("/\\:*?\"<>|");
+  QString part = tabName;
+  part.remove(QChar('&'));
+  for (int i = 0; i < part.length(); ++i) {
+    if (part.at(i).unicode() < 0x20 || notAllowed.contains(part.at(i))) {
+      part[i] = QChar('_');
+    }
+  }
+  return part;
+}
+
+
+QString BatchExport::fileName(int view, int step) const {
+  QFileInfo info(_fileName);
+  QString name = info.dir().path() + '/' + info.completeBaseName();
+  if (_mainWindow->tabWidget()->views().count() != 1) {
+    name += '_' + fileNamePart(_mainWindow->tabWidget()->tabBar()->tabText(view));
+  }
+  if (step >= 0) {
+    name += QString("_%1").arg(step, 5, 10, QChar('0'));
+  }
+  return name + '.' + info.suffix();
+}
+
+
+bool BatchExport::waitForWrites() {
+  bool ok = true;
+  while (!_writes.isEmpty()) {
+    ok &= _writes.takeFirst().result();
+  }
+  return ok;
+}
+
+}
+
+// vim: ts=2 sw=2 et
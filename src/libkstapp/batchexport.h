@@ -0,0 +1,87 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                   netterfield@astro.utoronto.ca                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QDateTime>
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+#include "datavector.h"
+
+namespace Kst {
+
+class Document;
+class MainWindow;
+class View;
+
+/**
+ * Exports every tab of a loaded session to image files without showing the
+ * main window (kst --export).  The views are sized once, and each image is
+ * encoded and written on a worker thread while the next one is rendered;
+ * kst exits with 1 if any of them could not be written.
+ * With a frame or time range the data vectors are stepped through it and
+ * one image per tab is written for each step, for time-lapse sequences.
+ */
+class BatchExport
+{
+  public:
+    BatchExport(MainWindow *mainWindow, Document *document);
+    ~BatchExport();
+
+    // the format comes from the suffix: png (or any QImageWriter format), svg or pdf
+    void setFileName(const QString &fileName) { _fileName = fileName; }
+    void setSize(const QSize &size) { _size = size; }
+    // last frame of the data in each step; step > 0
+    void setFrameRange(int first, int last, int step);
+    void setTimeRange(const QDateTime &first, const QDateTime &last, double stepSeconds);
+
+    // false if any file could not be written
+    bool exec();
+
+  private:
+    struct VectorRange {
+      DataVectorPtr vector;
+      int f0;
+      int n;
+    };
+
+    void seekFrame(int frame);
+    void seekTime(const QDateTime &time);
+    void endVectorAt(const VectorRange &range, int frame);
+    bool exportViews(int step);
+    bool renderView(View *view, const QString &fileName);
+    QString fileName(int view, int step) const;
+    bool waitForWrites();
+
+    MainWindow *_mainWindow;
+    Document *_document;
+    QString _fileName;
+    QString _format;
+    QSize _size;
+    enum { NoRange, FrameRange, TimeRange } _rangeType;
+    int _firstFrame, _lastFrame, _frameStep;
+    QDateTime _firstTime, _lastTime;
+    double _timeStep;
+    QList<VectorRange> _vectors;
+    QList<QFuture<bool> > _writes;
+};
+
+}
+
+#endif
+
+// vim: ts=2 sw=2 et
@@ -15,6 +15,7 @@
 #include <QGraphicsSceneMouseEvent>
 
 #include "math_kst.h"
+#include "curve.h"
 
 #include "plotitem.h"
 #include "plotaxis.h"
@@ -41,49 +42,16 @@ void CartesianRenderItem::paintRelations(QPainter *painter) {
   painter->save();
   painter->translate(normalRect.x(), normalRect.y());
 
-  foreach (RelationPtr relation, relationList()) {
+  CurveRenderContext context;
+  setupContext(context);
+  context.painter = painter;
+  context.window = painter->window();
 
-    CurveRenderContext context;
-    context.painter = painter;
-    context.window = QRect(); //no idea if this should be floating point
+  foreach (RelationPtr relation, relationList()) {
     context.penWidth = painter->pen().width(); //floating point??
-    context.xLog = plotItem()->xAxis()->axisLog();
-    context.yLog = plotItem()->yAxis()->axisLog();
-    context.xLogBase = 10.0;
-    context.yLogBase = 10.0;
     context.foregroundColor = painter->pen().color();
     context.backgroundColor = painter->brush().color();
 
-    //Set the projection box...
-    context.XMin = projectionRect().left();
-    context.XMax = projectionRect().right();
-    context.YMin = projectionRect().top();
-    context.YMax = projectionRect().bottom();
-
-    //Set the log box...
-    context.x_max = plotItem()->xAxis()->axisLog() ? logXHi(context.XMax, context.xLogBase) : context.XMax;
-    context.y_max = plotItem()->yAxis()->axisLog() ? logXHi(context.YMax, context.yLogBase) : context.YMax;
-    context.x_min = plotItem()->xAxis()->axisLog() ? logXLo(context.XMin, context.xLogBase) : context.XMin;
-    context.y_min = plotItem()->yAxis()->axisLog() ? logXLo(context.YMin, context.yLogBase) : context.YMin;
-
-    //These are the bounding box in regular QGV coord
-    context.Lx = plotRect().left();
-    context.Hx = plotRect().right();
-    context.Ly = plotRect().top();
-    context.Hy = plotRect().bottom();
-
-    //To convert between the last two...
-    double m_X = double(plotRect().width())/(context.x_max - context.x_min);
-    double m_Y = -double(plotRect().height())/(context.y_max - context.y_min);
-    double b_X = context.Lx - m_X * context.x_min;
-    double b_Y = context.Ly - m_Y * context.y_max;
-
-    context.m_X = m_X;
-    context.m_Y = m_Y;
-    context.b_X = b_X;
-    context.b_Y = b_Y;
-    context.antialias = ApplicationSettings::self()->antialiasPlots();
-
     relation->paint(context);
   }
 
@@ -91,6 +59,60 @@ void CartesianRenderItem::paintRelations(QPainter *painter) {
 }
 
 
+void CartesianRenderItem::prepareRelations(const QRect &window, QList<RelationRenderJob> &jobs) {
+  CurveRenderContext context;
+  setupContext(context);
+  context.window = window;
+  // the pen ViewItem::paint() will hand to paintRelations()
+  context.penWidth = rescaledPen(window).width();
+
+  foreach (RelationPtr relation, relationList()) {
+    RelationRenderJob job;
+    job.relation = relation;
+    job.context = context;
+    jobs.append(job);
+  }
+}
+
+
+void CartesianRenderItem::setupContext(CurveRenderContext &context) const {
+  context.xLog = plotItem()->xAxis()->axisLog();
+  context.yLog = plotItem()->yAxis()->axisLog();
+  context.xLogBase = 10.0;
+  context.yLogBase = 10.0;
+
+  //Set the projection box...
+  context.XMin = projectionRect().left();
+  context.XMax = projectionRect().right();
+  context.YMin = projectionRect().top();
+  context.YMax = projectionRect().bottom();
+
+  //Set the log box...
+  context.x_max = plotItem()->xAxis()->axisLog() ? logXHi(context.XMax, context.xLogBase) : context.XMax;
+  context.y_max = plotItem()->yAxis()->axisLog() ? logXHi(context.YMax, context.yLogBase) : context.YMax;
+  context.x_min = plotItem()->xAxis()->axisLog() ? logXLo(context.XMin, context.xLogBase) : context.XMin;
+  context.y_min = plotItem()->yAxis()->axisLog() ? logXLo(context.YMin, context.yLogBase) : context.YMin;
+
+  //These are the bounding box in regular QGV coord
+  context.Lx = plotRect().left();
+  context.Hx = plotRect().right();
+  context.Ly = plotRect().top();
+  context.Hy = plotRect().bottom();
+
+  //To convert between the last two...
+  double m_X = double(plotRect().width())/(context.x_max - context.x_min);
+  double m_Y = -double(plotRect().height())/(context.y_max - context.y_min);
+  double b_X = context.Lx - m_X * context.x_min;
+  double b_Y = context.Ly - m_Y * context.y_max;
+
+  context.m_X = m_X;
+  context.m_Y = m_Y;
+  context.b_X = b_X;
+  context.b_Y = b_Y;
+  context.antialias = ApplicationSettings::self()->antialiasPlots();
+}
+
+
 void CartesianRenderItem::saveInPlot(QXmlStreamWriter &xml) {
   xml.writeStartElement("cartesianrender");
   PlotRenderItem::saveInPlot(xml);
@@ -25,10 +25,14 @@ class CartesianRenderItem : public PlotRenderItem
 
     virtual void saveInPlot(QXmlStreamWriter &xml);
     virtual void paintRelations(QPainter *painter);
+    virtual void prepareRelations(const QRect &window, QList<RelationRenderJob> &jobs);
 
     bool configureFromXml(QXmlStreamReader &xml, ObjectStore *store);
     const QString defaultsGroupName() const {return QString("plot");}
     virtual bool dataPosLockable() const {return false;}
+
+  private:
+    void setupContext(CurveRenderContext &context) const;
 };
 
 }
@@ -64,6 +64,16 @@ namespace Kst {
 "      --Letter                 Print to Letter sized paper.\n"
 "      --A4                     Print to A4 sized paper.\n"
 "      --png <filename>         Render to a png image, and exit.\n"
+"      --export <filename>      Render every tab to <filename> (png, svg, pdf or\n"
+"                               another image format, from the suffix) without\n"
+"                               showing a window, and exit.\n"
+"      --size <width>x<height>  Image size for --export.  default: 1280x1024\n"
+"      --frames <first>,<last>[,<step>]\n"
+"                               With --export, write one image per tab for each\n"
+"                               step, with the data ending at that frame.\n"
+"      --time <first>,<last>,<step seconds>\n"
+"                               As --frames, for ISO 8601 times.  Needs data\n"
+"                               sources with time information.\n"
 "File Options:\n"
 "      -f <startframe>          default: 'end' counts from end.\n"
 "      -n <numframes>           default: 'end' reads to end of file\n"
@@ -150,7 +160,9 @@ CommandLineParser::CommandLineParser(Document *doc, MainWindow* mw) :
       _useLines(true), _usePoints(false), _overrideStyle(false), _sampleRate(1.0), 
       _numFrames(-1), _startFrame(-1),
       _skip(0), _plotName(), _errorField(), _fileName(), _xField(QString("INDEX")),
-      _pngFile(QString()), _printFile(QString()), _landscape(false), _plotItem(0) {
+      _pngFile(QString()), _printFile(QString()), _exportFile(QString()), _exportSize(1280, 1024),
+      _exportFirstFrame(0), _exportLastFrame(0), _exportFrameStep(0), _exportTimeStep(0.0),
+      _landscape(false), _plotItem(0) {
 
   Q_ASSERT(QCoreApplication::instance());
   _arguments = QCoreApplication::instance()->arguments();
@@ -216,6 +228,17 @@ bool CommandLineParser::_setStringArg(QString &arg, QString Message) {
 }
 
 
+bool CommandLineParser::_setListArg(QStringList &arg, int min, int max, QString Message) {
+  bool ok = false;
+  if (_arguments.count()> 0) {
+    arg = _arguments.takeFirst().split(',');
+    ok = arg.count() >= min && arg.count() <= max;
+  }
+  if (!ok) printUsage(Message);
+  return ok;
+}
+
+
 DataVectorPtr CommandLineParser::createOrFindDataVector(QString field, DataSourcePtr ds) {
     DataVectorPtr xv;
     bool found = false;
@@ -655,6 +678,41 @@ bool CommandLineParser::processCommandLine(bool *ok) {
       *ok = _setStringArg(_document->objectStore()->override.fileName, tr("Usage: -F <datafile>\n"));
     } else if (arg == "--png") {
       *ok = _setStringArg(_pngFile, tr("Usage: --png <filename>\n"));
+    } else if (arg == "--export") {
+      *ok = _setStringArg(_exportFile, tr("Usage: --export <filename>\n"));
+    } else if (arg == "--size") {
+      QString size;
+      *ok = _setStringArg(size, tr("Usage: --size <width>x<height>\n"));
+      if (*ok) {
+        QStringList wh = size.split('x');
+        bool w_ok = false, h_ok = false;
+        if (wh.count() == 2) {
+          _exportSize = QSize(wh.at(0).toInt(&w_ok), wh.at(1).toInt(&h_ok));
+        }
+        *ok = w_ok && h_ok && !_exportSize.isEmpty();
+        if (!*ok) printUsage(tr("Usage: --size <width>x<height>\n"));
+      }
+    } else if (arg == "--frames") {
+      QStringList range;
+      *ok = _setListArg(range, 2, 3, tr("Usage: --frames <first>,<last>[,<step>]\n"));
+      if (*ok) {
+        bool ok1, ok2, ok3 = true;
+        _exportFirstFrame = range.at(0).toInt(&ok1);
+        _exportLastFrame = range.at(1).toInt(&ok2);
+        _exportFrameStep = range.count() > 2 ? range.at(2).toInt(&ok3) : 1;
+        *ok = ok1 && ok2 && ok3 && _exportFrameStep > 0 && _exportFirstFrame >= 0;
+        if (!*ok) printUsage(tr("Usage: --frames <first>,<last>[,<step>]\n"));
+      }
+    } else if (arg == "--time") {
+      QStringList range;
+      *ok = _setListArg(range, 3, 3, tr("Usage: --time <first>,<last>,<step seconds>\n"));
+      if (*ok) {
+        _exportFirstTime = QDateTime::fromString(range.at(0), Qt::ISODate);
+        _exportLastTime = QDateTime::fromString(range.at(1), Qt::ISODate);
+        _exportTimeStep = range.at(2).toDouble(ok);
+        *ok = *ok && _exportTimeStep > 0.0 && _exportFirstTime.isValid() && _exportLastTime.isValid();
+        if (!*ok) printUsage(tr("Usage: --time <first>,<last>,<step seconds>\n"));
+      }
 #ifndef KST_NO_PRINTER
     } else if (arg == "--print") {
       *ok = _setStringArg(_printFile, tr("Usage: --print <filename>\n"));
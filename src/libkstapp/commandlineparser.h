@@ -18,6 +18,8 @@
 #include "plotitem.h"
 #include "mainwindow.h"
 
+#include <QDateTime>
+#include <QSize>
 #include <QStringList>
 #ifndef KST_NO_PRINTER
 #include <QPrinter>
@@ -38,6 +40,15 @@ public:
   QString kstFileName();
   QString pngFile() const {return _pngFile;}
   QString printFile() const {return _printFile;}
+  QString exportFile() const {return _exportFile;}
+  QSize exportSize() const {return _exportSize;}
+  // frame range (step > 0) or time range (stepSeconds > 0) for --export
+  int exportFirstFrame() const {return _exportFirstFrame;}
+  int exportLastFrame() const {return _exportLastFrame;}
+  int exportFrameStep() const {return _exportFrameStep;}
+  QDateTime exportFirstTime() const {return _exportFirstTime;}
+  QDateTime exportLastTime() const {return _exportLastTime;}
+  double exportTimeStep() const {return _exportTimeStep;}
   //bool landscape() const {return _landscape;}
 
 private:
@@ -59,6 +70,14 @@ private:
   QString _xField;
   QString _pngFile;
   QString _printFile;
+  QString _exportFile;
+  QSize _exportSize;
+  int _exportFirstFrame;
+  int _exportLastFrame;
+  int _exportFrameStep;
+  QDateTime _exportFirstTime;
+  QDateTime _exportLastTime;
+  double _exportTimeStep;
   bool _landscape;
 #ifndef KST_NO_PRINTER
   QPrinter::PaperSize _paperSize;
@@ -80,6 +99,7 @@ private:
   bool _setIntArg(int *arg, QString Message, bool accept_end=false);
   bool _setDoubleArg(double *arg, QString Message);
   bool _setStringArg(QString &arg, QString Message);
+  bool _setListArg(QStringList &arg, int min, int max, QString Message);
   DataVectorPtr createOrFindDataVector(QString field, DataSourcePtr ds);
   void createOrFindPlot(const QString name);
   void createOrFindTab(const QString name);
@@ -36,6 +36,7 @@
 #include "csd.h"
 #include "basicplugin.h"
 #include "updateserver.h"
+#include "updatemanager.h"
 
 #include <QHeaderView>
 #include <QToolBar>
@@ -89,6 +90,8 @@ DataManager::DataManager(QWidget *parent, Document *doc)
   _contextMenu = new QMenu(this);
 
   connect(_purge, SIGNAL(clicked()), this, SLOT(purge()));
+
+  connect(UpdateManager::self(), SIGNAL(objectsUpdated(qint64)), this, SLOT(objectsUpdated()));
 }
 
 DataManager::~DataManager() {
@@ -100,6 +103,7 @@ DataManager::~DataManager() {
 
 void DataManager::showEvent(QShowEvent*)
 {
+  ensureShownUpdated();
   _session->header()->setResizeMode(QHeaderView::ResizeToContents);
   _session->header()->setStretchLastSection(false);
   QApplication::processEvents();
@@ -107,6 +111,32 @@ void DataManager::showEvent(QShowEvent*)
 }
 
 
+void DataManager::objectsUpdated() {
+  if (isVisible()) {
+    ensureShownUpdated();
+    _session->viewport()->update();
+  }
+}
+
+
+// Updates skip objects nothing on screen reads; what the list shows
+// is brought up to date while it is shown.
+void DataManager::ensureShownUpdated() {
+  SessionModel *model = static_cast<SessionModel*>(_doc->session());
+  foreach (const ObjectPtr &object, *model->objectList()) {
+    UpdateManager::self()->ensureUpdated(object);
+    if (DataObjectPtr dataObject = kst_cast<DataObject>(object)) {
+      foreach (const VectorPtr &v, dataObject->outputVectors()) {
+        UpdateManager::self()->ensureUpdated(v);
+      }
+      foreach (const MatrixPtr &m, dataObject->outputMatrices()) {
+        UpdateManager::self()->ensureUpdated(m);
+      }
+    }
+  }
+}
+
+
 void DataManager::showContextMenu(const QPoint &position) {
   QList<QAction *> actions;
   if (_session->indexAt(position).isValid()) {
@@ -79,8 +79,10 @@ class DataManager : public QDialog, Ui::DataManager
     QSortFilterProxyModel *_proxyModel;
 
     void showEvent(QShowEvent* event);
+    void ensureShownUpdated();
 
   private Q_SLOTS:
+    void objectsUpdated();
     void setFilterColumn(int index);
     void setCaseSensitivity(int state);
 
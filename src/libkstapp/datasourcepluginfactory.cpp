@@ -77,11 +77,15 @@ DataSourcePtr DataSourcePluginFactory::generateDataSource(ObjectStore *store, QX
   QString alternate_filename = fileName;
   do {
     dataSource = 0L;
-    dataSource = DataSourcePluginManager::loadSource(store, fileName, fileType);
+    bool parsed;
+    dataSource = DataSourcePluginManager::loadSource(store, fileName, fileType, propertyAttributes, &parsed);
     if (dataSource) {
       QObject::connect(dataSource, SIGNAL(progress(int,QString)), kstApp->mainWindow(), SLOT(updateProgress(int,QString)));
       dataSource->vector().prepareRead(0);
-      dataSource->parseProperties(propertyAttributes);
+      // sources opened ahead by Document::openDataSources() have them already
+      if (!parsed) {
+        dataSource->parseProperties(propertyAttributes);
+      }
       if (fileName != alternate_filename) {
         dataSource->setAlternateFilename(alternate_filename);
       }
@@ -17,14 +17,17 @@
 #include "logevents.h"
 #include "datasource.h"
 #include "datasourcepluginmanager.h"
+#include "trace.h"
 
 
 #include <QDebug>
+#include <QFileDialog>
+#include <QMessageBox>
 
 namespace Kst {
 
 DebugDialog::DebugDialog(QWidget *parent)
-  : QDialog(parent), _store(0) {
+  : QDialog(parent), _store(0), _errorCount(0) {
   setupUi(this);
 
   _log = new LogWidget(_logTab);
@@ -38,6 +41,10 @@ DebugDialog::DebugDialog(QWidget *parent)
   connect(_showNotice, SIGNAL(toggled(bool)), _log, SLOT(setShowNotice(bool)));
   connect(_showTrace, SIGNAL(toggled(bool)), _log, SLOT(setShowTrace(bool)));
 
+  connect(_recordProfile, SIGNAL(toggled(bool)), this, SLOT(setProfiling(bool)));
+  connect(_saveProfile, SIGNAL(clicked()), this, SLOT(saveProfile()));
+  connect(_clearProfile, SIGNAL(clicked()), this, SLOT(clearProfile()));
+
   if (!Debug::self()->kstRevision().isEmpty())
     _buildInfo->setText(tr("<h1>Kst</h1> Version %1 (%2)").arg(KSTVERSION).arg(Debug::self()->kstRevision()));
   else
@@ -55,9 +62,17 @@ bool DebugDialog::event(QEvent* e) {
     if (le) {
       switch (le->_eventType) {
         case LogEvent::LogAdded:
-          _log->logAdded(le->_msg);
-          if (le->_msg.level == Debug::Error) {
-            emit notifyOfError();
+          {
+            // messages are only formatted while they can be seen
+            Debug::self()->handlerNotified();
+            if (isVisible()) {
+              _log->showNewMessages();
+            }
+            const int errors = Debug::self()->errorCount();
+            if (errors != _errorCount) {
+              _errorCount = errors;
+              emit notifyOfError();
+            }
           }
           break;
         case LogEvent::LogCleared:
@@ -78,8 +93,31 @@ void DebugDialog::clear() {
 }
 
 
+void DebugDialog::setProfiling(bool on) {
+  Trace::setEnabled(on);
+}
+
+
+void DebugDialog::clearProfile() {
+  Trace::clear();
+}
+
+
+void DebugDialog::saveProfile() {
+  const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Profile"), "kst-profile.json",
+                                                        tr("Trace files (*.json)"));
+  if (fileName.isEmpty()) {
+    return;
+  }
+  if (!Trace::save(fileName)) {
+    QMessageBox::warning(this, tr("Kst"), tr("The profile could not be saved to %1.").arg(fileName));
+  }
+}
+
+
 void DebugDialog::show() {
   Q_ASSERT(_store);
+  _recordProfile->setChecked(Trace::isEnabled());
   _dataSources->clear();
   _dataSources->setColumnCount(2);
   const QStringList pl = DataSourcePluginManager::pluginList();
@@ -90,6 +128,7 @@ void DebugDialog::show() {
   }
 
   _dataSources->header()->resizeSections(QHeaderView::ResizeToContents);
+  _log->showNewMessages();
   QDialog::show();
 }
 
@@ -41,12 +41,18 @@ class DebugDialog : public QDialog, Ui::DebugDialog
     void clear();
     void show();
 
+  private Q_SLOTS:
+    void setProfiling(bool on);
+    void clearProfile();
+    void saveProfile();
+
   protected:
     bool event(QEvent *e);
 
   private:
     LogWidget *_log;
     ObjectStore *_store;
+    int _errorCount;
 };
 
 }
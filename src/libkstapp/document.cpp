@@ -23,11 +23,18 @@
 #include <viewitem.h>
 #include <commandlineparser.h>
 #include "objectstore.h"
+#include "dataprimitive.h"
+#include "datasidecar.h"
+#include "applicationsettings.h"
+#include "datasourcepluginmanager.h"
 #include "updatemanager.h"
 #include "updateserver.h"
 
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QStatusBar>
 #include <QDir>
 #include <QXmlStreamReader>
 
@@ -125,6 +132,11 @@ bool Document::save(const QString& to) {
 
   _fileName = file;
 
+  DataSidecar sidecar(QFileInfo(file).absoluteFilePath());
+  if (ApplicationSettings::self()->saveDataSeparately()) {
+    sidecar.beginSave();
+  }
+
   QXmlStreamWriter xml;
   xml.setDevice(&f);
   xml.setAutoFormatting(true);
@@ -182,6 +194,11 @@ bool Document::save(const QString& to) {
 
   xml.writeEndDocument();
 
+  if (!sidecar.finishSave()) {
+    _lastError = QObject::tr("The data file %1 could not be written.").arg(DataSidecar::fileName(file));
+    return false;
+  }
+
   setChanged(false);
   _isOpen = true; // Set _isOpen when saving into a new file so that kst does not ask for the filename again
   return true;
@@ -224,9 +241,73 @@ bool Document::initFromCommandLine(CommandLineParser *P) {
 
 
 #define malformed() \
+  DataSourcePluginManager::clearOpenedSources(); \
   return false;
 
 
+// Opens the data sources of the session on the thread pool, so that the
+// plugins' initial scans overlap; the <data> walk in open() then picks them
+// up in order.
+void Document::openDataSources(const QString& file) {
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QStringList fileNames, types;
+  QList<QXmlStreamAttributes> properties;
+  QXmlStreamReader xml(&f);
+  bool data = false;
+  bool source = false;
+  while (!xml.atEnd()) {
+    xml.readNext();
+    if (xml.isStartElement()) {
+      if (xml.name() == "data") {
+        data = true;
+      } else if (data && xml.name() == DataSource::staticTypeTag) {
+        QXmlStreamAttributes attrs = xml.attributes();
+        types << attrs.value("reader").toString();
+        if (objectStore()->override.fileName.isEmpty()) {
+          fileNames << DataPrimitive::readFilename(attrs);
+        } else {
+          fileNames << objectStore()->override.fileName;
+        }
+        properties << QXmlStreamAttributes();
+        source = true;
+      } else if (source && xml.name() == "properties") {
+        properties.last() = xml.attributes();
+      }
+    } else if (xml.isEndElement()) {
+      if (xml.name() == DataSource::staticTypeTag) {
+        source = false;
+      } else if (xml.name() == "data") {
+        // nothing else names sources
+        break;
+      }
+    }
+  }
+  if (fileNames.count() < 2) {
+    return;
+  }
+
+  // No event loop runs while waiting: timers and events would find the
+  // document half loaded.  The progress is painted directly instead.
+  QFuture<void> future = DataSourcePluginManager::openSources(objectStore(), fileNames, types, properties);
+  while (!future.isFinished()) {
+    if (_win) {
+      const int maximum = qMax(1, future.progressMaximum());
+      _win->updateProgress(100*future.progressValue()/maximum,
+                           QObject::tr("Opening data sources (%1 of %2)").arg(future.progressValue()).arg(maximum));
+      _win->statusBar()->repaint();
+    }
+    DataSourcePluginManager::waitForOpenedSource(100);
+  }
+  if (_win) {
+    _win->updateProgress(100, QString());
+  }
+}
+
+
 bool Document::open(const QString& file) {
   _isOpen = false;
   QFile f(file);
@@ -234,11 +315,16 @@ bool Document::open(const QString& file) {
     _lastError = QObject::tr("File could not be opened for reading.");
     return false;
   }
+  // vector and matrix data saved next to the session
+  DataSidecar sidecar(QFileInfo(file).absoluteFilePath());
+
   // Temporarily set the application dir to the current dir to be able to load data using the "fileRelative" attribute
   QString restorePath = QDir::currentPath();
   QDir::setCurrent(file.left(file.lastIndexOf('/')) + '/');
   _fileName = file;
 
+  openDataSources(file);
+
   // If we move this into the <graphics> block then we could, if desired, open
   // .kst files that contained only data and basically "merge" that data into
   // the current session
@@ -398,6 +484,7 @@ bool Document::open(const QString& file) {
 
   if (xml.hasError()) {
     _lastError = QObject::tr("File is malformed and encountered an error while reading.");
+    DataSourcePluginManager::clearOpenedSources();
     return false;
   }
 
@@ -413,6 +500,7 @@ bool Document::open(const QString& file) {
   _tnum = max_tnum+1;
   _mnum = max_mnum+1;
 
+  DataSourcePluginManager::clearOpenedSources();
 
   UpdateManager::self()->doUpdates(true);
   setChanged(false);
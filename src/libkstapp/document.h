@@ -56,6 +56,8 @@ class Document : public CoreDocument {
     void updateRecentDataFiles(const QStringList &datafiles);
 
   private:
+    void openDataSources(const QString& file);
+
     QPointer<MainWindow> _win;
     SessionModel *_session;
     bool _dirty;
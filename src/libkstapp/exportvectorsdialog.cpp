@@ -18,6 +18,7 @@
 #include "objectstore.h"
 #include "mainwindow.h"
 #include "document.h"
+#include "updatemanager.h"
 
 #include <QLineEdit>
 
@@ -223,6 +224,7 @@ bool ExportVectorsDialog::apply() {
   for (int i = 0; i<count; i++) {
     VectorPtr V = kst_cast<Vector>(_store->retrieveObject(_selectedVectorList->item(i)->text()));
     if (V) {
+      UpdateManager::self()->ensureUpdated(V);
       vectors.append(V);
       out << " " << V->descriptiveName();
       lengths << V->length();
@@ -25,6 +25,8 @@ GeneralTab::GeneralTab(QWidget *parent)
 
   connect(_useRaster, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
   connect(_maxUpdate, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_memoryBudget, SIGNAL(valueChanged(int)), this, SIGNAL(modified()));
+  connect(_saveDataSeparately, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
   connect(_transparentDrag, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
   connect(_antialiasPlots, SIGNAL(stateChanged(int)), this, SIGNAL(modified()));
 }
@@ -76,6 +78,26 @@ void GeneralTab::setMinimumUpdatePeriod(const int period) {
   _maxUpdate->setValue(period);
 }
 
+
+int GeneralTab::memoryBudget() const {
+  return _memoryBudget->value();
+}
+
+
+void GeneralTab::setMemoryBudget(const int megabytes) {
+  _memoryBudget->setValue(megabytes);
+}
+
+
+bool GeneralTab::saveDataSeparately() const {
+  return _saveDataSeparately->isChecked();
+}
+
+
+void GeneralTab::setSaveDataSeparately(bool separately) {
+  _saveDataSeparately->setChecked(separately);
+}
+
 }
 
 // vim: ts=2 sw=2 et
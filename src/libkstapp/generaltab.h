@@ -38,6 +38,12 @@ class GeneralTab : public DialogTab, Ui::GeneralTab {
     int minimumUpdatePeriod() const;
     void setMinimumUpdatePeriod(const int Period);
 
+    int memoryBudget() const;
+    void setMemoryBudget(const int megabytes);
+
+    bool saveDataSeparately() const;
+    void setSaveDataSeparately(bool separately);
+
 };
 
 }
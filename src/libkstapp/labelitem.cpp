@@ -92,9 +92,8 @@ void LabelItem::generateLabel(QPainter *p) {
     delete _labelRc;
   }
 
-  Label::Parsed *parsed = Label::parse(_text);
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(_text);
   if (parsed) {
-    parsed->chunk->attributes.color = _color;
     _dirty = false;
     QFont font(_font);
 
@@ -108,7 +107,7 @@ void LabelItem::generateLabel(QPainter *p) {
     font.setPointSizeF(view()->scaledFontSize(_scale, *p->device()));
 
     _labelRc = new Label::RenderContext(font, p);
-    Label::renderLabel(*_labelRc, parsed->chunk, true, false);
+    Label::renderLabel(*_labelRc, parsed->chunk, true, false, _color);
 
     _height = _labelRc->fontHeight();
     // Make sure we have a rect for selection, movement, etc
@@ -150,8 +149,6 @@ void LabelItem::generateLabel(QPainter *p) {
 
     connect(_labelRc, SIGNAL(labelDirty()), this, SLOT(setDirty()));
     connect(_labelRc, SIGNAL(labelDirty()), this, SLOT(triggerUpdate()));
-
-    delete parsed;
   }
 }
 
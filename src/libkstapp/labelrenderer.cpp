@@ -19,14 +19,15 @@
 
 #include "enodes.h"
 #include "datacollection.h"
-#include "ksttimers.h"
 #include "labelparser.h"
 #include "document.h"
 #include "objectstore.h"
+#include "trace.h"
 #include "application.h"
 #include "applicationsettings.h"
 
 #include <QDebug>
+#include <QHash>
 
 const double subscript_scale = 0.60;
 const double subscript_drop = 0.16;
@@ -35,7 +36,53 @@ const double superscript_raise = 0.44;
 
 namespace Label {
 
-void renderLabel(RenderContext& rc, Label::Chunk *fi, bool cache, bool draw) {
+// bounds the number of distinct texts measured before starting over
+static const int MaxCachedWidths = 20000;
+
+static QHash<QString, FontMetrics> fontMetricsCache;
+static QHash<QString, int> textWidthCache;
+
+FontMetrics fontMetrics(const QFont& font, QPaintDevice *device) {
+  QString key = font.key();
+  if (device) {
+    key += QString("@%1x%2").arg(device->logicalDpiX()).arg(device->logicalDpiY());
+  }
+
+  QHash<QString, FontMetrics>::ConstIterator it = fontMetricsCache.constFind(key);
+  if (it != fontMetricsCache.constEnd()) {
+    return it.value();
+  }
+
+  QFontMetrics fm = device ? QFontMetrics(font, device) : QFontMetrics(font);
+  FontMetrics metrics;
+  metrics.key = key;
+  metrics.ascent = fm.ascent();
+  metrics.descent = fm.descent();
+  metrics.height = fm.height();
+  metrics.lineSpacing = fm.lineSpacing();
+  fontMetricsCache.insert(key, metrics);
+  return metrics;
+}
+
+
+int textWidth(const QString& fontKey, const QFont& font, QPaintDevice *device, const QString& txt) {
+  const QString key = fontKey + QLatin1Char('\n') + txt;
+  QHash<QString, int>::ConstIterator it = textWidthCache.constFind(key);
+  if (it != textWidthCache.constEnd()) {
+    return it.value();
+  }
+
+  if (textWidthCache.count() >= MaxCachedWidths) {
+    textWidthCache.clear();
+  }
+  QFontMetrics fm = device ? QFontMetrics(font, device) : QFontMetrics(font);
+  const int width = fm.width(txt);
+  textWidthCache.insert(key, width);
+  return width;
+}
+
+
+void renderLabel(RenderContext& rc, const Label::Chunk *fi, bool cache, bool draw, const QColor& color) {
   // FIXME: RTL support
   int oldSize = rc.size = rc.fontSize();
   int oldY = rc.y;
@@ -43,7 +90,8 @@ void renderLabel(RenderContext& rc, Label::Chunk *fi, bool cache, bool draw) {
   bool boldFont = rc.font().bold();
   bool italicFont = rc.font().italic();
 
-  QColor default_color = fi->attributes.color;
+  const Label::Chunk *first = fi;
+  QColor default_color = color.isValid() ? color : fi->attributes.color;
 
   Kst::Document *doc = kstApp->mainWindow()->document();
   Q_ASSERT(doc);
@@ -74,8 +122,9 @@ void renderLabel(RenderContext& rc, Label::Chunk *fi, bool cache, bool draw) {
     f.setOverline(fi->attributes.overline);
 
     QPen pen = rc.pen;
-    if (fi->attributes.color.isValid()) {
-      pen.setColor(fi->attributes.color);
+    const QColor& chunk_color = (fi == first && color.isValid()) ? color : fi->attributes.color;
+    if (chunk_color.isValid()) {
+      pen.setColor(chunk_color);
     } else if (default_color.isValid()) {
       pen.setColor(default_color);
     }
@@ -185,15 +234,8 @@ void renderLabel(RenderContext& rc, Label::Chunk *fi, bool cache, bool draw) {
       rc.x += toSkip;
     } else {
       if (draw && rc.p) {
-#ifdef BENCHMARK
-        QTime t;
-        t.start();
-#endif
+        TRACE_SPAN_DETAIL("paint", "drawText", fi->text);
         rc.p->drawText(rc.x, rc.y, fi->text);
-
-#ifdef BENCHMARK
-        qDebug() << "Renderer did draw, time: " << t.elapsed();
-#endif
       }
       if (cache) {
         rc.addToCache(QPointF(rc.x, rc.y), fi->text, f, pen);
@@ -41,20 +41,29 @@ struct RenderedText {
   QPen pen;
 };
 
+// Font metrics and text widths are the same for every label using a font
+// on a device, so they are shared process wide.  GUI thread only.
+struct FontMetrics {
+  QString key;
+  int ascent, descent, height, lineSpacing;
+};
+FontMetrics fontMetrics(const QFont& font, QPaintDevice *device);
+int textWidth(const QString& fontKey, const QFont& font, QPaintDevice *device, const QString& txt);
+
 // inline for speed.
 class RenderContext : public QObject {
   Q_OBJECT
 
   public:
   RenderContext(const QFont& font, QPainter *p)
-  : QObject(), p(p), _fm(_font) {
+  : QObject(), p(p) {
     x = y = xMax = xStart = 0;
     precision = 8;
     setFont(font);
     lines = 0;
   }
 
-  inline void addToCache(QPointF location, QString &text, QFont &font, QPen &pen) {
+  inline void addToCache(QPointF location, const QString &text, const QFont &font, const QPen &pen) {
     RenderedText cacheEntry;
     cacheEntry.location = location;
     cacheEntry.text = text;
@@ -77,18 +86,15 @@ class RenderContext : public QObject {
 
     if (p) {
       p->setFont(f);
-      _ascent = p->fontMetrics().ascent();
-      _descent = p->fontMetrics().descent();
-      _height = p->fontMetrics().height();
-      _lineSpacing = p->fontMetrics().lineSpacing();
     } else {
       _font = f;
-      _fm = QFontMetrics(_font);
-      _ascent = _fm.ascent();
-      _lineSpacing = _fm.lineSpacing();
-      _descent = _fm.descent();
-      _height = _fm.height();
     }
+    const FontMetrics fm = fontMetrics(f, p ? p->device() : 0L);
+    _fontKey = fm.key;
+    _ascent = fm.ascent;
+    _lineSpacing = fm.lineSpacing;
+    _descent = fm.descent;
+    _height = fm.height;
   }
 
   inline void addObject(Kst::VectorPtr vp) {
@@ -127,11 +133,7 @@ class RenderContext : public QObject {
   }
 
   inline int fontWidth(const QString& txt) const {
-    if (p) {
-      return p->fontMetrics().width(txt);
-    } else {
-      return _fm.width(txt);
-    }
+    return textWidth(_fontKey, font(), p ? p->device() : 0L, txt);
   }
 
 
@@ -151,13 +153,14 @@ class RenderContext : public QObject {
 
   private:
     QFont _font;
-    QFontMetrics _fm;
+    QString _fontKey;
     int _ascent, _descent, _height, _lineSpacing; // caches to avoid performance problem with QFont*
     int _fontSize;
 };
 
 struct Chunk;
-void renderLabel(RenderContext& rc, Chunk *fi, bool cache, bool draw);
+// color, if valid, replaces the color of the first chunk
+void renderLabel(RenderContext& rc, const Chunk *fi, bool cache, bool draw, const QColor& color = QColor());
 void paintLabel(RenderContext& rc, QPainter *p);
 }
 
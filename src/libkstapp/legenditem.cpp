@@ -163,7 +163,7 @@ void LegendItem::paint(QPainter *painter) {
 
   QSize legendSize(0, 0);
   QSize titleSize(0,0);
-  Label::Parsed *parsed = Label::parse(_title);
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(_title);
   int pad = painter->fontMetrics().ascent()/4;
   Label::RenderContext rc(painter->font(), painter);
   Label::renderLabel(rc, parsed->chunk, false, false);
@@ -272,8 +272,7 @@ void LegendItem::paint(QPainter *painter) {
 
 
 QSize LegendItem::paintRelation(QString name, RelationPtr relation, QPainter *painter, bool draw) {
-  Label::Parsed *parsed = Label::parse(name);
-  parsed->chunk->attributes.color = _color;
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(name);
 
   int fontHeight = painter->fontMetrics().height();
   int fontAscent = painter->fontMetrics().ascent();
@@ -284,7 +283,7 @@ QSize LegendItem::paintRelation(QString name, RelationPtr relation, QPainter *pa
 
   if (relation->symbolLabelOnTop()) {
     Label::RenderContext tmprc(painter->font(), painter);
-    Label::renderLabel(tmprc, parsed->chunk, false, false);
+    Label::renderLabel(tmprc, parsed->chunk, false, false, _color);
     label_width = tmprc.x;
     painter->translate(paddingValue, fontHeight+paddingValue / 2);
     symbol_size.setWidth(qMax(label_width, symbol_size.width()));
@@ -308,10 +307,7 @@ QSize LegendItem::paintRelation(QString name, RelationPtr relation, QPainter *pa
     rc.y = (symbol_size.height()+painter->fontMetrics().boundingRect('M').height())/2;
   }
   if (parsed) {
-    Label::renderLabel(rc, parsed->chunk, false, draw);
-
-    delete parsed;
-    parsed = 0;
+    Label::renderLabel(rc, parsed->chunk, false, draw, _color);
   }
 
   double h = symbol_size.height() + paddingValue;
@@ -47,6 +47,7 @@ SOURCES += aboutdialog.cpp \
     axis.cpp \
     axistab.cpp \
     basicplugindialog.cpp \
+    batchexport.cpp \
     boxitem.cpp \
     bugreportwizard.cpp \
     builtingraphics.cpp \
@@ -164,6 +165,7 @@ HEADERS += aboutdialog.h \
     axis.h \
     axistab.h \
     basicplugindialog.h \
+    batchexport.h \
     boxitem.h \
     bugreportwizard.h \
     builtingraphics.h \
@@ -23,7 +23,7 @@ namespace Kst {
 
 
 LogWidget::LogWidget(QWidget *parent)
-  : QTextBrowser(parent) {
+  : QTextBrowser(parent), _shown(0) {
   _show = Debug::Warning | Debug::Error | Debug::Notice | Debug::Trace;
 }
 
@@ -59,6 +59,14 @@ void LogWidget::logAdded(const Debug::LogMessage& msg) {
 }
 
 
+void LogWidget::showNewMessages() {
+  const QList<Debug::LogMessage> messages = Debug::self()->messagesSince(_shown);
+  foreach(const Debug::LogMessage& message, messages) {
+    logAdded(message);
+  }
+}
+
+
 void LogWidget::setShowLevel(Debug::LogLevel level, bool show) {
   const int old = _show;
   if (show) {
@@ -94,10 +102,8 @@ void LogWidget::setShowTrace(bool show) {
 
 void LogWidget::regenerate() {
   clear();
-  const QList<Debug::LogMessage> messages = Debug::self()->messages();
-  foreach(const Debug::LogMessage& message, messages) {
-    logAdded(message);
-  }
+  _shown = 0;
+  showNewMessages();
 }
 
 }
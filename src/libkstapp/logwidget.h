@@ -29,6 +29,8 @@ class LogWidget : public QTextBrowser
 
   public Q_SLOTS:
     void logAdded(const Debug::LogMessage&);
+    // appends what was logged since the last call
+    void showNewMessages();
 
     void setShowError(bool show);
     void setShowWarning(bool show);
@@ -40,6 +42,7 @@ class LogWidget : public QTextBrowser
 
   private:
     int _show;
+    uint _shown; // sequence number of the next message to show
     void setShowLevel(Debug::LogLevel, bool show);
 };
 
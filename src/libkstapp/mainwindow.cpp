@@ -26,6 +26,7 @@
 #include "lineitem.h"
 #include "circleitem.h"
 #include "arrowitem.h"
+#include "memorybudget.h"
 #include "memorywidget.h"
 #include "objectstore.h"
 #include "pictureitem.h"
@@ -55,6 +56,7 @@
 #include "aboutdialog.h"
 #include "datavector.h"
 #include "commandlineparser.h"
+#include "batchexport.h"
 #include "dialogdefaults.h"
 #include "settings.h"
 
@@ -95,6 +97,8 @@ MainWindow::MainWindow() :
     _aboutDialog(0),
     _viewVectorDialog(0),
     _highlightPoint(false),
+    _allViewsShown(false),
+    _commandLineExitCode(0),
     _statusBarTimeout(0)
 #if defined(__QNX__)
   , _qnxToolbarsVisible(true)
@@ -155,6 +159,7 @@ MainWindow::~MainWindow() {
 void MainWindow::performHeavyStartupActions() {
   // Set the timer for the UpdateManager.
   UpdateManager::self()->setMinimumUpdatePeriod(ApplicationSettings::self()->minimumUpdatePeriod());
+  MemoryBudget::self()->setBudget(qint64(ApplicationSettings::self()->memoryBudget()) * 1024 * 1024);
   DataObject::init();
   DataSourcePluginManager::init();
 }
@@ -440,6 +445,20 @@ bool MainWindow::initFromCommandLine() {
     exportGraphicsFile(P.pngFile(), "png", 1280, 1024,0);
     ok = false;
   }
+  if (!P.exportFile().isEmpty()) {
+    BatchExport exporter(this, _doc);
+    exporter.setFileName(P.exportFile());
+    exporter.setSize(P.exportSize());
+    if (P.exportFrameStep() > 0) {
+      exporter.setFrameRange(P.exportFirstFrame(), P.exportLastFrame(), P.exportFrameStep());
+    } else if (P.exportTimeStep() > 0.0) {
+      exporter.setTimeRange(P.exportFirstTime(), P.exportLastTime(), P.exportTimeStep());
+    }
+    if (!exporter.exec()) {
+      _commandLineExitCode = 1;
+    }
+    ok = false;
+  }
   if (!P.printFile().isEmpty()) {
 #ifndef KST_NO_PRINTER
     printFromCommandLine(P.printFile());
@@ -473,6 +492,11 @@ void MainWindow::openFile(const QString &file) {
 
 
 void MainWindow::exportGraphicsFile(const QString &filename, const QString &format, int width, int height, int display) {
+  const bool showAll = !_allViewsShown;
+  if (showAll) {
+    setAllViewsShown(true);
+  }
+
   int viewCount = 0;
   int n_views = _tabWidget->views().size();
   for (int i_view = 0; i_view<n_views; i_view++) {
@@ -578,6 +602,10 @@ void MainWindow::exportGraphicsFile(const QString &filename, const QString &form
     }
     viewCount++;
   }
+
+  if (showAll) {
+    setAllViewsShown(false);
+  }
 }
 
 void MainWindow::exportLog(const QString &imagename, QString &msgfilename, const QString &format, int x_size, int y_size,
@@ -652,6 +680,11 @@ void MainWindow::printToPrinter(QPrinter *printer) {
     break;
   }
 
+  const bool showAll = !_allViewsShown;
+  if (showAll) {
+    setAllViewsShown(true);
+  }
+
   QSize printerPageSize = printer->pageRect().size();
   for (int i = 0; i < printer->numCopies(); ++i) {
     for (int i_page = 0; i_page<pages.count(); i_page++) {
@@ -669,6 +702,10 @@ void MainWindow::printToPrinter(QPrinter *printer) {
 
     }
   }
+
+  if (showAll) {
+    setAllViewsShown(false);
+  }
 }
 
 void MainWindow::printFromCommandLine(const QString &printFileName) {
@@ -743,6 +780,11 @@ void MainWindow::currentViewChanged() {
     return;
   _undoGroup->setActiveStack(_tabWidget->currentView()->undoStack());
   currentViewModeChanged();
+
+  // what the new tab shows may have been left behind while it was hidden
+  if (updateDemand()) {
+    updateViewItems(UpdateManager::self()->serial());
+  }
 }
 
 
@@ -1752,7 +1794,44 @@ void MainWindow::showDataManager() {
 }
 
 
+/*
+ * Tells the update manager what is on screen, so that updates can skip
+ * what only plots on other tabs, or hidden plots, read.  Returns true if
+ * anything shown had to be brought up to date.
+ */
+bool MainWindow::updateDemand() {
+  QList<Object*> shown, hidden;
+  View *current = _tabWidget->currentView();
+
+  foreach (PlotItem *plot, ViewItem::getItems<PlotItem>(true)) {
+    const bool visible = _allViewsShown || (plot->view() == current && plot->isVisible());
+    foreach (const RelationPtr &relation, plot->relationList()) {
+      (visible ? shown : hidden).append(relation.data());
+    }
+  }
+  foreach (LabelItem *label, ViewItem::getItems<LabelItem>(true)) {
+    if (label->_labelRc) {
+      const bool visible = _allViewsShown || (label->view() == current && label->isVisible());
+      foreach (Primitive *primitive, label->_labelRc->_refObjects) {
+        (visible ? shown : hidden).append(primitive);
+      }
+    }
+  }
+
+  return UpdateManager::self()->setDemand(shown, hidden);
+}
+
+
+void MainWindow::setAllViewsShown(bool shown) {
+  _allViewsShown = shown;
+  if (updateDemand()) {
+    updateViewItems(UpdateManager::self()->serial());
+  }
+}
+
+
 void MainWindow::updateViewItems(qint64 serial) {
+  updateDemand();
 
   QList<PlotItem *> plots = ViewItem::getItems<PlotItem>();
 
@@ -62,6 +62,8 @@ class MainWindow : public QMainWindow
     Document *document() const;
     QProgressBar *progressBar() const;
     bool initFromCommandLine();
+    // what kst exits with when initFromCommandLine() did not show the window
+    int commandLineExitCode() const { return _commandLineExitCode; }
     bool isHighlightPoint() { return _highlightPoint; }
     bool isTiedTabs();
     void setStatusMessage(QString message, int timeout=0, bool delayed = false);
@@ -100,6 +102,9 @@ class MainWindow : public QMainWindow
     void reload();
 
     void updateViewItems(qint64 serial);
+    // while set, what plots on every tab read is kept up to date, not just
+    // the current tab; for printing and exporting all of them
+    void setAllViewsShown(bool shown);
     void updateProgress(int percent, const QString& message);
 
     void save();
@@ -182,6 +187,7 @@ class MainWindow : public QMainWindow
     void readSettings();
     void writeSettings();
     bool promptSaveDone();
+    bool updateDemand();
 
     QAction* createRecentFileAction(const QString& filename, int idx, const QString& text, const char* openslot);
     void updateRecentFiles(const QString& key, QMenu *menu, QList<QAction*>& actions, QMenu* submenu, const QString& newfilename, const char* openslot);
@@ -220,6 +226,8 @@ class MainWindow : public QMainWindow
     QLabel *_messageLabel;
 
     bool _highlightPoint;
+    bool _allViewsShown;
+    int _commandLineExitCode;
 
     QMenu *_fileMenu;
     QMenu *_editMenu;
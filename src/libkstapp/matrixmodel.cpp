@@ -11,6 +11,7 @@
  ***************************************************************************/
 
 #include "matrixmodel.h"
+#include "updatemanager.h"
 
 #include <assert.h>
 
@@ -18,9 +19,17 @@
 
 namespace Kst {
 
+// cells formatted at a time, around the one asked for; more than a view shows
+static const int TileRows = 256;
+static const int TileColumns = 64;
+
 MatrixModel::MatrixModel(MatrixPtr m)
 : QAbstractItemModel(), _m(m) {
   assert(m.data());
+  // updates may have skipped it while nothing showed it
+  UpdateManager::self()->ensureUpdated(_m);
+  _rows = _m->yNumSteps();
+  _columns = _m->xNumSteps();
 }
 
 
@@ -30,13 +39,32 @@ MatrixModel::~MatrixModel() {
 
 int MatrixModel::columnCount(const QModelIndex& parent) const {
   Q_UNUSED(parent)
-  return _m->xNumSteps();
+  return _columns;
 }
 
 
 int MatrixModel::rowCount(const QModelIndex& parent) const {
   Q_UNUSED(parent)
-  return _m->yNumSteps();
+  return _rows;
+}
+
+
+void MatrixModel::fillTile(int row, int column) const {
+  _m->readLock();
+  _tile.row = qMax(0, row - TileRows/2);
+  _tile.column = qMax(0, column - TileColumns/2);
+  _tile.rows = qMax(0, qMin(_m->yNumSteps(), _tile.row + TileRows) - _tile.row);
+  _tile.columns = qMax(0, qMin(_m->xNumSteps(), _tile.column + TileColumns) - _tile.column);
+  _tile.text.resize(_tile.rows*_tile.columns);
+  for (int x = 0; x < _tile.columns; ++x) {
+    for (int y = 0; y < _tile.rows; ++y) {
+      bool ok;
+      const double z = _m->valueRaw(_tile.column + x, _tile.row + y, &ok);
+      _tile.text[x*_tile.rows + y] = ok ? QString::number(z, 'g', 6) : QString();
+    }
+  }
+  _tile.serial = _m->serialOfLastChange();
+  _m->unlock();
 }
 
 
@@ -46,7 +74,19 @@ QVariant MatrixModel::data(const QModelIndex& index, int role) const {
   if (index.isValid()) {
     switch (role) {
       case Qt::DisplayRole:
-        rc = QVariant(_m->value(index.column(), index.row()));
+        {
+          // formatted a tile at a time, so only cells near those shown are
+          int y = index.row() - _tile.row;
+          int x = index.column() - _tile.column;
+          if (y < 0 || y >= _tile.rows || x < 0 || x >= _tile.columns || _tile.serial != _m->serialOfLastChange()) {
+            fillTile(index.row(), index.column());
+            y = index.row() - _tile.row;
+            x = index.column() - _tile.column;
+          }
+          if (y < _tile.rows && x < _tile.columns) {
+            rc = QVariant(_tile.text.at(x*_tile.rows + y));
+          }
+        }
         break;
       case Qt::FontRole:
         {
@@ -67,7 +107,7 @@ QVariant MatrixModel::data(const QModelIndex& index, int role) const {
 
 QModelIndex MatrixModel::index(int row, int col, const QModelIndex& parent) const {
   Q_UNUSED(parent)
-  if (row >= 0 && row < _m->yNumSteps() && col >= 0 && col < _m->xNumSteps()) {
+  if (row >= 0 && row < _rows && col >= 0 && col < _columns) {
     return createIndex(row, col);
   }
   return QModelIndex();
@@ -91,7 +131,7 @@ Qt::ItemFlags MatrixModel::flags(const QModelIndex& index) const {
     return f;
   }
 
-  if (_m->editable() && index.row() >= 0 && index.row() < _m->yNumSteps() && index.column() >= 0 && index.column() < _m->xNumSteps()) {
+  if (_m->editable() && index.row() >= 0 && index.row() < _rows && index.column() >= 0 && index.column() < _columns) {
     f |= Qt::ItemIsEditable;
   }
 
@@ -114,7 +154,37 @@ bool MatrixModel::setData(const QModelIndex& index, const QVariant& value, int r
     return false;
   }
 
-  return _m->setValue(index.column(), index.row(), v);
+  // cells, as shown, not coordinates
+  if (!_m->setValueRaw(index.column(), index.row(), v)) {
+    return false;
+  }
+  _tile.text.clear();
+  _tile.rows = _tile.columns = 0;
+  emit dataChanged(index, index);
+  return true;
+}
+
+
+void MatrixModel::resetIfChanged() {
+  UpdateManager::self()->ensureUpdated(_m);
+  if (_m->yNumSteps() != _rows || _m->xNumSteps() != _columns) {
+    beginResetModel();
+    _rows = _m->yNumSteps();
+    _columns = _m->xNumSteps();
+    _tile = Tile();
+    endResetModel();
+    return;
+  }
+
+  // format again what the view shows, when it asks
+  const int lastRow = qMin(_rows, _tile.row + _tile.rows) - 1;
+  const int lastColumn = qMin(_columns, _tile.column + _tile.columns) - 1;
+  const QModelIndex first = index(_tile.row, _tile.column);
+  const QModelIndex last = index(lastRow, lastColumn);
+  _tile = Tile();
+  if (first.isValid() && last.isValid()) {
+    emit dataChanged(first, last);
+  }
 }
 
 
@@ -14,6 +14,7 @@
 #define MATRIXMODEL_H
 
 #include <QAbstractItemModel>
+#include <QVector>
 #include <matrix.h>
 
 namespace Kst {
@@ -33,8 +34,23 @@ public:
   Qt::ItemFlags flags(const QModelIndex& index) const;
   bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
 
+  // After an update: resets the model if the matrix changed size, and
+  // otherwise formats again only the cells which were shown.
+  void resetIfChanged();
+
 private:
+  // Formatted values of a block of cells around the ones the view asks for.
+  struct Tile {
+    Tile() : row(0), column(0), rows(0), columns(0), serial(Object::NoInputs) {}
+    int row, column, rows, columns;
+    qint64 serial;
+    QVector<QString> text;
+  };
+  void fillTile(int row, int column) const;
+
   MatrixPtr _m;
+  int _rows, _columns;
+  mutable Tile _tile;
 };
 
 }
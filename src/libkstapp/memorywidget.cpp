@@ -17,6 +17,8 @@
 #include <psversion.h>
 #include <sysinfo.h>
 
+#include "memorybudget.h"
+
 namespace Kst {
 
 MemoryWidget::MemoryWidget(QWidget *parent, int updateMilliSeconds)
@@ -31,12 +33,46 @@ MemoryWidget::~MemoryWidget() {
 }
 
 
+static bool usageGreaterThan(const MemoryBudget::Usage& a, const MemoryBudget::Usage& b) {
+  return a.bytes > b.bytes;
+}
+
+
 void MemoryWidget::updateFreeMemory() {
+  const qint64 MB = 1024 * 1024;
+  MemoryBudget *memory = MemoryBudget::self();
+  QString used;
+  if (memory->budget() > 0) {
+    used = tr("%1 of %2 MB used").arg(memory->heapBytes() / MB).arg(memory->budget() / MB);
+  } else {
+    used = tr("%1 MB used").arg(memory->heapBytes() / MB);
+  }
+  if (memory->mappedBytes() > 0) {
+    used += tr(", %1 MB mapped").arg(memory->mappedBytes() / MB);
+  }
 #ifdef __linux__
   meminfo();
   unsigned long mi = S(kb_main_free + kb_main_cached);
-  setText(tr("%1 MB available").arg(mi / (1024 * 1024)));
+  setText(tr("%1 MB available").arg(mi / (1024 * 1024)) + " (" + used + ')');
+#else
+  setText(used);
 #endif
+
+  // the largest objects in the tooltip
+  QList<MemoryBudget::Usage> usage = memory->usage();
+  qSort(usage.begin(), usage.end(), usageGreaterThan);
+  QString tip;
+  for (int i = 0; i < usage.count() && i < 20 && usage[i].bytes >= MB; ++i) {
+    if (usage[i].name.isEmpty()) {
+      continue;
+    }
+    if (!tip.isEmpty()) {
+      tip += '\n';
+    }
+    const QString line = usage[i].mapped ? tr("%1: %2 MB (mapped)") : tr("%1: %2 MB");
+    tip += line.arg(usage[i].name).arg(usage[i].bytes / MB);
+  }
+  setToolTip(tip);
 }
 
 }
@@ -35,6 +35,7 @@
 #include "sharedaxisboxitem.h"
 
 #include "applicationsettings.h"
+#include "trace.h"
 #include "updatemanager.h"
 
 #include "math_kst.h"
@@ -46,10 +47,6 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QClipboard>
 
-// Benchmark drawing
-// undefined = None, 1 = PlotItem, 2 = More Details
-//#define BENCHMARK 1
-
 static const int PLOT_MAXIMIZED_ZORDER = 1000;
 
 namespace Kst {
@@ -883,10 +880,7 @@ void PlotItem::calculateBorders(QPainter *painter) {
 
 
 void PlotItem::updatePlotPixmap() {
-#if BENCHMARK
-  QTime bench_time;
-  bench_time.start();
-#endif
+  TRACE_SPAN_DETAIL("paint", "PlotItem::updatePlotPixmap", Name());
 
   _plotPixmapDirty = false;
   if (maskedByMaximization()) {
@@ -907,10 +901,6 @@ void PlotItem::updatePlotPixmap() {
   pixmapPainter.restore();
   
   _plotPixmap = pixmap;
-#if BENCHMARK
-  int i = bench_time.elapsed();
-  qDebug() << "Total Time to update plot pixmap " << (void *)this << ": " << i << "ms";
-#endif
 }
 
 
@@ -919,10 +909,7 @@ void PlotItem::paint(QPainter *painter) {
     return;
   }
 
-#if BENCHMARK
-  QTime bench_time;
-  bench_time.start();
-#endif
+  TRACE_SPAN_DETAIL("paint", "PlotItem::paint", Name());
   if (view()->isPrinting()) {
     paintPixmap(painter);
   } else {
@@ -942,10 +929,6 @@ void PlotItem::paint(QPainter *painter) {
       painter->restore();
     }
   }
-#if BENCHMARK
-  int i = bench_time.elapsed();
-  qDebug() << "Total Time to paint " << (void *)this << ": " << i << "ms" << endl;
-#endif
 }
 
 
@@ -986,6 +969,7 @@ void PlotItem::paintPixmap(QPainter *painter) {
 
 
 void PlotItem::paintPlot(QPainter *painter, bool xUpdated, bool yUpdated) {
+  TRACE_SPAN("paint", "PlotItem::paintPlot");
   if (xUpdated) {
     xAxis()->validateDrawingRegion(painter);
     updateXAxisLines();
@@ -1012,49 +996,18 @@ void PlotItem::paintPlot(QPainter *painter, bool xUpdated, bool yUpdated) {
       updateYAxisLabels(painter);
     }
   }
-#if BENCHMARK > 1
-  QTime bench_time, benchtmp;
-  int b_1 = 0, b_2 = 0, b_3 = 0, b_4 = 0, b_5 = 0;
-  bench_time.start();
-  benchtmp.start();
-#endif
   paintMajorGridLines(painter);
-#if BENCHMARK > 1
-    b_1 = benchtmp.elapsed();
-#endif
   paintMinorGridLines(painter);
-#if BENCHMARK > 1
-    b_2 = benchtmp.elapsed();
-#endif
   painter->save();
   painter->setBrush(Qt::NoBrush);
   painter->setPen(pen());
   QRectF box(plotRect());
   box.adjust(-1.0, -1.0, 0.0, 0.0);
   painter->drawRect(box);
-#if BENCHMARK > 1
-    b_3 = benchtmp.elapsed();
-#endif
 
   paintMajorTicks(painter);
-#if BENCHMARK > 1
-    b_4 = benchtmp.elapsed();
-#endif
   paintMinorTicks(painter);
-#if BENCHMARK > 1
-    b_5 = benchtmp.elapsed();
-#endif
   painter->restore();
-
-#if BENCHMARK > 1
-  int i = bench_time.elapsed();
-  qDebug() << "Painting Plot - PaintPlot " << (void *)this << ": " << i << "ms";
-  if (b_1 > 0)       qDebug() << "            Major Lines: " << b_1 << "ms";
-  if (b_2 - b_1 > 0) qDebug() << "            Minor Lines: " << (b_2 - b_1) << "ms";
-  if (b_3 - b_2 > 0) qDebug() << "                   Rect: " << (b_3 - b_2) << "ms";
-  if (b_4 - b_3 > 0) qDebug() << "            Major Ticks: " << (b_4 - b_3) << "ms";
-  if (b_5 - b_4 > 0) qDebug() << "            Minor Ticks: " << (b_5 - b_4) << "ms";
-#endif
 }
 
 
@@ -2199,17 +2152,15 @@ void PlotItem::generateLeftLabel(QPainter *p) {
   }
   _leftLabel.valid = false;
   _leftLabel.dirty = false;
-  Label::Parsed *parsed = Label::parse(leftLabel());
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(leftLabel());
   if (parsed) {
-    parsed->chunk->attributes.color = _leftLabelDetails->fontColor();
-
     if (_leftLabel.rc) {
       delete _leftLabel.rc;
     }
 
     Label::RenderContext *rc = new Label::RenderContext(leftLabelDetails()->calculatedFont(*p->device()), p);
     rc->y = rc->fontAscent();
-    Label::renderLabel(*rc, parsed->chunk, true, false);
+    Label::renderLabel(*rc, parsed->chunk, true, false, _leftLabelDetails->fontColor());
 
     QTransform t;
     t.translate(rect().left(),plotRect().center().y() + rc->x/2);
@@ -2221,8 +2172,6 @@ void PlotItem::generateLeftLabel(QPainter *p) {
     _leftLabel.rc = rc;
     _leftLabel.transform = t;
     _leftLabel.valid = true;
-
-    delete parsed;
   }
 }
 
@@ -2273,17 +2222,15 @@ void PlotItem::generateBottomLabel(QPainter *p) {
 
   _bottomLabel.valid = false;
   _bottomLabel.dirty = false;
-  Label::Parsed *parsed = Label::parse(bottomLabel());
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(bottomLabel());
   if (parsed) {
-    parsed->chunk->attributes.color = _bottomLabelDetails->fontColor();
-
     if (_bottomLabel.rc) {
       delete _bottomLabel.rc;
     }
 
     Label::RenderContext *rc = new Label::RenderContext(bottomLabelDetails()->calculatedFont(*p->device()), p);
     rc->y = rc->fontAscent();
-    Label::renderLabel(*rc, parsed->chunk, true, false);
+    Label::renderLabel(*rc, parsed->chunk, true, false, _bottomLabelDetails->fontColor());
 
     QTransform t;
     t.translate(plotRect().center().x() - rc->x / 2, plotAxisRect().bottom());
@@ -2294,8 +2241,6 @@ void PlotItem::generateBottomLabel(QPainter *p) {
     _bottomLabel.rc = rc;
     _bottomLabel.transform = t;
     _bottomLabel.valid = true;
-
-    delete parsed;
   }
 }
 
@@ -2343,17 +2288,15 @@ void PlotItem::generateRightLabel(QPainter *p) {
   }
   _rightLabel.valid = false;
   _rightLabel.dirty = false;
-  Label::Parsed *parsed = Label::parse(rightLabel());
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(rightLabel());
   if (parsed && rightLabelRect().isValid()) {
-    parsed->chunk->attributes.color = _rightLabelDetails->fontColor();
-
-    if (_rightLabel.parsed) {
-      delete _rightLabel.parsed;
+    if (_rightLabel.rc) {
+      delete _rightLabel.rc;
     }
 
     Label::RenderContext *rc = new Label::RenderContext(rightLabelDetails()->calculatedFont(*p->device()), p);
     rc->y = rc->fontAscent();
-    Label::renderLabel(*rc, parsed->chunk, true, false);
+    Label::renderLabel(*rc, parsed->chunk, true, false, _rightLabelDetails->fontColor());
 
     QTransform t;
     t.translate(rect().right(), plotRect().center().y() - rc->x/2);
@@ -2366,8 +2309,6 @@ void PlotItem::generateRightLabel(QPainter *p) {
     _rightLabel.rc = rc;
     _rightLabel.transform = t;
     _rightLabel.valid = true;
-
-    delete parsed;
   }
 }
 
@@ -2418,17 +2359,15 @@ void PlotItem::generateTopLabel(QPainter *p) {
   }
   _topLabel.valid = false;
   _topLabel.dirty = false;
-  Label::Parsed *parsed = Label::parse(topLabel());
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached(topLabel());
   if (parsed && topLabelRect().isValid()) {
-    parsed->chunk->attributes.color = _topLabelDetails->fontColor();
-
     if (_topLabel.rc) {
       delete _topLabel.rc;
     }
 
     Label::RenderContext *rc = new Label::RenderContext(topLabelDetails()->calculatedFont(*p->device()), p);
     rc->y = rc->fontAscent();
-    Label::renderLabel(*rc, parsed->chunk, true, false);
+    Label::renderLabel(*rc, parsed->chunk, true, false, _topLabelDetails->fontColor());
 
     QTransform t;
     if (_topLabelDetails->isVisible()) {
@@ -2442,8 +2381,6 @@ void PlotItem::generateTopLabel(QPainter *p) {
     _topLabel.rc = rc;
     _topLabel.transform = t;
     _topLabel.valid = true;
-
-    delete parsed;
     }
 }
 
@@ -47,12 +47,11 @@ struct ZoomState {
 
 
 struct CachedLabel {
-  CachedLabel() { valid = false; dirty = true; parsed = 0; rc = 0; };
-  ~CachedLabel() { delete parsed; delete rc; };
+  CachedLabel() { valid = false; dirty = true; rc = 0; };
+  ~CachedLabel() { delete rc; };
 
   bool valid;
   bool dirty;
-  Label::Parsed *parsed;
   Label::RenderContext *rc;
   QTransform transform;
 };
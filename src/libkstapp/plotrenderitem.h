@@ -26,6 +26,12 @@ namespace Kst {
 class PlotItem;
 class PlotRenderItem;
 
+// A relation and the context it is about to be painted with
+struct RelationRenderJob {
+  RelationPtr relation;
+  CurveRenderContext context;
+};
+
 class PlotRenderItem : public ViewItem
 {
   Q_OBJECT
@@ -54,6 +60,9 @@ class PlotRenderItem : public ViewItem
     virtual void saveInPlot(QXmlStreamWriter &xml);
     virtual void paint(QPainter *painter);
     virtual void paintRelations(QPainter *painter) = 0;
+    // Queue the relations paintRelations() will draw into a view of the given
+    // window, so their paint objects can be built ahead of time.
+    virtual void prepareRelations(const QRect &window, QList<RelationRenderJob> &jobs) { Q_UNUSED(window); Q_UNUSED(jobs); }
     void paintReferencePoint(QPainter *painter);
     void paintHighlightPoint(QPainter *painter);
 
@@ -529,6 +529,7 @@ QByteArray ScriptServer::checkPrimatives(QByteArray &command, QLocalSocket *s)
             ObjectPtr o=_store->retrieveObject(b);
             DataVectorPtr v=kst_cast<DataVector>(o);
             if(v) {
+                UpdateManager::self()->ensureUpdated(v);
                 return handleResponse(v->scriptInterface(m),s,0,"",0,0);
             } else {
                 return handleResponse("No such object",s,0,"",0,0);
@@ -550,6 +551,7 @@ QByteArray ScriptServer::checkPrimatives(QByteArray &command, QLocalSocket *s)
             ObjectPtr o=_store->retrieveObject(b);
             VectorPtr v=kst_cast<Vector>(o);
             if(v) {
+                UpdateManager::self()->ensureUpdated(v);
                 return handleResponse(v->scriptInterface(m),s,0,"",0,0);
             } else {
                 return handleResponse("No such object",s,0,"",0,0);
@@ -571,6 +573,7 @@ QByteArray ScriptServer::checkPrimatives(QByteArray &command, QLocalSocket *s)
           ObjectPtr o=_store->retrieveObject(b);
           DataObjectPtr x=kst_cast<DataObject>(o);
           if (x) {
+              UpdateManager::self()->ensureUpdated(x);
               return handleResponse(x->scriptInterface(m),s,0,"",0,0);
           } else {
               return handleResponse("No such object",s,0,"",0,0);
@@ -1511,6 +1514,7 @@ QByteArray ScriptServer::vectorGetBinaryArray(QByteArray&command, QLocalSocket*
         s->waitForBytesWritten(-1);
         return "No object";
     }
+    UpdateManager::self()->ensureUpdated(v);
     QByteArray x=v->getBinaryArray();
     const char* d=x.data();
     int pos=-8;
@@ -1544,6 +1548,7 @@ QByteArray ScriptServer::matrixGetBinaryArray(QByteArray&command, QLocalSocket*
         s->waitForBytesWritten(-1);
         return "No object";
     }
+    UpdateManager::self()->ensureUpdated(m);
     QByteArray x=m->getBinaryArray();
     const char* d=x.data();
     int pos=-8;
@@ -1565,6 +1570,7 @@ QByteArray ScriptServer::stringValue(QByteArray&command, QLocalSocket* s,ObjectS
     ObjectPtr o=_store->retrieveObject(command);
     StringPtr str=kst_cast<String>(o);
     if(str) {
+        UpdateManager::self()->ensureUpdated(str);
         return handleResponse(str->value().toLatin1(),s,0,"",0,0);
     } else {
         return handleResponse("No such object (variables not supported)",s,0,"",0,0);;
@@ -1603,6 +1609,7 @@ QByteArray ScriptServer::scalarValue(QByteArray&command, QLocalSocket* s,ObjectS
     ObjectPtr o=_store->retrieveObject(command);
     ScalarPtr sca=kst_cast<Scalar>(o);
     if(sca) {
+        UpdateManager::self()->ensureUpdated(sca);
         return handleResponse(QByteArray::number(sca->value()),s,0,"",0,0);
     } else {
         return handleResponse("No such object (variables not supported)",s,0,"",0,0);;
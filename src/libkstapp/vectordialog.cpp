@@ -67,6 +67,13 @@ VectorTab::VectorTab(ObjectStore *store, QWidget *parent)
   updateUpdateBox();
   connect(_updateBox, SIGNAL(currentIndexChanged(int)), this, SLOT(updateTypeActivated(int)));
   connect(_updateBox, SIGNAL(currentIndexChanged(int)), this, SIGNAL(modified()));
+
+  // in the order of DataVector::StorageType
+  _storageBox->addItem(tr("double", "storage type"));
+  _storageBox->addItem(tr("float32", "storage type"));
+  _storageBox->addItem(tr("int16", "storage type"));
+  _storageBox->addItem(tr("int32", "storage type"));
+  connect(_storageBox, SIGNAL(currentIndexChanged(int)), this, SIGNAL(modified()));
 }
 
 
@@ -151,6 +158,16 @@ void VectorTab::setField(const QString &field) {
 }
 
 
+Kst::DataVector::StorageType VectorTab::storage() const {
+  return Kst::DataVector::StorageType(qMax(0, _storageBox->currentIndex()));
+}
+
+
+void VectorTab::setStorage(Kst::DataVector::StorageType storage) {
+  _storageBox->setCurrentIndex(int(storage));
+}
+
+
 void VectorTab::setFieldList(const QStringList &fieldList) {
   _field->clear();
   _field->addItems(fieldList);
@@ -386,6 +403,7 @@ void VectorDialog::configureTab(ObjectPtr vector) {
     _vectorTab->setDataSource(dataVector->dataSource());
     _vectorTab->updateIndexList(dataVector->dataSource());
     _vectorTab->setField(dataVector->field());
+    _vectorTab->setStorage(dataVector->storageType());
 
     _vectorTab->dataRange()->setRangeUnits(dataVector->rangeUnits());
     if ( _vectorTab->dataRange()->rangeUnitsIndex()>0) {
@@ -499,6 +517,7 @@ ObjectPtr VectorDialog::createNewDataVector() {
 
   vector->setRangeUnits(dataRange->rangeUnits());
   vector->setStartUnits(dataRange->startUnits());
+  vector->setStorage(_vectorTab->storage());
 
   if (DataDialog::tagStringAuto()) {
      vector->setDescriptiveName(QString());
@@ -600,6 +619,7 @@ ObjectPtr VectorDialog::editExistingDataObject() const {
         dataRange->skip(),
         dataRange->doSkip(),
         dataRange->doFilter());
+      dataVector->setStorage(_vectorTab->storage(), dataVector->storageScale(), dataVector->storageOffset());
 
       if (DataDialog::tagStringAuto()) {
         dataVector->setDescriptiveName(QString());
@@ -23,6 +23,7 @@
 #include "kst_export.h"
 
 #include "datasource.h"
+#include "datavector.h"
 
 namespace Kst {
 
@@ -55,6 +56,10 @@ class VectorTab : public DataTab, Ui::VectorTab {
 
     DataRange *dataRange() const;
 
+    // the vector mode shadows the class here
+    Kst::DataVector::StorageType storage() const;
+    void setStorage(Kst::DataVector::StorageType storage);
+
     //GeneratedVector methods...
     qreal from() const;
     void setFrom(qreal from);
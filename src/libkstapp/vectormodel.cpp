@@ -11,14 +11,23 @@
  ***************************************************************************/
 
 #include "vectormodel.h"
+#include "updatemanager.h"
 
 #include <assert.h>
 
 #include <QFont>
 #include <QMenu>
 
+#include <math.h>
+
 namespace Kst {
 
+// rows formatted at a time, around the one asked for; more than a view shows
+static const int WindowRows = 1024;
+// samples in a block, and blocks in a group, of a Summary
+static const int BlockSamples = 256;
+static const int GroupBlocks = 64;
+
 VectorModel::VectorModel()
   : QAbstractTableModel (), _rows(0) {
 }
@@ -31,13 +40,16 @@ bool VectorModel::addVector(VectorPtr v)
 {
   assert(v);
   if (!_vectorList.contains(v)) {
+    // updates may have skipped it while nothing showed it
+    UpdateManager::self()->ensureUpdated(v);
     beginInsertColumns(QModelIndex(), columnCount(), columnCount());
     _vectorList.append(v);
     // Standard nb of digits after comma: 6
     _digitNbList.append(6);
+    _windows.append(Window());
+    _summaries.append(Summary());
     endInsertColumns();
-    reset();
-    _rows = rowCount();
+    updateRowCount();
     return true;
   }
   return false;
@@ -48,7 +60,10 @@ bool VectorModel::removeVector(int order)
   beginRemoveColumns(QModelIndex(), order, order);
   _vectorList.removeAt(order);
   _digitNbList.removeAt(order);
+  _windows.removeAt(order);
+  _summaries.removeAt(order);
   endRemoveColumns();
+  updateRowCount();
   return true;
 }
 
@@ -59,11 +74,57 @@ int VectorModel::columnCount(const QModelIndex&) const {
 
 
 int VectorModel::rowCount(const QModelIndex&) const {
+  return _rows;
+}
+
+
+void VectorModel::updateRowCount() {
   int length = 0;
   for(int i=0;i<_vectorList.length();i++) {
       length = qMax(length, _vectorList.at(i)->length());
   }
-  return length;
+  if (length > _rows) {
+    beginInsertRows(QModelIndex(), _rows, length - 1);
+    _rows = length;
+    endInsertRows();
+  } else if (length < _rows) {
+    beginRemoveRows(QModelIndex(), length, _rows - 1);
+    _rows = length;
+    endRemoveRows();
+  }
+}
+
+
+QString VectorModel::format(int column, double value) const {
+  // Return string depending on number of digits, for 0 try to print as int
+  switch (_digitNbList.at(column)) {
+    case 0:
+      // Cast to long int if not too big
+      if (value < (double) LLONG_MAX && value > (double) LLONG_MIN) {
+        return QString::number((qlonglong) value);
+      }
+      return QString::number(value);
+    default:
+      return QString::number(value, 'g', _digitNbList.at(column));
+  }
+}
+
+
+void VectorModel::fillWindow(int column, int row) const {
+  Window &w = _windows[column];
+  VectorPtr v = _vectorList.at(column);
+
+  v->readLock();
+  const int length = v->length();
+  const double *d = v->value();
+  w.first = qMax(0, row - WindowRows/2);
+  const int last = qMin(length, w.first + WindowRows);
+  w.text.resize(qMax(0, last - w.first));
+  for (int i = w.first; i < last; ++i) {
+    w.text[i - w.first] = format(column, d[i]);
+  }
+  w.serial = v->serialOfLastChange();
+  v->unlock();
 }
 
 
@@ -75,23 +136,16 @@ QVariant VectorModel::data(const QModelIndex& index, int role) const {
         if (index.row() >= _vectorList.at(index.column())->length()) {
           return QVariant();
         } else {
-            double value = _vectorList.at(index.column())->value(index.row());
-            // Return string depending on number of digits, for 0 try to print as int
-            switch (_digitNbList.at(index.column())) {
-              case 0:
-                // Cast to long int if not too big
-                if (value < (double) LLONG_MAX && value > (double) LLONG_MIN) {
-                  qDebug() << "print as int";
-                  return QVariant(QString::number((qlonglong) value));
-                }
-                else {
-                  return QVariant(value);
-                }
-                break;
-              default:
-                return QVariant(QString::number(value, 'g', _digitNbList.at(index.column())));
-                break;
-            }
+          // formatted a window at a time, so a view scrolling over a long
+          // vector only formats the rows it shows
+          int i = index.row() - _windows.at(index.column()).first;
+          if (i < 0 || i >= _windows.at(index.column()).text.size() ||
+              _windows.at(index.column()).serial != _vectorList.at(index.column())->serialOfLastChange()) {
+            fillWindow(index.column(), index.row());
+            i = index.row() - _windows.at(index.column()).first;
+          }
+          const Window &w = _windows.at(index.column());
+          return i < w.text.size() ? QVariant(w.text.at(i)) : QVariant();
         }
         break;
       case Qt::FontRole:
@@ -160,14 +214,116 @@ bool VectorModel::setData(const QModelIndex& index, const QVariant& value, int r
 }
 
 void VectorModel::resetIfChanged() {
-  if (_rows!=rowCount()) {
-    reset();
-    _rows = rowCount();
+  foreach (const VectorPtr &v, _vectorList) {
+    UpdateManager::self()->ensureUpdated(v);
+  }
+  updateRowCount();
+
+  // format again what the view shows, when it asks
+  for (int column = 0; column < _windows.count(); ++column) {
+    Window &w = _windows[column];
+    const int first = w.first;
+    const int last = qMin(_rows, w.first + w.text.size()) - 1;
+    w.text.clear();
+    if (last >= first) {
+      emit dataChanged(index(first, column), index(last, column));
+    }
   }
 }
 
 void VectorModel::setDigitNumber(int column, int nbDigits) {
   _digitNbList[column] = nbDigits;
+  _windows[column].text.clear();
+  if (_rows > 0) {
+    emit dataChanged(index(0, column), index(_rows - 1, column));
+  }
+}
+
+
+void VectorModel::updateSummary(int column) const {
+  Summary &s = _summaries[column];
+  VectorPtr v = _vectorList.at(column);
+  const int length = v->length();
+  if (s.length == length && s.serial == v->serialOfLastChange()) {
+    return;
+  }
+
+  const double *d = v->value();
+  const int blocks = (length + BlockSamples - 1)/BlockSamples;
+  const int groups = (blocks + GroupBlocks - 1)/GroupBlocks;
+  s.blockMin.fill(HUGE_VAL, blocks);
+  s.blockMax.fill(-HUGE_VAL, blocks);
+  s.groupMin.fill(HUGE_VAL, groups);
+  s.groupMax.fill(-HUGE_VAL, groups);
+  for (int b = 0; b < blocks; ++b) {
+    double lo = HUGE_VAL, hi = -HUGE_VAL;
+    const int end = qMin(length, (b + 1)*BlockSamples);
+    for (int i = b*BlockSamples; i < end; ++i) {
+      // NaNs compare false, so holes are left out
+      if (d[i] < lo) {
+        lo = d[i];
+      }
+      if (d[i] > hi) {
+        hi = d[i];
+      }
+    }
+    s.blockMin[b] = lo;
+    s.blockMax[b] = hi;
+    const int g = b/GroupBlocks;
+    s.groupMin[g] = qMin(s.groupMin.at(g), lo);
+    s.groupMax[g] = qMax(s.groupMax.at(g), hi);
+  }
+  s.length = length;
+  s.serial = v->serialOfLastChange();
+}
+
+
+// whether samples from..from + n - 1, whose range is lo..hi, can reach
+// value: the sample before them counts, for a crossing at from
+static bool mayReach(const double *d, int from, double lo, double hi, double value) {
+  if (from > 0) {
+    if (d[from - 1] < lo) {
+      lo = d[from - 1];
+    }
+    if (d[from - 1] > hi) {
+      hi = d[from - 1];
+    }
+  }
+  return lo <= value && value <= hi;
+}
+
+
+int VectorModel::findValue(int column, double value, int from) const {
+  if (column < 0 || column >= _vectorList.count()) {
+    return -1;
+  }
+  VectorPtr v = _vectorList.at(column);
+  v->readLock();
+  updateSummary(column);
+  const Summary &s = _summaries.at(column);
+  const double *d = v->value();
+  const int length = v->length();
+  const int groupSamples = BlockSamples*GroupBlocks;
+
+  int found = -1;
+  int i = qMax(0, from);
+  while (i < length) {
+    if (i % groupSamples == 0 && !mayReach(d, i, s.groupMin.at(i/groupSamples), s.groupMax.at(i/groupSamples), value)) {
+      i += groupSamples;
+      continue;
+    }
+    if (i % BlockSamples == 0 && !mayReach(d, i, s.blockMin.at(i/BlockSamples), s.blockMax.at(i/BlockSamples), value)) {
+      i += BlockSamples;
+      continue;
+    }
+    if (d[i] == value || (i > 0 && ((d[i - 1] < value && d[i] > value) || (d[i - 1] > value && d[i] < value)))) {
+      found = i;
+      break;
+    }
+    ++i;
+  }
+  v->unlock();
+  return found;
 }
 
 }
@@ -15,6 +15,7 @@
 
 #include <QAbstractTableModel>
 #include <QPointer>
+#include <QVector>
 #include <vector.h>
 
 namespace Kst {
@@ -34,12 +35,45 @@ public:
   QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
   Qt::ItemFlags flags(const QModelIndex& index) const;
   bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
+  // After an update: inserts or removes the rows by which the longest
+  // vector changed, and formats again only the rows which were shown.
   void resetIfChanged();
   void setDigitNumber(int column, int nbDigits);
+
+  // The first row from 'from' on at which the column's samples reach
+  // value: equal to it, or on the other side of it from the sample before.
+  // -1 if they don't.
+  int findValue(int column, double value, int from) const;
+
 private:
+  // Formatted samples first .. first + text.size() - 1 of a column, made
+  // around the rows the view asks for.
+  struct Window {
+    Window() : first(0), serial(Object::NoInputs) {}
+    int first;
+    qint64 serial;
+    QVector<QString> text;
+  };
+
+  // Ranges of blocks of samples, and of groups of blocks, so that
+  // findValue() skips the ones the value is outside of.
+  struct Summary {
+    Summary() : length(-1), serial(Object::NoInputs) {}
+    int length;
+    qint64 serial;
+    QVector<double> blockMin, blockMax, groupMin, groupMax;
+  };
+
+  void updateRowCount();
+  void fillWindow(int column, int row) const;
+  void updateSummary(int column) const;
+  QString format(int column, double value) const;
+
   VectorList _vectorList;
   QList<int> _digitNbList;
   int _rows;
+  mutable QList<Window> _windows;
+  mutable QList<Summary> _summaries;
 };
 
 }
@@ -23,6 +23,7 @@
 #include "document.h"
 #include "plotitemmanager.h"
 #include "plotitem.h"
+#include "plotrenderitem.h"
 #include "plotaxis.h"
 #include "dialogdefaults.h"
 #include "datacollection.h"
@@ -33,6 +34,7 @@
 #include <QTimer>
 #include <QUndoStack>
 #include <QResizeEvent>
+#include <QPaintEvent>
 #include <QMenu>
 #include <QWidgetAction>
 #include <QGraphicsItem>
@@ -41,6 +43,7 @@
 #include <QInputDialog>
 #include <QKeyEvent>
 #include <QtCore/qmath.h>
+#include <QtConcurrentMap>
 
 namespace Kst {
 
@@ -441,7 +444,58 @@ void View::forceChildResize(QRectF oldRect, QRectF newRect) {
 }
 
 
+static void prepareRelation(const RelationRenderJob &job) {
+  job.relation->preparePaint(job.context);
+}
+
+
+// Build the paint objects of the curves and images about to be drawn in the
+// exposed rect, one relation per thread.  The GUI thread waits here, so
+// nothing updates the relations meanwhile; painting them stays on the GUI
+// thread and only draws the prepared objects.
+void View::prepareRelations(const QRect &window, const QRectF &rect) {
+  QList<RelationRenderJob> jobs;
+  foreach (QGraphicsItem *item, scene()->items(rect)) {
+    PlotRenderItem *renderItem = dynamic_cast<PlotRenderItem*>(item);
+    if (!renderItem || !renderItem->isVisible() || !renderItem->rect().isValid() ||
+        renderItem->plotItem()->maskedByMaximization()) {
+      continue;
+    }
+    renderItem->prepareRelations(window, jobs);
+  }
+
+  // a relation shown in several plots can only be prepared for one of them
+  QHash<Relation*, int> uses;
+  foreach (const RelationRenderJob &job, jobs) {
+    ++uses[job.relation.data()];
+  }
+  QList<RelationRenderJob>::Iterator it = jobs.begin();
+  while (it != jobs.end()) {
+    if (uses.value((*it).relation.data()) > 1) {
+      it = jobs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (jobs.count() > 1) {
+    QtConcurrent::blockingMap(jobs, prepareRelation);
+  }
+}
+
+
+// The background is cached on screen, so drawBackground() does not see
+// every repaint of the viewport.
+void View::paintEvent(QPaintEvent *event) {
+  prepareRelations(viewport()->rect(), mapToScene(event->rect()).boundingRect());
+  QGraphicsView::paintEvent(event);
+}
+
+
 void View::drawBackground(QPainter *painter, const QRectF &rect) {
+  // render() and printing draw the background every time
+  prepareRelations(painter->window(), rect);
+
   if (isPrinting()) {
     QBrush currentBrush(backgroundBrush());
     setBackgroundBrush(Qt::white);
@@ -149,6 +149,7 @@ class View : public QGraphicsView
     bool event(QEvent *event);
     bool eventFilter(QObject *obj, QEvent *event);
     void resizeEvent(QResizeEvent *event=NULL);
+    void paintEvent(QPaintEvent *event);
     void drawBackground(QPainter *painter, const QRectF &rect);
     void addTitle(QMenu *menu) const;
 
@@ -164,6 +165,7 @@ class View : public QGraphicsView
 
   private:
     void updateChildGeometry(const QRectF &oldSceneRect);
+    void prepareRelations(const QRect &window, const QRectF &rect);
 
   private:
     QUndoStack *_undoStack;
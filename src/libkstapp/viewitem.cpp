@@ -905,6 +905,13 @@ bool ViewItem::isMaximized() {
   }
 }
 
+QPen ViewItem::rescaledPen(const QRectF &window) const {
+  QPen rescaled_pen(_storedPen);
+  rescaled_pen.setWidth(Curve::lineDim(window, rescaled_pen.widthF()));
+  return rescaled_pen;
+}
+
+
 void ViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
   Q_UNUSED(option);
   Q_UNUSED(widget);
@@ -912,9 +919,7 @@ void ViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     return;
   }
 
-  QPen rescaled_pen(_storedPen);
-  rescaled_pen.setWidth(Curve::lineDim(painter->window(),rescaled_pen.widthF()));
-  setPen(rescaled_pen);
+  setPen(rescaledPen(painter->window()));
 
   painter->save();
   painter->setPen(pen());
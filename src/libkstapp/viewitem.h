@@ -253,6 +253,8 @@ class ViewItem : public QObject, public NamedObject, public QGraphicsRectItem
 
     void storePen(const QPen &pen) {_storedPen = pen; setPen(pen);}
     QPen storedPen() const { return _storedPen;}
+    // the stored pen scaled to a painter window, as paint() draws with it
+    QPen rescaledPen(const QRectF &window) const;
 
   Q_SIGNALS:
     void geometryChanged();
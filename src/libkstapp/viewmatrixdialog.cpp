@@ -14,9 +14,16 @@
 
 #include "document.h"
 #include "matrixmodel.h"
+#include "updatemanager.h"
+
+#include <QHeaderView>
 
 #include <datacollection.h>
 
+#ifdef QT5
+#define setResizeMode setSectionResizeMode
+#endif
+
 namespace Kst {
 
 ViewMatrixDialog::ViewMatrixDialog(QWidget *parent, Document *doc)
@@ -26,6 +33,10 @@ ViewMatrixDialog::ViewMatrixDialog(QWidget *parent, Document *doc)
 
   connect(matrixSelector, SIGNAL(selectionChanged()), this, SLOT(matrixSelected()));
   matrixSelector->setObjectStore(doc->objectStore());
+  connect(UpdateManager::self(), SIGNAL(objectsUpdated(qint64)), this, SLOT(matrixUpdated()));
+
+  // rows all the same height, so large matrices aren't measured row by row
+  _matrices->verticalHeader()->setResizeMode(QHeaderView::Fixed);
 
   setAttribute(Qt::WA_DeleteOnClose);
 }
@@ -58,6 +69,13 @@ void ViewMatrixDialog::matrixSelected() {
 }
 
 
+void ViewMatrixDialog::matrixUpdated() {
+  if (_model) {
+    _model->resetIfChanged();
+  }
+}
+
+
 
 }
 
@@ -35,6 +35,7 @@ class ViewMatrixDialog : public QDialog, Ui::ViewMatrixDialog
 
 private Q_SLOTS:
     void matrixSelected();
+    void matrixUpdated();
 
   private:
     Document *_doc;
@@ -16,9 +16,12 @@
 #include "vectormodel.h"
 #include "editmultiplewidget.h"
 #include "updateserver.h"
+#include "updatemanager.h"
 
 #include <datacollection.h>
 #include <objectstore.h>
+#include <QApplication>
+#include <QDoubleValidator>
 #include <QHeaderView>
 #include <QMenu>
 
@@ -40,6 +43,8 @@ ViewVectorDialog::ViewVectorDialog(QWidget *parent, Document *doc)
   _hideVectorList->setFixedSize(size + 8, size + 8);
 
   _vectors->horizontalHeader()->setResizeMode(QHeaderView::Interactive);
+  // rows all the same height, so long vectors aren't measured row by row
+  _vectors->verticalHeader()->setResizeMode(QHeaderView::Fixed);
   // Allow reorganizing the columns per drag&drop
   _vectors->horizontalHeader()->setMovable(true);
 
@@ -85,8 +90,13 @@ ViewVectorDialog::ViewVectorDialog(QWidget *parent, Document *doc)
   connect(_showMultipleWidget, SIGNAL(itemDoubleClicked()), this, SLOT(addSelected()));
   connect(_showVectorList, SIGNAL(clicked()), this, SLOT(showVectorList()));
   connect(_hideVectorList, SIGNAL(clicked()), this, SLOT(hideVectorList()));
+  connect(_goToRow, SIGNAL(valueChanged(int)), this, SLOT(goToRow(int)));
+  connect(_findNext, SIGNAL(clicked()), this, SLOT(findNext()));
+  connect(_findValue, SIGNAL(returnPressed()), this, SLOT(findNext()));
+  _findValue->setValidator(new QDoubleValidator(_findValue));
 
   connect(UpdateServer::self(), SIGNAL(objectListsChanged()), this, SLOT(update()));
+  connect(UpdateManager::self(), SIGNAL(objectsUpdated(qint64)), this, SLOT(vectorsUpdated()));
 
 }
 
@@ -145,9 +155,13 @@ void ViewVectorDialog::update()
   foreach(VectorPtr object, objects) {
     _showMultipleWidget->addObject(object->Name(), object->descriptionTip());
   }
+  vectorsUpdated();
+}
+
+void ViewVectorDialog::vectorsUpdated() {
   if (_model) {
     _model->resetIfChanged();
-    _vectors->viewport()->update();
+    _goToRow->setMaximum(qMax(1, _model->rowCount()));
   }
 }
 
@@ -165,6 +179,7 @@ void ViewVectorDialog::addSelected() {
       _model->addVector(vector);
     }
   }
+  _goToRow->setMaximum(qMax(1, _model->rowCount()));
 }
 
 void ViewVectorDialog::removeSelected() {
@@ -183,6 +198,33 @@ void ViewVectorDialog::reset() {
   _model = 0;
 }
 
+void ViewVectorDialog::goToRow(int row) {
+  if (!_model || row < 1 || row > _model->rowCount()) {
+    return;
+  }
+  const QModelIndex index = _model->index(row - 1, qMax(0, _vectors->currentIndex().column()));
+  _vectors->setCurrentIndex(index);
+  _vectors->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void ViewVectorDialog::findNext() {
+  bool ok = false;
+  const double value = _findValue->text().toDouble(&ok);
+  if (!_model || !ok) {
+    return;
+  }
+  const QModelIndex current = _vectors->currentIndex();
+  const int column = current.isValid() ? current.column() : 0;
+  const int row = _model->findValue(column, value, current.isValid() ? current.row() + 1 : 0);
+  if (row < 0) {
+    QApplication::beep();
+    return;
+  }
+  const QModelIndex index = _model->index(row, column);
+  _vectors->setCurrentIndex(index);
+  _vectors->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
 void ViewVectorDialog::showVectorList() {
   _splitterSizes[0] = qMax(_splitterSizes[0],150);
   _splitter->setSizes(_splitterSizes);
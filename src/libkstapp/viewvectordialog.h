@@ -42,6 +42,9 @@ private Q_SLOTS:
   void addSelected();
   void removeSelected();
   void reset();
+  void vectorsUpdated();
+  void goToRow(int row);
+  void findNext();
   void showVectorList();
   void hideVectorList();
 
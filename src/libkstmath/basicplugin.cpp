@@ -27,6 +27,7 @@
 #include "datacollection.h"
 #include "objectstore.h"
 #include "dataobjectplugin.h"
+#include "datavector.h"
 
 namespace Kst {
 
@@ -34,7 +35,7 @@ const QString BasicPlugin::staticTypeString = "Plugin";
 const QString BasicPlugin::staticTypeTag = "plugin";
 
 BasicPlugin::BasicPlugin(ObjectStore *store)
-: DataObject(store) {
+: DataObject(store), _streamValid(false) {
   _typeString = "Plugin";
   _type = "Plugin";
 
@@ -163,6 +164,7 @@ StringPtr BasicPlugin::outputString(const QString& string) const {
 
 
 void BasicPlugin::setInputVector(const QString &type, VectorPtr ptr) {
+  _streamValid = false;
   if (ptr) {
     _inputVectors[type] = ptr;
   } else {
@@ -172,6 +174,7 @@ void BasicPlugin::setInputVector(const QString &type, VectorPtr ptr) {
 
 
 void BasicPlugin::setInputScalar(const QString &type, ScalarPtr ptr) {
+  _streamValid = false;
   if (ptr) {
     _inputScalars[type] = ptr;
   } else {
@@ -181,6 +184,7 @@ void BasicPlugin::setInputScalar(const QString &type, ScalarPtr ptr) {
 
 
 void BasicPlugin::setInputString(const QString &type, StringPtr ptr) {
+  _streamValid = false;
   if (ptr) {
     _inputStrings[type] = ptr;
   } else {
@@ -228,16 +232,22 @@ void BasicPlugin::internalUpdate() {
 
   writeLockInputsAndOutputs();
 
-  //Call the plugins algorithm to operate on the inputs
-  //and produce the outputs
-  if ( !algorithm() ) {
-    Debug::self()->log(tr("There is an error in the %1 algorithm.").arg(propertyString()), Debug::Error);
-    unlockInputsAndOutputs();
-    return;
+  //Let a streaming plugin only process what changed, otherwise call the
+  //plugins algorithm to operate on the inputs and produce the outputs
+  int from = streamStart();
+  if (from <= 0 || !algorithmAppend(from)) {
+    from = 0;
+    if ( !algorithm() ) {
+      Debug::self()->log(tr("There is an error in the %1 algorithm.").arg(propertyString()), Debug::Error);
+      _streamValid = false;
+      unlockInputsAndOutputs();
+      return;
+    }
   }
+  recordStreamInputs();
 
   //Perform update on the outputs
-  updateOutput();
+  updateOutput(from);
 
   createScalars();
 
@@ -373,7 +383,88 @@ bool BasicPlugin::inputsExist() const {
 }
 
 
-void BasicPlugin::updateOutput() const {
+// The first input sample which can have changed since the last successful
+// update, or 0 if everything has to be recomputed.  Only data vectors and
+// the outputs of other plugins report reliably which samples are new, and
+// only for their latest update: a vector which updated more than once since
+// we last read it (because we were skipped, e.g. while hidden) reports just
+// the samples of the last one.  So each vector must either be unchanged, or
+// have grown from exactly the length we consumed.
+int BasicPlugin::streamStart() const {
+  if (!_streamValid || _inputVectors.isEmpty()) {
+    return 0;
+  }
+
+  for (ScalarMap::ConstIterator it = _inputScalars.constBegin(); it != _inputScalars.constEnd(); ++it) {
+    QHash<QString, double>::ConstIterator old = _streamScalars.constFind(it.key());
+    if (old == _streamScalars.constEnd() || !it.value() || old.value() != it.value()->value()) {
+      return 0;
+    }
+  }
+  for (StringMap::ConstIterator it = _inputStrings.constBegin(); it != _inputStrings.constEnd(); ++it) {
+    QHash<QString, QString>::ConstIterator old = _streamStrings.constFind(it.key());
+    if (old == _streamStrings.constEnd() || !it.value() || old.value() != it.value()->value()) {
+      return 0;
+    }
+  }
+
+  int from = -1;
+  for (VectorMap::ConstIterator it = _inputVectors.constBegin(); it != _inputVectors.constEnd(); ++it) {
+    const VectorPtr v = it.value();
+    QHash<QString, StreamInput>::ConstIterator old = _streamVectors.constFind(it.key());
+    if (!v || old == _streamVectors.constEnd() || old.value().vector != v.data()) {
+      return 0;
+    }
+    if (!kst_cast<DataVector>(v) && !kst_cast<BasicPlugin>(v->provider())) {
+      return 0;
+    }
+    int first;
+    if (v->serialOfLastChange() == old.value().serial) {
+      // not updated since; numNew() still describes what we consumed
+      if (v->length() != old.value().length) {
+        return 0;
+      }
+      first = v->length();
+    } else {
+      if (v->numShift() != 0 || v->length() - v->numNew() != old.value().length) {
+        return 0;
+      }
+      first = old.value().length;
+    }
+    from = (from < 0) ? first : qMin(from, first);
+  }
+  return qMax(0, from);
+}
+
+
+void BasicPlugin::recordStreamInputs() {
+  _streamVectors.clear();
+  _streamScalars.clear();
+  _streamStrings.clear();
+  for (VectorMap::ConstIterator it = _inputVectors.constBegin(); it != _inputVectors.constEnd(); ++it) {
+    if (it.value()) {
+      StreamInput in;
+      in.vector = it.value().data();
+      in.length = it.value()->length();
+      in.serial = it.value()->serialOfLastChange();
+      _streamVectors.insert(it.key(), in);
+    }
+  }
+  for (ScalarMap::ConstIterator it = _inputScalars.constBegin(); it != _inputScalars.constEnd(); ++it) {
+    if (it.value()) {
+      _streamScalars.insert(it.key(), it.value()->value());
+    }
+  }
+  for (StringMap::ConstIterator it = _inputStrings.constBegin(); it != _inputStrings.constEnd(); ++it) {
+    if (it.value()) {
+      _streamStrings.insert(it.key(), it.value()->value());
+    }
+  }
+  _streamValid = true;
+}
+
+
+void BasicPlugin::updateOutput(int from) const {
   //output vectors...
   //FIXME: _outputVectors should be used, not this string list!
   QStringList ov = outputVectorList();
@@ -382,7 +473,12 @@ void BasicPlugin::updateOutput() const {
     if (VectorPtr o = outputVector(*ovI)) {
       Q_ASSERT(o->myLockStatus() == KstRWLock::WRITELOCKED);
       vectorRealloced(o, o->value(), o->length()); // why here?
-      o->setNewAndShift(o->length(), o->numShift()); // why here?
+      // report what was recomputed, so plugins reading this can stream too
+      if (from > 0) {
+        o->setNewAndShift(qMax(0, o->length() - from), 0);
+      } else {
+        o->setNewAndShift(o->length(), o->numShift()); // why here?
+      }
     }
   }
 }
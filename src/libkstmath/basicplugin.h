@@ -33,6 +33,16 @@ class KSTMATH_EXPORT BasicPlugin : public DataObject {
     //to produce the outputVectors, outputScalars, and outputStrings.
     virtual bool algorithm() = 0;
 
+    //Streaming.  Called instead of algorithm() when the scalar and string
+    //inputs are unchanged since the last successful update, and the input
+    //vectors only changed from sample 'from' on (typically because samples
+    //were appended).  Outputs before 'from' can be kept; the rest are to be
+    //recomputed, carrying whatever state the plugin kept from its previous
+    //update; lower 'from' if earlier outputs changed as well.  Returning
+    //false falls back to algorithm(), which also has to rebuild that state.
+    //Only worth reimplementing for causal plugins.
+    virtual bool algorithmAppend(int &from) { Q_UNUSED(from); return false; }
+
     //String lists of the names of the expected inputs.
     virtual QStringList inputVectorList() const = 0;
     virtual QStringList inputScalarList() const = 0;
@@ -108,9 +118,22 @@ class KSTMATH_EXPORT BasicPlugin : public DataObject {
     virtual void _initializeShortName();
   private:
     bool inputsExist() const;
-    void updateOutput() const;
+    void updateOutput(int from) const;
+    int streamStart() const;
+    void recordStreamInputs();
 
     QString _pluginName;
+
+    // the inputs as of the last successful update, for streamStart()
+    struct StreamInput {
+      Vector *vector;
+      int length;
+      qint64 serial; // serialOfLastChange()
+    };
+    QHash<QString, StreamInput> _streamVectors;
+    QHash<QString, double> _streamScalars;
+    QHash<QString, QString> _streamStrings;
+    bool _streamValid;
 };
 
 typedef SharedPtr<BasicPlugin> BasicPluginPtr;
@@ -30,14 +30,13 @@
 #include "linestyle.h"
 #include "math_kst.h"
 #include "datavector.h"
-#include "ksttimers.h"
 #include "objectstore.h"
+#include "trace.h"
 
 #include <time.h>
 #include <iostream>
 
 // #define DEBUG_VECTOR_CURVE
-// #define BENCHMARK
 
 // NOTE: on a modern (eg, sandybridge or later) cpu
 // the cpu's branch prediction is so good, this does
@@ -690,10 +689,7 @@ double Curve::lineDim(const QRectF &R, double linewidth) {
 }
 
 void Curve::paintObjects(const CurveRenderContext& context) {
-#ifdef BENCHMARK
-  QTime bench_time;
-  bench_time.start();
-#endif
+  TRACE_SPAN_DETAIL("paint", "Curve::paintObjects", Name());
 
   QPainter *p = context.painter;
   double point_dim = pointDim(p->window());
@@ -731,13 +727,12 @@ void Curve::paintObjects(const CurveRenderContext& context) {
     CurvePointSymbol::draw(HeadType, p, _head.x(), _head.y(), point_dim);
   }
   p->restore();
-#ifdef BENCHMARK
-  std::cout << "curve drawing:" << bench_time.elapsed() << "ms\n";
-#endif
 }
 
 
 void Curve::updatePaintObjects(const CurveRenderContext& context) {
+  TraceSpan span("paint", "Curve::updatePaintObjects");
+
   _polygons.clear();
   _lines.clear();
   _points.clear();
@@ -765,22 +760,12 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
   bool overlap = false;
   int i_pt;
 
-#ifdef BENCHMARK
-  QTime bench_time, benchtmp;
-  int b_1 = 0, b_2 = 0, b_3 = 0, b_4 = 0;
-  bench_time.start();
-  benchtmp.start();
-  int numberOfLinesDrawn = 0;
-  int numberOfPointsDrawn = 0;
-  int numberOfBarsDrawn = 0;
-#endif
-
-  _width = lineDim(context.painter->window(), lineWidth());
+  _width = lineDim(context.window, lineWidth());
 
   //qDebug() << context.painter->device()->width() << context.painter->device()->logicalDpiX() <<
   //            context.painter->device()->width()/context.painter->device()->logicalDpiX();
 
-  double errorFlagDim = pointDim(context.painter->window());
+  double errorFlagDim = pointDim(context.window);
   if (sampleCount() > 0) {
     int i0, iN;
 
@@ -798,9 +783,6 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
       iN = sampleCount() - 1;
     }
 
-#ifdef BENCHMARK
-    clock_t linesStart = clock();
-#endif
     if (hasLines()) {
       QPolygonF points;
       points.reserve(MAX_NUM_POLYLINES);
@@ -865,9 +847,6 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
         if (KDE_ISUNLIKELY(foundNan)) {
           if (points.size()>0) {
             _polygons.append(points);
-#ifdef BENCHMARK
-            ++numberOfLinesDrawn;
-#endif
           }
           points.resize(0);
           if (overlap) {
@@ -877,9 +856,6 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
               if (minY < Ly && maxY >= Ly)
                 minY = Ly;
               if (minY >= Ly && minY <= Hy && maxY >= Ly && maxY <= Hy) {
-#ifdef BENCHMARK
-                ++numberOfLinesDrawn;
-#endif
                 double fX2 = floor(X2)+0.5;
                 _lines.append(QLineF(fX2, minY, fX2, maxY));
               }
@@ -926,9 +902,6 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
                   if (points.size()>MAX_NUM_POLYLINES-2) {
                     _polygons.append(points);
                     points.resize(0);
-#ifdef BENCHMARK
-                    ++numberOfLinesDrawn;
-#endif
                   }
                   double fX2 = floor(X2)+0.5;
 
@@ -960,13 +933,7 @@ void Curve::updatePaintObjects(const CurveRenderContext& context) {
                     if (points.size()>0) {
                       _polygons.append(points);
                       points.resize(0);
-#ifdef BENCHMARK
-                      ++numberOfLinesDrawn;
-#endif
                     }
-#ifdef BENCHMARK
-  ++numberOfLinesDrawn;
-#endif
                     double fX2 = floor(X2)+0.5;
                     _lines.append(QLineF(fX2, minY, fX2, maxY));
                   }
@@ -1083,9 +1050,6 @@ qDebug() << "y not in bounds"
                   if (KDE_ISLIKELY(points.size()>1)) {
                     _polygons.append(points);
                     points.resize(0);
-#ifdef BENCHMARK
-                    ++numberOfLinesDrawn;
-#endif
                   }
                   points.append(QPointF(X2, Y2));
                   points.append(QPointF(X1, Y1));
@@ -1102,9 +1066,6 @@ qDebug() << "y not in bounds"
       if (points.size()>1) {
         _polygons.append(points);
         points.resize(0);
-#ifdef BENCHMARK
-        ++numberOfLinesDrawn;
-#endif
       }
 
       // we might have some overlapping points still unplotted...
@@ -1117,9 +1078,6 @@ qDebug() << "y not in bounds"
             minY = Ly;
           }
           if (minY >= Ly && minY <= Hy && maxY >= Ly && maxY <= Hy) {
-#ifdef BENCHMARK
-            ++numberOfLinesDrawn;
-#endif
            _lines.append(QLineF(X2, minY, X2, maxY));
           }
         }
@@ -1127,11 +1085,6 @@ qDebug() << "y not in bounds"
       }
     } // end if hasLines()
 
-#ifdef BENCHMARK
-    clock_t linesEnd = clock();
-    std::cout << "\n        Lines clocks: " << (linesEnd - linesStart) << "\n";
-    b_1 = benchtmp.elapsed();
-#endif
 
     VectorPtr exv = _inputVectors.contains(EXVECTOR) ? *_inputVectors.find(EXVECTOR) : 0;
     VectorPtr eyv = _inputVectors.contains(EYVECTOR) ? *_inputVectors.find(EYVECTOR) : 0;
@@ -1202,17 +1155,11 @@ qDebug() << "y not in bounds"
               _rects.append(rect);
             //}
             lastRect = rect;
-#ifdef BENCHMARK
-            ++numberOfBarsDrawn;
-#endif
           }
         }
       }
     }
 
-#ifdef BENCHMARK
-    b_2 = benchtmp.elapsed();
-#endif
 
     // draw the points, if any...
     if (hasPoints()) {
@@ -1243,9 +1190,6 @@ qDebug() << "y not in bounds"
         pt.setY(m_Y * rY + b_Y);
         if (rect.contains(pt) && pt != lastPt &&
             (lastPt.isNull() || (abs(pt.x() - lastPt.x()) > size) || ((size==0) && (abs(pt.y() - lastPt.y()) > 0)))) {
-#ifdef BENCHMARK
-          ++numberOfPointsDrawn;
-#endif
             lastPt = pt;
             _points.append(pt);
         }
@@ -1276,9 +1220,6 @@ qDebug() << "y not in bounds"
     }
 
 
-#ifdef BENCHMARK
-    b_3 = benchtmp.elapsed();
-#endif
 
     // draw the x-errors, if any...
     if ((exv || exmv) && !hasBars()) {
@@ -1461,27 +1402,10 @@ qDebug() << "y not in bounds"
     } // end if (hasYError())
   } // end if (sampleCount() > 0)
 
-#ifdef BENCHMARK
-  b_4 = benchtmp.elapsed();
-#endif
-
-#ifdef BENCHMARK
-  int i = bench_time.elapsed();
-  //qDebug() << endl << "Plotting curve " << (void *)this << ": " << i << "ms";
-  //qDebug() << "    Without locks: " << b_4 << "ms";
-  //qDebug() << "    Number of lines drawn:" << numberOfLinesDrawn;
-  //qDebug() << "    Number of points drawn:" << numberOfPointsDrawn;
-  //qDebug() << "    Number of bars drawn:" << numberOfBarsDrawn;
-  std::cout << "\nPlotting curve " << (void *)this << ": " << i << " ms";
-  std::cout << "\n    Without locks: " << b_4 << "ms";
-  std::cout << "\n    Number of lines drawn:" << numberOfLinesDrawn;
-  std::cout << "\n    Number of points drawn:" << numberOfPointsDrawn;
-  std::cout << "\n    Number of bars drawn:" << numberOfBarsDrawn;
-  if (b_1 > 0)       std::cout << "\n            Lines: " << b_1 << " ms\n";
-  if (b_2 - b_1 > 0) std::cout << "\n             Bars: " << (b_2 - b_1) << " ms\n";
-  if (b_3 - b_2 > 0) std::cout << "\n           Points: " << (b_3 - b_2) << " ms\n";
-  if (b_4 - b_3 > 0) std::cout << "\n           Errors: " << (b_4 - b_3) << " ms\n";
-#endif
+  if (span.isActive()) {
+    span.setDetail(QString("%1: %2 lines, %3 points, %4 bars").arg(Name())
+                   .arg(_polygons.size() + _lines.size()).arg(_points.size()).arg(_filledRects.size()));
+  }
 }
 
 
@@ -26,9 +26,13 @@
 #include "sharedptr.h"
 #include "primitive.h"
 #include "settings.h"
+#include "pluginmanifest.h"
 
 #include <QApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSharedPointer>
 #include <qdebug.h>
 #include <qtimer.h>
 #include <QPluginLoader>
@@ -70,7 +74,66 @@ DataObject::~DataObject() {
 }
 
 
-static DataObjectPluginList _pluginList;
+namespace {
+
+// A plugin found by scanPlugins().  Plugins known from the manifest are
+// only loaded once something needs more than their name and type.
+class FoundDataObjectPlugin
+{
+  public:
+    explicit FoundDataObjectPlugin(const SharedPtr<DataObjectPluginInterface>& plug) :
+      name(plug->pluginName()),
+      description(plug->pluginDescription()),
+      type(plug->pluginType()),
+      hasConfigWidget(plug->hasConfigWidget()),
+      _loaded(new Loaded)
+    {
+      _loaded->plugin = plug;
+      _loaded->tried = true;
+    }
+
+    FoundDataObjectPlugin(const PluginManifest::Entry& entry, const QString& path) :
+      name(entry.name),
+      description(entry.description),
+      type(entry.type),
+      hasConfigWidget(entry.hasConfigWidget),
+      filePath(path),
+      _loaded(new Loaded)
+    {}
+
+    // loads the plugin if it isn't yet; 0 if it can't be loaded
+    SharedPtr<DataObjectPluginInterface> plugin() const {
+      QMutexLocker ml(&_loaded->lock);
+      if (!_loaded->tried) {
+        _loaded->tried = true;
+        if (QObject *o = PluginManifest::load(filePath)) {
+          _loaded->plugin = qobject_cast<DataObjectPluginInterface*>(o);
+        }
+      }
+      return _loaded->plugin;
+    }
+
+    QString name;
+    QString description;
+    int type;
+    bool hasConfigWidget;
+    QString filePath;
+
+  private:
+    // shared by the copies in _pluginList
+    struct Loaded {
+      Loaded() : tried(false) {}
+      QMutex lock;
+      SharedPtr<DataObjectPluginInterface> plugin;
+      bool tried;
+    };
+    QSharedPointer<Loaded> _loaded;
+};
+
+}
+
+typedef QList<FoundDataObjectPlugin> PluginList;
+static PluginList _pluginList;
 void DataObject::cleanupForExit() {
   _pluginList.clear(); //FIXME?
 }
@@ -209,33 +272,52 @@ void DataObject::scanPlugins() {
 
   _pluginList.clear(); //FIXME?
 
-  DataObjectPluginList tmpList;
+  PluginList tmpList;
 
   Debug::self()->log(tr("Scanning for data-object plugins."));
 
   foreach (QObject *plugin, QPluginLoader::staticInstances()) {
     //try a cast
     if (DataObjectPluginInterface *basicPlugin = qobject_cast<DataObjectPluginInterface*>(plugin)) {
-      tmpList.append(basicPlugin);
+      tmpList.append(FoundDataObjectPlugin(basicPlugin));
     }
   }
 
+  // Only files which are new or changed since the last scan are loaded.
+  PluginManifest manifest("dataobject");
   QStringList pluginPaths = pluginSearchPaths();
   foreach (const QString &pluginPath, pluginPaths) {
     QDir d(pluginPath);
     foreach (const QString &fileName, d.entryList(QDir::Files)) {
-        QPluginLoader loader(d.absoluteFilePath(fileName));
+        const QFileInfo file(d.absoluteFilePath(fileName));
+        PluginManifest::Entry entry;
+        if (manifest.lookup(file, &entry)) {
+          if (entry.isPlugin) {
+            tmpList.append(FoundDataObjectPlugin(entry, file.absoluteFilePath()));
+            Debug::self()->log(QString("Plugin found: %1").arg(fileName));
+          }
+          continue;
+        }
+
+        QPluginLoader loader(file.absoluteFilePath());
         QObject *plugin = loader.instance();
         if (plugin) {
           if (DataObjectPluginInterface *dataObjectPlugin = qobject_cast<DataObjectPluginInterface*>(plugin)) {
-            tmpList.append(dataObjectPlugin);
+            entry.isPlugin = true;
+            entry.name = dataObjectPlugin->pluginName();
+            entry.description = dataObjectPlugin->pluginDescription();
+            entry.type = dataObjectPlugin->pluginType();
+            entry.hasConfigWidget = dataObjectPlugin->hasConfigWidget();
+            tmpList.append(FoundDataObjectPlugin(dataObjectPlugin));
             Debug::self()->log(QString("Plugin loaded: %1").arg(fileName));
           }
+          manifest.insert(file, entry);
         } else {
           Debug::self()->log(QString("Plugin failed to load: %1").arg(fileName));
         }
     }
   }
+  manifest.save();
 
   // This cleans up plugins that have been uninstalled and adds in new ones.
   // Since it is a shared pointer it can't dangle anywhere.
@@ -257,8 +339,8 @@ QStringList DataObject::pluginList() {
 
   QStringList plugins;
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    plugins += (*it)->pluginName();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    plugins += (*it).name;
   }
 
   return plugins;
@@ -271,9 +353,9 @@ QStringList DataObject::dataObjectPluginList() {
 
   QStringList plugins;
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginType() == DataObjectPluginInterface::Generic) {
-      plugins += (*it)->pluginName();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).type == DataObjectPluginInterface::Generic) {
+      plugins += (*it).name;
     }
   }
 
@@ -288,9 +370,9 @@ QStringList DataObject::filterPluginList() {
 
   QStringList plugins;
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginType() == DataObjectPluginInterface::Filter) {
-      plugins += (*it)->pluginName();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).type == DataObjectPluginInterface::Filter) {
+      plugins += (*it).name;
     }
   }
 
@@ -305,9 +387,9 @@ QStringList DataObject::fitsPluginList() {
 
   QStringList plugins;
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginType() == DataObjectPluginInterface::Fit) {
-      plugins += (*it)->pluginName();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).type == DataObjectPluginInterface::Fit) {
+      plugins += (*it).name;
     }
   }
 
@@ -320,10 +402,12 @@ DataObjectConfigWidget* DataObject::pluginWidget(const QString& name) {
   // Ensure state.  When using kstapp MainWindow calls init.
   init();
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginName() == name) {
-      if ((*it)->hasConfigWidget()) {
-        return (*it)->configWidget(&settingsObject());
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).name == name) {
+      if ((*it).hasConfigWidget) {
+        if (SharedPtr<DataObjectPluginInterface> plugin = (*it).plugin()) {
+          return plugin->configWidget(&settingsObject());
+        }
       }
       break;
     }
@@ -336,9 +420,9 @@ QString DataObject::pluginDescription(const QString& name) {
   // Ensure state.  When using kstapp MainWindow calls init.
   init();
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginName() == name) {
-      return (*it)->pluginDescription();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).name == name) {
+      return (*it).description;
     }
   }
   return QString();
@@ -349,9 +433,9 @@ int DataObject::pluginType(const QString& name) {
   // Ensure state.  When using kstapp MainWindow calls init.
   init();
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginName() == name) {
-      return (*it)->pluginType();
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).name == name) {
+      return (*it).type;
     }
   }
   return -1;
@@ -362,10 +446,12 @@ DataObjectPtr DataObject::createPlugin(const QString& name, ObjectStore *store,
   // Ensure state.  When using kstapp MainWindow calls init.
   init();
 
-  for (DataObjectPluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
-    if ((*it)->pluginName() == name) {
-      if (DataObjectPtr object = (*it)->create(store, configWidget, setupInputsOutputs)) {
-        return object;
+  for (PluginList::ConstIterator it = _pluginList.constBegin(); it != _pluginList.constEnd(); ++it) {
+    if ((*it).name == name) {
+      if (SharedPtr<DataObjectPluginInterface> plugin = (*it).plugin()) {
+        if (DataObjectPtr object = plugin->create(store, configWidget, setupInputsOutputs)) {
+          return object;
+        }
       }
     }
   }
@@ -778,6 +864,16 @@ qint64 DataObject::maxInputSerialOfLastChange() const {
   return maxSerial;
 }
 
+QList<Object*> DataObject::inputObjects() const {
+  QList<Object*> inputs;
+  foreach (const PrimitivePtr &P, inputPrimitives()) {
+    if (P) {
+      inputs.append(P.data());
+    }
+  }
+  return inputs;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 DataObjectConfigWidget::DataObjectConfigWidget(QSettings *cfg)
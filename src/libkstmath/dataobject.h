@@ -172,6 +172,7 @@ class KSTMATH_EXPORT DataObject : public Object
 
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
   private:
     QString _name;
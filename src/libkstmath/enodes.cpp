@@ -130,6 +130,16 @@ Kst::Object::UpdateType Node::update(Context *ctx) {
 }
 
 
+void Node::values(Context *ctx, long i0, int n, double *out) {
+  const long i = ctx->i;
+  for (int k = 0; k < n; ++k) {
+    ctx->i = i0 + k;
+    out[k] = value(ctx);
+  }
+  ctx->i = i;
+}
+
+
 /////////////////////////////////////////////////////////////////
 BinaryNode::BinaryNode(Node *left, Node *right)
 : Node(), _left(left), _right(right) {
@@ -1343,4 +1353,93 @@ void FoldVisitor::visitBinaryNode(BinaryNode *n) {
   }
 }
 
+
+/////////////////////////////////////////////////////////////////
+// Block evaluation: each node evaluates a whole block of samples per
+// virtual call, so the per sample work is a tight loop.
+
+void Number::values(Context*, long, int n, double *out) {
+  for (int k = 0; k < n; ++k) {
+    out[k] = _n;
+  }
+}
+
+
+void Identifier::values(Context *ctx, long i0, int n, double *out) {
+  if (_const) {
+    const double c = *_const;
+    for (int k = 0; k < n; ++k) {
+      out[k] = c;
+    }
+  } else {
+    Node::values(ctx, i0, n, out);
+  }
+}
+
+
+void DataNode::values(Context *ctx, long i0, int n, double *out) {
+  if (!_isEquation && _vector && _vectorIndex.isEmpty() && _vector->length() == ctx->sampleCount &&
+      i0 >= 0 && i0 + n <= ctx->sampleCount) {
+    // no interpolation needed: the samples are the block
+    memcpy(out, _vector->value() + i0, n*sizeof(double));
+  } else if (!_isEquation && !_vector && _scalar) {
+    const double c = _scalar->value();
+    for (int k = 0; k < n; ++k) {
+      out[k] = c;
+    }
+  } else {
+    Node::values(ctx, i0, n, out);
+  }
+}
+
+
+void Negation::values(Context *ctx, long i0, int n, double *out) {
+  _n->values(ctx, i0, n, out);
+  for (int k = 0; k < n; ++k) {
+    const double v = out[k];
+    out[k] = (v == v) ? -v : v;
+  }
+}
+
+
+void LogicalNot::values(Context *ctx, long i0, int n, double *out) {
+  _n->values(ctx, i0, n, out);
+  for (int k = 0; k < n; ++k) {
+    const double v = out[k];
+    out[k] = (v == v) ? (v == 0.0) : 1.0;
+  }
+}
+
+
+#define BlockValues(x, expr)                                 \
+  void x::values(Context *ctx, long i0, int n, double *out) { \
+    Q_ASSERT(n <= BlockSize);                                \
+    double rhs[BlockSize];                                   \
+    _left->values(ctx, i0, n, out);                          \
+    _right->values(ctx, i0, n, rhs);                         \
+    for (int k = 0; k < n; ++k) {                            \
+      const double l = out[k];                               \
+      const double r = rhs[k];                               \
+      out[k] = (expr);                                       \
+    }                                                        \
+  }
+
+BlockValues(Addition, l + r)
+BlockValues(Subtraction, l - r)
+BlockValues(Multiplication, l * r)
+BlockValues(Division, l / r)
+BlockValues(Modulo, fmod(l, r))
+BlockValues(Power, pow(l, r))
+BlockValues(BitwiseAnd, long(l) & long(r))
+BlockValues(BitwiseOr, long(l) | long(r))
+BlockValues(LogicalAnd, (l && r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(LogicalOr, (l || r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(LessThan, doubleLessThan(l, r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(LessThanEqual, doubleLessThanEqual(l, r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(GreaterThan, doubleGreaterThan(l, r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(GreaterThanEqual, doubleGreaterThanEqual(l, r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(EqualTo, doubleEqual(l, r) ? EQ_TRUE : EQ_FALSE)
+BlockValues(NotEqualTo, !doubleEqual(l, r) ? EQ_TRUE : EQ_FALSE)
+#undef BlockValues
+
 // vim: ts=2 sw=2 et
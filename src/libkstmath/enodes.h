@@ -36,6 +36,10 @@ namespace Equations {
    */
   KSTMATH_EXPORT double interpret(Kst::ObjectStore *store, const char *txt, bool *ok = 0L, int len = -1);
 
+  /*    Largest number of samples evaluated by one call to Node::values().
+   */
+  const int BlockSize = 256;
+
   class KSTMATH_EXPORT Context 
   {
     public:
@@ -60,6 +64,10 @@ namespace Equations {
       virtual bool collectObjects(Kst::VectorMap& v, Kst::ScalarMap& s, Kst::StringMap& t);
       virtual bool takeVectors(const Kst::VectorMap& c);
       virtual double value(Context*) = 0;
+      // Evaluates samples i0 .. i0 + n - 1 (n <= BlockSize) into out.  The
+      // default calls value() per sample; leaves and operators override it
+      // to work on the whole block at once.  ctx->x is not changed.
+      virtual void values(Context *ctx, long i0, int n, double *out);
       virtual void visit(NodeVisitor*);
       virtual Kst::Object::UpdateType update(Context *ctx);
       virtual QString text() const = 0;
@@ -151,6 +159,7 @@ namespace Equations {
 
       bool isConst();
       double value(Context*);
+      void values(Context *ctx, long i0, int n, double *out);
       QString text() const;
 
     protected:
@@ -166,6 +175,7 @@ namespace Equations {
 
       bool isConst();
       double value(Context*);
+      void values(Context *ctx, long i0, int n, double *out);
       const char *name() const;
       QString text() const;
 
@@ -183,6 +193,7 @@ namespace Equations {
 
       bool isConst();
       double value(Context*);
+      void values(Context *ctx, long i0, int n, double *out);
       bool collectObjects(Kst::VectorMap& v, Kst::ScalarMap& s, Kst::StringMap& t);
       bool takeVectors(const Kst::VectorMap& c);
       Kst::Object::UpdateType update(Context *ctx);
@@ -227,6 +238,7 @@ namespace Equations {
       ~Negation();
       bool isConst();
       double value(Context*);
+      void values(Context *ctx, long i0, int n, double *out);
       QString text() const;
       bool collectObjects(Kst::VectorMap& v, Kst::ScalarMap& s, Kst::StringMap& t);
 
@@ -240,6 +252,7 @@ namespace Equations {
       ~LogicalNot();
       bool isConst();
       double value(Context*);
+      void values(Context *ctx, long i0, int n, double *out);
       QString text() const;
 
     protected:
@@ -253,6 +266,7 @@ namespace Equations {
       ~x();                               \
       bool isConst();                     \
       double value(Context*);             \
+      void values(Context *ctx, long i0, int n, double *out); \
       QString text() const;               \
   };
 
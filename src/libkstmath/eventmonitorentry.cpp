@@ -46,11 +46,6 @@ const QString EventMonitorEntry::staticTypeTag = "eventmonitor";
 
 namespace {
   const int EventMonitorEventType = int(QEvent::User) + 2931;
-  class EventMonitorEvent : public QEvent {
-    public:
-      EventMonitorEvent(const QString& msg) : QEvent(QEvent::Type(EventMonitorEventType)), logMessage(msg) {}
-      QString logMessage;
-  };
 }
 
 //extern "C" int yyparse();
@@ -73,6 +68,8 @@ EventMonitorEntry::EventMonitorEntry(ObjectStore *store) : DataObject(store) {
   _pExpression = 0L;
 
   _typeString = staticTypeString;
+  // events fire whether or not anything shows them
+  setAlwaysUpdate(true);
   _type = "Event";
   _initializeShortName();
 
@@ -152,14 +149,32 @@ void EventMonitorEntry::internalUpdate() {
   VectorPtr xv = *_xVector;
   VectorPtr yv = *_yVector;
   int ns = 1;
+  int shift = 0;
 
   for (VectorMap::ConstIterator i = _vectorsUsed.constBegin(); i != _vectorsUsed.constEnd(); ++i) {
     ns = qMax(ns, i.value()->length());
+    shift = qMax(shift, i.value()->numShift());
+  }
+
+  // samples that scrolled out of the inputs take their results with them;
+  // a shrunken input is evaluated again from the start.
+  int numDone = qMax(0, _numDone - shift);
+  if (numDone > ns) {
+    numDone = 0;
   }
 
   double *rawValuesX = 0L;
   double *rawValuesY = 0L;
   if (xv && yv) {
+    // X is the sample index, so only the results in Y move with a shift
+    if (shift > 0 && numDone > 0) {
+      if (yv->length() >= shift + numDone) {
+        memmove(yv->value(), yv->value() + shift, numDone*sizeof(double));
+      } else {
+        numDone = 0;
+      }
+    }
+
     if (xv->resize(ns)) {
       rawValuesX = xv->value();
     }
@@ -175,21 +190,30 @@ void EventMonitorEntry::internalUpdate() {
 
   if (needToEvaluate()) {
     if (_pExpression) {
-      for (ctx.i = _numDone; ctx.i < ns; ++ctx.i) {
-        const double value = _pExpression->value(&ctx);
-        if (value != 0.0) { // The expression evaluates to true
-          log(ctx.i);
-          if (rawValuesX && rawValuesY) {
-            rawValuesX[ctx.i] = ctx.i;
-            rawValuesY[ctx.i] = 1.0;
+      // only the samples that arrived since the last update are evaluated,
+      // a block at a time.
+      double result[Equations::BlockSize];
+      int hitStart = -1;
+      for (int i0 = numDone; i0 < ns; i0 += Equations::BlockSize) {
+        const int n = qMin(Equations::BlockSize, ns - i0);
+        _pExpression->values(&ctx, i0, n, result);
+        for (int k = 0; k < n; ++k) {
+          const bool hit = (result[k] != 0.0); // The expression evaluates to true
+          if (hit && hitStart < 0) {
+            hitStart = i0 + k;
+          } else if (!hit && hitStart >= 0) {
+            queueHits(hitStart, i0 + k - 1);
+            hitStart = -1;
           }
-        } else {
           if (rawValuesX && rawValuesY) {
-            rawValuesX[ctx.i] = ctx.i;
-            rawValuesY[ctx.i] = 0.0;
+            rawValuesX[i0 + k] = i0 + k;
+            rawValuesY[i0 + k] = hit ? 1.0 : 0.0;
           }
         }
       }
+      if (hitStart >= 0) {
+        queueHits(hitStart, ns - 1);
+      }
       _numDone = ns;
       logImmediately();
     }
@@ -223,46 +247,59 @@ bool EventMonitorEntry::needToEvaluate() {
 }
 
 
-void EventMonitorEntry::logImmediately(bool sendEvent) {
-  const int arraySize = _indexArray.size();
-
-  if (arraySize > 0) {
-    QString logMessage;
-    QString rangeString;
-    bool makeRange = false;
-    int idx = 0;
-    int idxOld = 0;
-
-    for (int i = 0; i < arraySize; ++i) {
-      idx = _indexArray.at(i);
-      if (i == 0) {
-        rangeString.setNum(idx);
-      } else if (!makeRange && idx == idxOld + 1) {
-        makeRange = true;
-      } else if (makeRange && idx != idxOld + 1) {
-        rangeString = rangeString + QString(" - %1, %2").arg(idxOld).arg(idx);
-        makeRange = false;
-      } else if (idx != idxOld + 1) {
-        rangeString = rangeString + QString(", %1").arg(idx);
-      }
-      idxOld = idx;
-    }
+void EventMonitorEntry::queueHits(int first, int last) {
+  HitRange range;
+  range.first = first;
+  range.last = last;
+  if (!_hits.push(range)) {
+    _droppedHits.fetchAndAddRelaxed(last - first + 1);
+  }
+}
 
-    if (makeRange) {
-        rangeString = rangeString + QString(", %1").arg(idx);
-    }
 
-    if (_description.isEmpty()) {
-      logMessage = "Event Monitor: " + _event + ": " + rangeString;
+QString EventMonitorEntry::takeHitsMessage() {
+  QStringList ranges;
+  HitRange range;
+  while (_hits.pop(range)) {
+    if (range.first == range.last) {
+      ranges << QString::number(range.first);
     } else {
-      logMessage = "Event Monitor: " + _description + ": " + rangeString;
+      ranges << QString("%1 - %2").arg(range.first).arg(range.last);
     }
+  }
 
-    _indexArray.clear();
+  const int dropped = _droppedHits.fetchAndStoreRelaxed(0);
+  if (ranges.isEmpty() && dropped == 0) {
+    return QString();
+  }
+
+  QString rangeString = ranges.join(", ");
+  if (dropped > 0) {
+    if (!rangeString.isEmpty()) {
+      rangeString += ", ";
+    }
+    rangeString += tr("%n more sample(s)", "", dropped);
+  }
 
-    if (sendEvent) { // update thread
-      QApplication::postEvent(this, new EventMonitorEvent(logMessage));
-    } else { // GUI thread
+  if (_description.isEmpty()) {
+    return "Event Monitor: " + _event + ": " + rangeString;
+  } else {
+    return "Event Monitor: " + _description + ": " + rangeString;
+  }
+}
+
+
+void EventMonitorEntry::logImmediately(bool sendEvent) {
+  if (sendEvent) { // update thread
+    // one pending event drains everything queued until it is handled
+    if (!_hits.isEmpty() || _droppedHits.fetchAndAddRelaxed(0) > 0) {
+      if (_logPending.testAndSetOrdered(0, 1)) {
+        QApplication::postEvent(this, new QEvent(QEvent::Type(EventMonitorEventType)));
+      }
+    }
+  } else { // GUI thread
+    const QString logMessage = takeHitsMessage();
+    if (!logMessage.isEmpty()) {
       doLog(logMessage);
     }
   }
@@ -271,8 +308,9 @@ void EventMonitorEntry::logImmediately(bool sendEvent) {
 
 bool EventMonitorEntry::event(QEvent *e) {
     if (e->type() == EventMonitorEventType) {
+      _logPending.fetchAndStoreOrdered(0);
       readLock();
-      doLog(static_cast<EventMonitorEvent*>(e)->logMessage);
+      logImmediately(false);
       unlock();
       return true;
     }
@@ -304,10 +342,7 @@ void EventMonitorEntry::doLog(const QString& logMessage) const {
 
 
 void EventMonitorEntry::log(int idx) {
-  _indexArray.append(idx);
-  if (_indexArray.size() > 1000) {
-    logImmediately();
-  }
+  queueHits(idx, idx);
 }
 
 
@@ -20,6 +20,9 @@
 
 #include "dataobject.h"
 #include "debug.h"
+#include "boundedqueue.h"
+
+#include <QAtomicInt>
 
 namespace Equations {
   class Node;
@@ -88,13 +91,25 @@ class KSTMATH_EXPORT EventMonitorEntry : public DataObject {
     void doLog(const QString& logMessage) const;
 
   private:
+    // a run of consecutive samples for which the expression was true
+    struct HitRange {
+      int first;
+      int last;
+    };
+
     void logImmediately(bool sendEvent = true);
+    void queueHits(int first, int last);
+    QString takeHitsMessage();
 
     static const QString OUTXVECTOR;
     static const QString OUTYVECTOR;
 
     VectorMap _vectorsUsed;
-    QVector<int> _indexArray;
+    // hits travel from the update thread to the GUI thread through _hits;
+    // whatever does not fit is only counted.
+    BoundedQueue<HitRange, 256> _hits;
+    QAtomicInt _droppedHits;
+    QAtomicInt _logPending;
     QString _event;
     QString _description;
     QString _eMailRecipients;
@@ -19,17 +19,17 @@
 #include "math_kst.h"
 #include "objectstore.h"
 #include "plottickcalculator.h"
+#include "trace.h"
 
 
 
 #include <QImage>
 #include <QPainter>
 #include <QXmlStreamWriter>
+#include <QtConcurrentMap>
 
 #include <math.h>
 
-//#define BENCHMARK
-
 namespace Kst {
 
 const QString Image::staticTypeString = "Image";
@@ -37,6 +37,163 @@ const QString Image::staticTypeTag = "image";
 
 static const QLatin1String& THEMATRIX = QLatin1String("THEMATRIX");
 
+// Marching squares over the matrix cell centres for a single contour level.
+// Each crossed cell edge has a unique id, which lets the per-cell segments be
+// chained into polylines.  Instances are used concurrently (one level per
+// thread) and only read from the matrix.
+class ContourTracer {
+  public:
+    typedef QVector<QPolygonF> result_type;
+
+    explicit ContourTracer(const Matrix *m) : _m(m) {
+      _nX = m->xNumSteps();
+      _nY = m->yNumSteps();
+      _x0 = m->minX() + 0.5*m->xStepSize();
+      _y0 = m->minY() + 0.5*m->yStepSize();
+      _dx = m->xStepSize();
+      _dy = m->yStepSize();
+    }
+
+    QVector<QPolygonF> operator()(double level) const {
+      QVector<QPolygonF> paths;
+      if (_nX < 2 || _nY < 2) {
+        return paths;
+      }
+
+      // segments as pairs of edge ids
+      QVector<qint64> segs;
+      for (int i = 0; i < _nX - 1; ++i) {
+        for (int j = 0; j < _nY - 1; ++j) {
+          double zBL = z(i, j), zBR = z(i+1, j), zTR = z(i+1, j+1), zTL = z(i, j+1);
+          if (!isfinite(zBL) || !isfinite(zBR) || !isfinite(zTR) || !isfinite(zTL)) {
+            continue;
+          }
+          int index = (zBL > level ? 1 : 0) | (zBR > level ? 2 : 0) |
+                      (zTR > level ? 4 : 0) | (zTL > level ? 8 : 0);
+          if (index == 0 || index == 15) {
+            continue;
+          }
+          qint64 B = hEdge(i, j), T = hEdge(i, j+1);
+          qint64 L = vEdge(i, j), R = vEdge(i+1, j);
+          bool centreAbove = (zBL + zBR + zTR + zTL)*0.25 > level;
+          switch (index) {
+            case 1: case 14: addSegment(segs, L, B); break;
+            case 2: case 13: addSegment(segs, B, R); break;
+            case 3: case 12: addSegment(segs, L, R); break;
+            case 4: case 11: addSegment(segs, R, T); break;
+            case 6: case 9:  addSegment(segs, B, T); break;
+            case 7: case 8:  addSegment(segs, L, T); break;
+            case 5: // saddle: BL and TR above
+              if (centreAbove) {
+                addSegment(segs, L, T);
+                addSegment(segs, B, R);
+              } else {
+                addSegment(segs, L, B);
+                addSegment(segs, R, T);
+              }
+              break;
+            case 10: // saddle: BR and TL above
+              if (centreAbove) {
+                addSegment(segs, L, B);
+                addSegment(segs, R, T);
+              } else {
+                addSegment(segs, B, R);
+                addSegment(segs, L, T);
+              }
+              break;
+          }
+        }
+      }
+
+      // an edge is shared by at most two cells, so it joins at most two segments
+      int numSegs = segs.size()/2;
+      QHash<qint64, QPair<int, int> > edgeSegs;
+      edgeSegs.reserve(segs.size());
+      for (int s = 0; s < numSegs; ++s) {
+        for (int e = 0; e < 2; ++e) {
+          QHash<qint64, QPair<int, int> >::iterator it = edgeSegs.find(segs[2*s+e]);
+          if (it == edgeSegs.end()) {
+            edgeSegs.insert(segs[2*s+e], qMakePair(s, -1));
+          } else {
+            it.value().second = s;
+          }
+        }
+      }
+
+      QVector<bool> used(numSegs, false);
+      for (int s = 0; s < numSegs; ++s) {
+        if (used[s]) {
+          continue;
+        }
+        used[s] = true;
+        QPolygonF forward, backward;
+        forward << edgePoint(segs[2*s], level) << edgePoint(segs[2*s+1], level);
+        follow(segs, edgeSegs, used, segs[2*s+1], level, forward);
+        follow(segs, edgeSegs, used, segs[2*s], level, backward);
+        if (!backward.isEmpty()) {
+          QPolygonF path;
+          path.reserve(backward.size() + forward.size());
+          for (int k = backward.size() - 1; k >= 0; --k) {
+            path << backward[k];
+          }
+          path << forward;
+          paths.append(path);
+        } else {
+          paths.append(forward);
+        }
+      }
+      return paths;
+    }
+
+  private:
+    double z(int i, int j) const { return _m->Z(i*_nY + j); }
+    qint64 hEdge(int i, int j) const { return 2*(qint64(i)*_nY + j); }
+    qint64 vEdge(int i, int j) const { return 2*(qint64(i)*_nY + j) + 1; }
+
+    static void addSegment(QVector<qint64> &segs, qint64 a, qint64 b) {
+      segs << a << b;
+    }
+
+    // linear interpolation of the level crossing along an edge
+    QPointF edgePoint(qint64 edge, double level) const {
+      qint64 node = edge/2;
+      int i = int(node/_nY), j = int(node%_nY);
+      int i2 = i, j2 = j;
+      if (edge & 1) {
+        ++j2;
+      } else {
+        ++i2;
+      }
+      double za = z(i, j), zb = z(i2, j2);
+      double t = (zb != za) ? (level - za)/(zb - za) : 0.5;
+      return QPointF(_x0 + (i + t*(i2 - i))*_dx, _y0 + (j + t*(j2 - j))*_dy);
+    }
+
+    // walk unused segments starting at edge, appending their far ends to path
+    void follow(const QVector<qint64> &segs, const QHash<qint64, QPair<int, int> > &edgeSegs,
+                QVector<bool> &used, qint64 edge, double level, QPolygonF &path) const {
+      forever {
+        QPair<int, int> adjacent = edgeSegs.value(edge, qMakePair(-1, -1));
+        int next = -1;
+        if (adjacent.first >= 0 && !used[adjacent.first]) {
+          next = adjacent.first;
+        } else if (adjacent.second >= 0 && !used[adjacent.second]) {
+          next = adjacent.second;
+        }
+        if (next < 0) {
+          return;
+        }
+        used[next] = true;
+        edge = (segs[2*next] == edge) ? segs[2*next+1] : segs[2*next];
+        path << edgePoint(edge, level);
+      }
+    }
+
+    const Matrix *_m;
+    int _nX, _nY;
+    double _x0, _y0, _dx, _dy;
+};
+
 Image::Image(ObjectStore *store) : Relation(store) {
   _typeString = staticTypeString;
   _type = "Image";
@@ -44,6 +201,7 @@ Image::Image(ObjectStore *store) : Relation(store) {
 
   _hasContourMap = false;
   _hasColorMap = false;
+  _contourPathsDirty = true;
   setColorDefaults();
   setContourDefaults();
 
@@ -120,6 +278,7 @@ void Image::internalUpdate() {
 
     //update the contour lines
     if (hasContourMap()) {
+      QMutexLocker ml(&_contourLock);
       double min = mp->minValue(), max = mp->maxValue();
       double contourStep  = (max - min) / (double)(_numContourLines + 1);
       if (contourStep > 0) {
@@ -128,6 +287,7 @@ void Image::internalUpdate() {
           _contourLines.append(min + (i+1) * contourStep);
         }
       }
+      updateContourPaths(mp);
     }
 
     _redrawRequired = true;
@@ -222,6 +382,9 @@ void Image::changeToContourOnly(MatrixPtr in_matrix, int numContours,
   _hasColorMap = false;
   _hasContourMap = true;
 
+  QMutexLocker ml(&_contourLock);
+  _contourPathsDirty = true;
+  _redrawRequired = true;
 }
 
 
@@ -243,6 +406,9 @@ void Image::changeToColorAndContour(MatrixPtr in_matrix,
   _hasColorMap = true;
   _hasContourMap = true;
 
+  QMutexLocker ml(&_contourLock);
+  _contourPathsDirty = true;
+  _redrawRequired = true;
 }
 
 
@@ -265,18 +431,50 @@ void Image::matrixDimensions(double &x, double &y, double &width, double &height
 
 //this should check for duplicates
 bool Image::addContourLine(double line) {
+  QMutexLocker ml(&_contourLock);
   _contourLines.append(line);
+  _contourPathsDirty = true;
+  _redrawRequired = true;
   return true;
 }
 
 
 bool Image::removeContourLine(double line) {
+  QMutexLocker ml(&_contourLock);
+  _contourPathsDirty = true;
+  _redrawRequired = true;
   return _contourLines.removeAll(line);
 }
 
 
 void Image::clearContourLines() {
+  QMutexLocker ml(&_contourLock);
   _contourLines.clear();
+  _contourPathsDirty = true;
+  _redrawRequired = true;
+}
+
+
+// _contourLock is held.
+void Image::updateContourPaths(MatrixPtr mp) {
+  _contourPaths.clear();
+  _contourPathsDirty = false;
+  if (!mp || _contourLines.isEmpty()) {
+    return;
+  }
+
+  // levels are independent, so trace them concurrently
+  QList<QVector<QPolygonF> > levels =
+      QtConcurrent::blockingMapped<QList<QVector<QPolygonF> > >(_contourLines, ContourTracer(mp.data()));
+
+  bool variableWeight = _contourWeight < 0;
+  for (int k = 0; k < levels.count(); ++k) {
+    // + 1 because 0 and 1 are the same width
+    int lineWeight = variableWeight ? k + 1 : _contourWeight + 1;
+    foreach (const QPolygonF &points, levels.at(k)) {
+      _contourPaths.append(ContourPath(points, lineWeight));
+    }
+  }
 }
 
 
@@ -408,6 +606,7 @@ double Image::distanceToPoint(double xpos, double dx, double ypos) const {
 
 
 void Image::paintObjects(const CurveRenderContext& context) {
+  TRACE_SPAN_DETAIL("paint", "Image::paintObjects", Name());
   QPainter* p = context.painter;
 
   if (hasColorMap()) {
@@ -417,14 +616,16 @@ void Image::paintObjects(const CurveRenderContext& context) {
   if (hasContourMap()) {
     QColor lineColor = contourColor();
 
-    foreach(const CoutourLineDetails& lineDetails, _lines) {
-      p->setPen(QPen(lineColor, lineDetails._lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::MiterJoin));
-      p->drawLine(lineDetails._line);
+    foreach(const ContourPath& path, _lines) {
+      p->setPen(QPen(lineColor, path._lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::MiterJoin));
+      p->drawPolyline(path._points);
     }
   }
 }
 
 void Image::updatePaintObjects(const CurveRenderContext& context) {
+  TRACE_SPAN_DETAIL("paint", "Image::updatePaintObjects", Name());
+
   double Lx = context.Lx, Hx = context.Hx, Ly = context.Ly, Hy = context.Hy;
   double m_X = context.m_X, m_Y = context.m_Y, b_X = context.b_X, b_Y = context.b_Y;
   double x_max = context.x_max, y_max = context.y_max, x_min = context.x_min, y_min = context.y_min;
@@ -435,14 +636,6 @@ void Image::updatePaintObjects(const CurveRenderContext& context) {
   double x, y, width, height;
   double img_Lx_pix = 0, img_Ly_pix = 0, img_Hx_pix = 0, img_Hy_pix = 0;
 
-#ifdef BENCHMARK
-  QTime bench_time, benchtmp;
-  int b_1 = 0, b_2 = 0;
-  bench_time.start();
-  benchtmp.start();
-  int numberOfLinesDrawn = 0;
-#endif
-
   ImagePtr image = this;
 
   _image = QImage();
@@ -559,177 +752,35 @@ void Image::updatePaintObjects(const CurveRenderContext& context) {
         }
         _imageLocation = QPoint(d2i(img_Lx_pix), d2i(img_Ly_pix + 1));
       }
-#ifdef BENCHMARK
-    b_1 = benchtmp.elapsed();
-#endif
       //*******************************************************************
       // CONTOURS
       //*******************************************************************
-#ifndef CONTOUR_STEP
-#define CONTOUR_STEP 5
-#endif
-      //draw the contourmap
+      // the paths are traced in data coordinates when the matrix changes;
+      // here they only need to be mapped onto the plot.
       if (image->hasContourMap()) {
-        //QColor tempColor = image->contourColor();
-        bool variableWeight = image->contourWeight() < 0;
-        int lineWeight=1;
-        if (!variableWeight) {
-          // + 1 because 0 and 1 are the same width
-          lineWeight = image->contourWeight() + 1;
+        QMutexLocker ml(&_contourLock);
+        if (_contourPathsDirty) {
+          updateContourPaths(_inputMatrices[THEMATRIX]);
         }
-        // do the drawing for each contour line
-        QList<double> lines = image->contourLines();
-        QPoint lastPoint; // used to remember the previous point
-        bool hasPrevBottom = false;
-        MatrixPtr mp = _inputMatrices[THEMATRIX];
-        for (int k = 0; k < lines.count(); ++k) {
-          double lineK = lines[k];
-          if (variableWeight) {
-            // + 1 because 0 and 1 are the same width
-            lineWeight = k + 1;
-          }
-          int flImgHx = d2i(floor(img_Hx_pix));
-          int flImgHy = d2i(floor(img_Hy_pix));
-          int ceImgLy = d2i(ceil(img_Ly_pix));
-          for (int i = d2i(ceil(img_Lx_pix)); i + CONTOUR_STEP < flImgHx; i += CONTOUR_STEP) {
-            for (int j = d2i(ceil(img_Ly_pix)); j + CONTOUR_STEP < flImgHy; j += CONTOUR_STEP) {
-              // look at this group of 4 pixels and get the z values
-              double zTL, zTR, zBL, zBR;
-              double new_x_small = (i - b_X) / m_X, new_y_small = (j + 1 - b_Y) / m_Y;
-              double new_x_large = (i + CONTOUR_STEP - b_X) / m_X, new_y_large = (j+1+CONTOUR_STEP - b_Y) / m_Y;
-
-              if (xLog) {
-                new_x_small = pow(xLogBase, new_x_small);
-                new_x_large = pow(xLogBase, new_x_large);
-              }
-              if (yLog) {
-                new_y_small = pow(yLogBase, new_y_small);
-                new_y_large = pow(yLogBase, new_y_large);
-              }
-
-              zTL = mp->value(new_x_small, new_y_small, 0L);
-              zTR = mp->value(new_x_large, new_y_small, 0L);
-              zBL = mp->value(new_x_small, new_y_large, 0L);
-              zBR = mp->value(new_x_large, new_y_large, 0L);
-
-              // determine the lines to draw
-              int numPoints = 0;
-              bool passTop = false, passBottom = false, passLeft = false, passRight = false;
-              QPoint topPoint, bottomPoint, leftPoint, rightPoint;
-
-              // passes through the top
-              if (hasPrevBottom) {
-                topPoint = lastPoint;
-                ++numPoints;
-                passTop = true;
-              } else if (j == ceImgLy && ((lineK < zTR && lineK > zTL) || (lineK < zTL && lineK > zTR))) {
-                ++numPoints;
-                passTop = true;
-                topPoint.setX(int(((lineK - zTL)*CONTOUR_STEP + (zTR - zTL)*i) / (zTR - zTL)));
-                topPoint.setY(j);
-              }
-              hasPrevBottom = false;
-
-              // passes through the bottom
-              if ((lineK < zBR && lineK > zBL) || (lineK < zBL && lineK > zBR)) {
-                ++numPoints;
-                passBottom = true;
-                bottomPoint.setX(int(((lineK - zBL)*CONTOUR_STEP + (zBR - zBL)*i) / (zBR - zBL)));
-                bottomPoint.setY(j + CONTOUR_STEP);
-                if (j + 2*CONTOUR_STEP < flImgHy) {
-                  lastPoint = bottomPoint;
-                  hasPrevBottom = true;
-                }
-              }
-
-              // passes through the left
-              if ((lineK < zBL && lineK > zTL) || (lineK < zTL && lineK > zBL)) {
-                ++numPoints;
-                passLeft = true;
-                leftPoint.setY(int(((lineK - zTL)*CONTOUR_STEP + (zBL - zTL)*j) / (zBL - zTL)));
-                leftPoint.setX(i);
-              }
-
-              // passes through the right
-              if ((lineK < zBR && lineK > zTR) || (lineK < zTR && lineK > zBR)) {
-                ++numPoints;
-                passRight = true;
-                rightPoint.setY(int(((lineK - zTR)*CONTOUR_STEP + (zBR - zTR)*j) / (zBR - zTR)));
-                rightPoint.setX(i + CONTOUR_STEP);
-              }
-
-              if (numPoints == 4) {
-                // draw a cross
-                _lines.append(CoutourLineDetails(QLine(topPoint, bottomPoint), lineWeight));
-                _lines.append(CoutourLineDetails(QLine(rightPoint, leftPoint), lineWeight));
-#ifdef BENCHMARK
-  numberOfLinesDrawn += 2;
-#endif
-              } else if (numPoints == 3) {
-                // draw a V opening to non-intersecting side
-                if (!passTop) {
-                  _lines.append(CoutourLineDetails(QLine(leftPoint, bottomPoint), lineWeight));
-                  _lines.append(CoutourLineDetails(QLine(bottomPoint, rightPoint), lineWeight));
-                } else if (!passLeft) {
-                  _lines.append(CoutourLineDetails(QLine(topPoint, rightPoint), lineWeight));
-                  _lines.append(CoutourLineDetails(QLine(rightPoint, bottomPoint), lineWeight));
-                } else if (!passBottom) {
-                  _lines.append(CoutourLineDetails(QLine(leftPoint, topPoint), lineWeight));
-                  _lines.append(CoutourLineDetails(QLine(topPoint, rightPoint), lineWeight));
-                } else {
-                  _lines.append(CoutourLineDetails(QLine(topPoint, leftPoint), lineWeight));
-                  _lines.append(CoutourLineDetails(QLine(leftPoint, bottomPoint), lineWeight));
-                }
-#ifdef BENCHMARK
-  numberOfLinesDrawn += 2;
-#endif
-              } else if (numPoints == 2) {
-                // two points - connect them
-                QPoint point1, point2;
-                bool true1 = false;
-
-                if (passTop) {
-                  point1 = topPoint;
-                  true1 = true;
-                }
-                if (passBottom) {
-                  if (true1) {
-                    point2 = bottomPoint;
-                  } else {
-                    point1 = bottomPoint;
-                    true1 = true;
-                  }
-                }
-                if (passLeft) {
-                  if (true1) {
-                    point2 = leftPoint;
-                  } else {
-                    point1 = leftPoint;
-                  }
-                }
-                if (passRight) {
-                  point2 = rightPoint;
-                }
-                _lines.append(CoutourLineDetails(QLine(point1, point2), lineWeight));
-#ifdef BENCHMARK
-  ++numberOfLinesDrawn;
-#endif
-              }
+        _lines.reserve(_contourPaths.size());
+        foreach (const ContourPath& path, _contourPaths) {
+          QPolygonF points(path._points.size());
+          for (int k = 0; k < points.size(); ++k) {
+            double px = path._points.at(k).x();
+            double py = path._points.at(k).y();
+            if (xLog) {
+              px = logXLo(px, xLogBase);
+            }
+            if (yLog) {
+              py = logYLo(py, yLogBase);
             }
+            points[k] = QPointF(px * m_X + b_X, py * m_Y + b_Y);
           }
+          _lines.append(ContourPath(points, path._lineWidth));
         }
       }
     }
   }
-#ifdef BENCHMARK
-  b_2 = benchtmp.elapsed();
-  int i = bench_time.elapsed();
-  qDebug() << endl << "Plotting image " << (void *)this << ": " << i << "ms";
-  qDebug() << "         Without locks: " << b_2 << "ms";
-  qDebug() << " Number of lines drawn: " << numberOfLinesDrawn;
-  if (b_1 > 0)       qDebug() << "             Color Map: " << b_1 << "ms";
-  if (b_2 - b_1 > 0) qDebug() << "         Coutour Lines: " << (b_2 - b_1) << "ms" << endl;
-#endif
 }
 
 
@@ -22,17 +22,21 @@
 #include "labelinfo.h"
 
 #include <QHash>
+#include <QMutex>
+#include <QPolygonF>
 
 namespace Kst {
 
 class ObjectStore;
 
-class CoutourLineDetails {
+// A traced contour polyline.  Image keeps these in matrix (data) coordinates
+// and only maps them to pixels when the plot geometry changes.
+class ContourPath {
   public:
-    CoutourLineDetails() { }
-    CoutourLineDetails(QLine line, int width) { _line = line; _lineWidth = width; }
+    ContourPath() : _lineWidth(1) { }
+    ContourPath(const QPolygonF &points, int width) : _points(points), _lineWidth(width) { }
 
-  QLine _line;
+  QPolygonF _points;
   int _lineWidth;
 };
 
@@ -135,6 +139,8 @@ class KSTMATH_EXPORT Image : public Relation {
     //use these to set defaults when either is not used.
     void setColorDefaults();
     void setContourDefaults();
+    // trace _contourLines over the matrix with marching squares (data coordinates)
+    void updateContourPaths(MatrixPtr mp);
     Palette _pal;
     //upper and lower thresholds
     double _zUpper;
@@ -148,8 +154,13 @@ class KSTMATH_EXPORT Image : public Relation {
     QList<double> _contourLines;
     QColor _contourColor;
     int _contourWeight; //_contourWeight = -1 means variable weight
+    bool _contourPathsDirty;
 
-    QVector<CoutourLineDetails> _lines;
+    // guards the contour lines and paths: paint objects are built on the
+    // thread pool (see View::prepareRelations()), and rebuild dirty paths
+    QMutex _contourLock;
+    QVector<ContourPath> _contourPaths; // data coordinates, rebuilt on matrix update
+    QVector<ContourPath> _lines; // pixel coordinates, rebuilt on plot geometry change
     QImage _image;
     QPoint _imageLocation;
 };
@@ -22,6 +22,8 @@
 
 #include <qregexp.h>
 #include <qstring.h>
+#include <QCache>
+#include <QMutex>
 
 using namespace Label;
 
@@ -704,4 +706,21 @@ Parsed *Label::parse(const QString& txt, bool interpret, bool interpretNewLine)
 }
 
 
+static QMutex parseCacheLock;
+static QCache<QString, QSharedPointer<const Parsed> > parseCache(2000);
+
+QSharedPointer<const Parsed> Label::parseCached(const QString& txt, bool interpret, bool interpretNewLine) {
+  const QString key = QLatin1String(interpret ? "1" : "0") + QLatin1String(interpretNewLine ? "1" : "0") + txt;
+
+  QMutexLocker ml(&parseCacheLock);
+  QSharedPointer<const Parsed> *cached = parseCache.object(key);
+  if (cached) {
+    return *cached;
+  }
+  QSharedPointer<const Parsed> parsed(parse(txt, interpret, interpretNewLine));
+  parseCache.insert(key, new QSharedPointer<const Parsed>(parsed));
+  return parsed;
+}
+
+
 // vim: ts=2 sw=2 et
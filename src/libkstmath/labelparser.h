@@ -22,6 +22,7 @@
 #include "kstmath_export.h"
 
 #include <qcolor.h>
+#include <QSharedPointer>
 
 typedef quint16 KstLJustifyType;
 typedef quint8  KstLHJustifyType;
@@ -83,6 +84,11 @@ namespace Label {
 
 
   extern KSTMATH_EXPORT Parsed *parse(const QString&, bool interpret = true, bool interpretNewLine = true);
+
+  // As parse(), through a process-wide cache of the most recently used
+  // texts.  The tree is shared and must not be modified; it holds the names
+  // of scalars and strings rather than their values, so it stays valid.
+  extern KSTMATH_EXPORT QSharedPointer<const Parsed> parseCached(const QString&, bool interpret = true, bool interpretNewLine = true);
 }
 
 #endif
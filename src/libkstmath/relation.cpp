@@ -75,12 +75,16 @@ void Relation::deleteDependents() {
 
 
 void Relation::paint(const CurveRenderContext& context) {
+  preparePaint(context);
+  paintObjects(context);
+}
+
+
+void Relation::preparePaint(const CurveRenderContext& context) {
   if (redrawRequired(context) || _redrawRequired) {
     updatePaintObjects(context);
     _redrawRequired = false;
   }
-
-  paintObjects(context);
 }
 
 
@@ -99,7 +103,8 @@ bool Relation::redrawRequired(const CurveRenderContext& context) {
       (_contextDetails.yLog == context.yLog) &&  
       (_contextDetails.xLogBase == context.xLogBase) &&  
       (_contextDetails.yLogBase == context.yLogBase) &&  
-      (_contextDetails.penWidth == context.penWidth) ) {
+      (_contextDetails.penWidth == context.penWidth) &&
+      (_contextDetails.window == context.window) ) {
     return false;
   } else {
     _contextDetails.Lx = context.Lx;
@@ -117,6 +122,7 @@ bool Relation::redrawRequired(const CurveRenderContext& context) {
     _contextDetails.xLogBase = context.xLogBase;
     _contextDetails.yLogBase = context.yLogBase;
     _contextDetails.penWidth = context.penWidth;
+    _contextDetails.window = context.window;
     return true;
   }
 }
@@ -162,6 +168,16 @@ qint64 Relation::maxInputSerialOfLastChange() const {
   return maxSerial;
 }
 
+QList<Object*> Relation::inputObjects() const {
+  QList<Object*> inputs;
+  foreach (const PrimitivePtr &P, inputPrimitives()) {
+    if (P) {
+      inputs.append(P.data());
+    }
+  }
+  return inputs;
+}
+
 void Relation::writeLockInputsAndOutputs() const {
   Q_ASSERT(myLockStatus() == KstRWLock::WRITELOCKED);
 
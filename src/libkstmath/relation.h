@@ -68,6 +68,7 @@ class CurveRenderContext {
     bool xLog, yLog;
     double xLogBase, yLogBase;
     int penWidth;
+    QRect window;
   };
 
 class ObjectStore;
@@ -121,6 +122,11 @@ class KSTMATH_EXPORT Relation : public Object {
     // render this curve
     void paint(const CurveRenderContext& context);
 
+    // rebuild the paint objects for context if they are out of date.  This
+    // doesn't touch context.painter, so it can run outside the GUI thread
+    // while the GUI thread waits for it; paint() then only draws.
+    void preparePaint(const CurveRenderContext& context);
+
     virtual void paintObjects(const CurveRenderContext& context) = 0;
     virtual void updatePaintObjects(const CurveRenderContext& context) = 0;
 
@@ -174,6 +180,7 @@ class KSTMATH_EXPORT Relation : public Object {
 
     virtual qint64 minInputSerial() const;
     virtual qint64 maxInputSerialOfLastChange() const;
+    virtual QList<Object*> inputObjects() const;
 
     CurveHintList *_curveHints;
     QString _typeString, _type;
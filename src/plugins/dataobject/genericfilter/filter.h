@@ -29,6 +29,13 @@ public:
     S& in            // input address
   );
   void NextTimeStep();                  // update
+  int GetOrder() const;                 // size of the state vector
+  void GetState(                        // copy of the state vector
+    S* state         // GetOrder() values
+  ) const;
+  void SetState(                        // restore a copy of the state vector
+    const S* state   // GetOrder() values
+  );
  ~filter();                            // destructor
 private:
   // pointer on input
@@ -96,6 +103,21 @@ template<class S> void filter<S>::NextTimeStep()
   x[0] = Nz[0]*(*in) - Dz[0]*out;
 }
 //------------------------------------------------------------------------------
+template<class S> int filter<S>::GetOrder() const
+{
+  return n;
+}
+//------------------------------------------------------------------------------
+template<class S> void filter<S>::GetState(S* state) const
+{
+  for (int i=0; i<n; i++) state[i]=x[i];
+}
+//------------------------------------------------------------------------------
+template<class S> void filter<S>::SetState(const S* state)
+{
+  for (int i=0; i<n; i++) x[i]=state[i];
+}
+//------------------------------------------------------------------------------
 template<class S> filter<S>::~filter()
 {
   // deallocate memory used by state vector
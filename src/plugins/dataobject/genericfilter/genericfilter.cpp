@@ -143,11 +143,12 @@ class ConfigGenericFilterPlugin : public Kst::DataObjectConfigWidget, public Ui_
 
 
 GenericFilterSource::GenericFilterSource(Kst::ObjectStore *store)
-: Kst::BasicPlugin(store) {
+: Kst::BasicPlugin(store), _filter(0L), _filterIn(0.0), _checkpointIndex(0) {
 }
 
 
 GenericFilterSource::~GenericFilterSource() {
+  delete _filter;
 }
 
 
@@ -217,20 +218,59 @@ bool GenericFilterSource::algorithm() {
   outputVector->resize(length, true);
 
   // Create filter
-  filter<double> theFilter(Num,Den,DeltaT);
-  double in = 0.0;
-  theFilter.ConnectTo(in); // the filter keeps a pointer to "in"
-  theFilter.Reset();
-  for (int i=0; i<length; i++) {
-    in = inputVector->value()[i];
-    theFilter.NextTimeStep();
-    outputVector->value()[i] = theFilter.out;
+  delete _filter;
+  _filter = new filter<double>(Num,Den,DeltaT);
+  _filter->ConnectTo(_filterIn); // the filter keeps a pointer to "in"
+  _filter->Reset();
+  _checkpoint.resize(_filter->GetOrder());
+  _filter->GetState(_checkpoint.data());
+  _checkpointIndex = 0;
+  filterFrom(0, length);
+
+  return true;
+}
+
+
+bool GenericFilterSource::algorithmAppend(int &from) {
+  Kst::VectorPtr inputVector = _inputVectors[VECTOR_IN];
+  Kst::VectorPtr outputVector = _outputVectors[VECTOR_OUT];
+
+  // the filter can only be rewound as far as the saved state
+  if (!_filter || from < _checkpointIndex || outputVector->length() < _checkpointIndex) {
+    return false;
   }
 
+  int length = inputVector->length();
+  outputVector->resize(length, false);
+
+  _filter->SetState(_checkpoint.data());
+  from = _checkpointIndex;
+  filterFrom(from, length);
+
   return true;
 }
 
 
+// Runs the filter over samples from..length-1, starting from its current
+// state, and saves the state a few frames worth of samples before the end.
+void GenericFilterSource::filterFrom(int from, int length) {
+  const int rewind = 4096;
+  Kst::VectorPtr inputVector = _inputVectors[VECTOR_IN];
+  Kst::VectorPtr outputVector = _outputVectors[VECTOR_OUT];
+
+  const int checkpoint = qMax(from, length - rewind);
+  for (int i=from; i<length; i++) {
+    if (i == checkpoint) {
+      _filter->GetState(_checkpoint.data());
+      _checkpointIndex = i;
+    }
+    _filterIn = inputVector->value()[i];
+    _filter->NextTimeStep();
+    outputVector->value()[i] = _filter->out;
+  }
+}
+
+
 Kst::VectorPtr GenericFilterSource::vector() const {
   return _inputVectors[VECTOR_IN];
 }
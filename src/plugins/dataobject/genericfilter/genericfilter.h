@@ -14,10 +14,13 @@
 #define GENERICFILTERPLUGIN_H
 
 #include <QFile>
+#include <QVector>
 
 #include <basicplugin.h>
 #include <dataobjectplugin.h>
 
+template<class S> class filter;
+
 class GenericFilterSource : public Kst::BasicPlugin {
   Q_OBJECT
 
@@ -33,6 +36,7 @@ class GenericFilterSource : public Kst::BasicPlugin {
 
     void setupOutputs();
     virtual bool algorithm();
+    virtual bool algorithmAppend(int &from);
 
     virtual QStringList inputVectorList() const;
     virtual QStringList inputScalarList() const;
@@ -49,7 +53,16 @@ class GenericFilterSource : public Kst::BasicPlugin {
 
   friend class Kst::ObjectStore;
 
+  private:
+    void filterFrom(int from, int length);
 
+    // kept between updates, so new samples continue where the last update
+    // left off; the state is saved a little before the end, as the samples
+    // of the last frame are often read again
+    filter<double> *_filter;
+    double _filterIn;
+    QVector<double> _checkpoint;
+    int _checkpointIndex;
 };
 
 
@@ -26,7 +26,6 @@ bool interpolate(Kst::VectorPtr xVector,
   int iLengthData;
   int iLengthInterp;
   bool bReturn = false;
-  double* pResult[1];
 
   iLengthData = xVector->length();
   if (yVector->length() < iLengthData) {
@@ -37,16 +36,9 @@ bool interpolate(Kst::VectorPtr xVector,
   if (iLengthInterp > 0) {
     if (yOutVector->length() != iLengthInterp) {
       yOutVector->resize(iLengthInterp, true);
-      pResult[0] = (double*)realloc( yOutVector->value(), iLengthInterp * sizeof( double ) );
-    } else {
-      pResult[0] = yOutVector->value();
     }
 
-    if (pResult[0] != NULL) {
-
-      for (int i = 0; i < iLengthInterp; ++i) {
-        yOutVector->value()[i] = pResult[0][i];
-      }
+    if (yOutVector->length() == iLengthInterp) {
 
       pInterp = gsl_interp_alloc( pType, iLengthData );
       if (pInterp != NULL) {
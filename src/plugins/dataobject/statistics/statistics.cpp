@@ -17,6 +17,8 @@
 #include "objectstore.h"
 #include "ui_statisticsconfig.h"
 
+#include <algorithm>
+
 static const QString& VECTOR_IN = "Vector In";
 static const QString& SCALAR_OUT_MEAN = "Mean";
 static const QString& SCALAR_OUT_MINIMUM = "Minimum";
@@ -27,6 +29,38 @@ static const QString& SCALAR_OUT_MEDIAN = "Median";
 static const QString& SCALAR_OUT_ABSOLUTE_DEVIATION = "Absolute deviation";
 static const QString& SCALAR_OUT_SKEWNESS = "Skewness";
 static const QString& SCALAR_OUT_KURTOSIS = "Kurtosis";
+static const QString& SCALAR_OUT_QUANTILE = "Quantile %1";
+
+
+// Parses a comma or space separated list of fractions in [0, 1].
+static QList<double> parseQuantiles(const QString &text) {
+  QList<double> quantiles;
+  foreach (const QString &field, text.split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts)) {
+    bool ok;
+    double q = field.toDouble(&ok);
+    if (ok && q >= 0.0 && q <= 1.0 && !quantiles.contains(q)) {
+      quantiles.append(q);
+    }
+  }
+  qSort(quantiles);
+  return quantiles;
+}
+
+
+static QString quantilesToString(const QList<double> &quantiles) {
+  QStringList fields;
+  foreach (double q, quantiles) {
+    fields << QString::number(q);
+  }
+  return fields.join(", ");
+}
+
+
+// Index of quantile q among n sorted samples; q = 0.5 gives the (upper)
+// median, pData[n/2] as the statistics plugin has always reported.
+static inline int quantileIndex(double q, int n) {
+  return qBound(0, int(q * n), n - 1);
+}
 
 class ConfigWidgetStatisticsPlugin : public Kst::DataObjectConfigWidget, public Ui_StatisticsConfig {
   public:
@@ -44,29 +78,33 @@ class ConfigWidgetStatisticsPlugin : public Kst::DataObjectConfigWidget, public
     void setupSlots(QWidget* dialog) {
       if (dialog) {
         connect(_vector, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
+        connect(_quantiles, SIGNAL(textChanged(const QString&)), dialog, SIGNAL(modified()));
       }
     }
 
     Kst::VectorPtr selectedVector() { return _vector->selectedVector(); };
     void setSelectedVector(Kst::VectorPtr vector) { return _vector->setSelectedVector(vector); };
 
+    QList<double> quantiles() { return parseQuantiles(_quantiles->text()); }
+    void setQuantiles(const QList<double> &quantiles) { _quantiles->setText(quantilesToString(quantiles)); }
+
     virtual void setupFromObject(Kst::Object* dataObject) {
       if (StatisticsSource* source = static_cast<StatisticsSource*>(dataObject)) {
         setSelectedVector(source->vector());
+        setQuantiles(source->quantiles());
       }
     }
 
     virtual bool configurePropertiesFromXml(Kst::ObjectStore *store, QXmlStreamAttributes& attrs) {
       Q_UNUSED(store);
-      Q_UNUSED(attrs);
 
       bool validTag = true;
 
-//       QStringRef av;
-//       av = attrs.value("value");
-//       if (!av.isNull()) {
-//         _configValue = QVariant(av.toString()).toBool();
-//       }
+      QStringRef av;
+      av = attrs.value("quantiles");
+      if (!av.isNull()) {
+        _quantiles->setText(av.toString());
+      }
 
       return validTag;
     }
@@ -76,6 +114,7 @@ class ConfigWidgetStatisticsPlugin : public Kst::DataObjectConfigWidget, public
       if (_cfg) {
         _cfg->beginGroup("Statistics DataObject Plugin");
         _cfg->setValue("Input Vector", _vector->selectedVector()->Name());
+        _cfg->setValue("Quantiles", _quantiles->text());
         _cfg->endGroup();
       }
     }
@@ -89,6 +128,7 @@ class ConfigWidgetStatisticsPlugin : public Kst::DataObjectConfigWidget, public
         if (vector) {
           setSelectedVector(vector);
         }
+        _quantiles->setText(_cfg->value("Quantiles").toString());
         _cfg->endGroup();
       }
     }
@@ -116,10 +156,28 @@ QString StatisticsSource::_automaticDescriptiveName() const {
 void StatisticsSource::change(Kst::DataObjectConfigWidget *configWidget) {
   if (ConfigWidgetStatisticsPlugin* config = static_cast<ConfigWidgetStatisticsPlugin*>(configWidget)) {
     setInputVector(VECTOR_IN, config->selectedVector());
+    setQuantiles(config->quantiles());
   }
 }
 
 
+void StatisticsSource::setQuantiles(const QList<double> &quantiles) {
+  // drop the outputs of quantiles that are no longer requested
+  foreach (double q, _quantiles) {
+    if (!quantiles.contains(q)) {
+      QString type = SCALAR_OUT_QUANTILE.arg(q);
+      if (_outputScalars.contains(type)) {
+        Kst::ScalarPtr s = _outputScalars.take(type);
+        if (store()) {
+          store()->removeObject(s);
+        }
+      }
+    }
+  }
+  _quantiles = quantiles;
+}
+
+
 void StatisticsSource::setupOutputs() {
   setOutputScalar(SCALAR_OUT_MEAN, "");
   setOutputScalar(SCALAR_OUT_MINIMUM, "");
@@ -151,12 +209,10 @@ bool StatisticsSource::algorithm() {
     return false;
   }
 
-  double* pCopy;
   double dMean = 0.0;
   double dMedian = 0.0;
   double dStandardDeviation = 0.0;
   double dTotal = 0.0;
-  double dSquaredTotal = 0.0;
   double dMinimum = 0.0;
   double dMaximum = 0.0;
   double dVariance = 0.0;
@@ -165,21 +221,39 @@ bool StatisticsSource::algorithm() {
   double dKurtosis = 0.0;
   int iLength = inputVector->length();
 
+  // the selection below reorders its input, so work on a copy, filled
+  // while computing the extrema and the sum.
+  _scratch.resize(iLength);
+  double *pCopy = _scratch.data();
+  const double *pData = inputVector->value();
+
+  dMinimum = dMaximum = pData[0];
   for (int i=0; i<iLength; i++) {
-    if (i == 0 || inputVector->value()[i] < dMinimum) {
-      dMinimum = inputVector->value()[i];
+    const double d = pData[i];
+    pCopy[i] = d;
+    if (d < dMinimum) {
+      dMinimum = d;
     }
-    if (i == 0 || inputVector->value()[i] > dMaximum) {
-      dMaximum = inputVector->value()[i];
+    if (d > dMaximum) {
+      dMaximum = d;
     }
-    dTotal += inputVector->value()[i];
-    dSquaredTotal += inputVector->value()[i] * inputVector->value()[i];
+    dTotal += d;
   }
-
   dMean = dTotal / (double)iLength;
+
+  // all central moments in one pass
+  double dM2 = 0.0, dM3 = 0.0, dM4 = 0.0;
+  for (int i=0; i<iLength; i++) {
+    const double d = pCopy[i] - dMean;
+    const double d2 = d * d;
+    dAbsoluteDeviation += fabs(d);
+    dM2 += d2;
+    dM3 += d2 * d;
+    dM4 += d2 * d2;
+  }
+
   if (iLength > 1) {
-    dVariance  = 1.0 / ( (double)iLength - 1.0 );
-    dVariance *= dSquaredTotal - ( dTotal * dTotal / (double)iLength ); 
+    dVariance = dM2 / ( (double)iLength - 1.0 );
     if (dVariance > 0.0) {
       dStandardDeviation = sqrt( dVariance );
     } else {
@@ -188,26 +262,48 @@ bool StatisticsSource::algorithm() {
     }
   }
 
-  for (int i=0; i<iLength; i++) {
-    dAbsoluteDeviation += fabs( inputVector->value()[i] - dMean );
-    dSkewness               += pow( inputVector->value()[i] - dMean, 3.0 );
-    dKurtosis               += pow( inputVector->value()[i] - dMean, 4.0 );
-  }
+  const double dVar = dStandardDeviation * dStandardDeviation;
   dAbsoluteDeviation /= (double)iLength;
-  dSkewness                 /= (double)iLength * pow( dStandardDeviation, 3.0 );
-  dKurtosis                 /= (double)iLength * pow( dStandardDeviation, 4.0 );
-  dKurtosis                 -= 3.0;
+  dSkewness = dM3 / ( (double)iLength * dVar * dStandardDeviation );
+  dKurtosis = dM4 / ( (double)iLength * dVar * dVar ) - 3.0;
 
   /*
-  sort by phase...
+  median and quantiles by selection rather than sorting: nth_element is an
+  introselect, linear on average and without the worst case on sorted data.
+  Quantiles are ascending, so each selection only needs to search the part
+  above the previous one.
   */
-  pCopy = (double*)calloc( iLength, sizeof( double ) );
-  if (pCopy != NULL) {
-    memcpy( pCopy, inputVector->value(), iLength * sizeof( double ) );
-    quicksort( pCopy, 0, iLength-1 );
-    dMedian = pCopy[ iLength / 2 ];
+  const int iMedian = quantileIndex(0.5, iLength);
+  std::nth_element(pCopy, pCopy + iMedian, pCopy + iLength);
+  dMedian = pCopy[iMedian];
+
+  double *pLow = pCopy;
+  double *pHigh = pCopy + iMedian;
+  foreach (double q, _quantiles) {
+    const int iQ = quantileIndex(q, iLength);
+    double dQ;
+    if (iQ == iMedian) {
+      dQ = dMedian;
+    } else if (iQ < iMedian) {
+      if (pLow <= pCopy + iQ) {
+        std::nth_element(pLow, pCopy + iQ, pCopy + iMedian);
+        pLow = pCopy + iQ + 1;
+      }
+      dQ = pCopy[iQ];
+    } else {
+      if (pHigh < pCopy + iQ) {
+        std::nth_element(pHigh + 1, pCopy + iQ, pCopy + iLength);
+      }
+      dQ = pCopy[iQ];
+      pHigh = pCopy + iQ;
+    }
 
-    free( pCopy );
+    const QString type = SCALAR_OUT_QUANTILE.arg(q);
+    if (!_outputScalars.contains(type)) {
+      setOutputScalar(type, "");
+      _outputScalars[type]->writeLock();
+    }
+    _outputScalars[type]->setValue(dQ);
   }
 
   outputScalarMean->setValue(dMean);
@@ -224,45 +320,6 @@ bool StatisticsSource::algorithm() {
 }
 
 
-void StatisticsSource::swap( double* pData, int iOne, int iTwo) {
-  double dTemp;
-
-  dTemp = pData[iOne];
-  pData[iOne] = pData[iTwo];
-  pData[iTwo] = dTemp;
-}
-
-
-void StatisticsSource::quicksort( double* pData, int iLeft, int iRight) {
-
-  double dVal = pData[iRight];
-  int i = iLeft - 1;
-  int j = iRight;
-
-  if (iRight <= iLeft) {
-    return;
-  }
-
-  while (1) {
-    while (pData[++i] < dVal) {
-    }
-
-    while(dVal < pData[--j]) {
-      if (j == iLeft) {
-        break;
-      }
-    }
-    if (i >= j) {
-      break;
-    }
-    swap( pData, i, j );
-  }
-  swap( pData, i, iRight );
-  quicksort( pData, iLeft, i-1 );
-  quicksort( pData, i+1, iRight );
-}
-
-
 Kst::VectorPtr StatisticsSource::vector() const {
   return _inputVectors[VECTOR_IN];
 }
@@ -308,8 +365,9 @@ QStringList StatisticsSource::outputStringList() const {
 
 
 void StatisticsSource::saveProperties(QXmlStreamWriter &s) {
-  Q_UNUSED(s);
-//   s.writeAttribute("value", _configValue);
+  if (!_quantiles.isEmpty()) {
+    s.writeAttribute("quantiles", quantilesToString(_quantiles));
+  }
 }
 
 
@@ -327,6 +385,7 @@ Kst::DataObject *StatisticsPlugin::create(Kst::ObjectStore *store, Kst::DataObje
       object->setupOutputs();
       object->setInputVector(VECTOR_IN, config->selectedVector());
     }
+    object->setQuantiles(config->quantiles());
 
     object->setPluginName(pluginName());
 
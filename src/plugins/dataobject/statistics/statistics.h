@@ -16,6 +16,7 @@
 #define STATISTICSPLUGIN_H
 
 #include <QFile>
+#include <QVector>
 
 #include <basicplugin.h>
 #include <dataobjectplugin.h>
@@ -42,13 +43,17 @@ class StatisticsSource : public Kst::BasicPlugin {
 
     virtual void saveProperties(QXmlStreamWriter &s);
 
+    // extra quantiles (fractions in [0, 1]) published as "Quantile <q>" scalars
+    QList<double> quantiles() const { return _quantiles; }
+    void setQuantiles(const QList<double> &quantiles);
+
   protected:
     StatisticsSource(Kst::ObjectStore *store);
     ~StatisticsSource();
 
   private:
-    void swap( double* pData, int iOne, int iTwo );
-    void quicksort( double* pData, int iLeft, int iRight );
+    QList<double> _quantiles;
+    QVector<double> _scratch; // reused between updates for the selection
 
   friend class Kst::ObjectStore;
 
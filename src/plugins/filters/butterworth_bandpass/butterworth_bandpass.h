@@ -20,6 +20,8 @@
 #include <basicplugin.h>
 #include <dataobjectplugin.h>
 
+class PassFilterState;
+
 class FilterButterworthBandPassSource : public Kst::BasicPlugin {
   Q_OBJECT
 
@@ -45,10 +47,18 @@ class FilterButterworthBandPassSource : public Kst::BasicPlugin {
 
     virtual void saveProperties(QXmlStreamWriter &s);
 
+    // refilter only the tail of the input when samples are appended
+    bool incremental() const { return _incremental; }
+    void setIncremental(bool incremental) { _incremental = incremental; }
+
   protected:
     FilterButterworthBandPassSource(Kst::ObjectStore *store);
     ~FilterButterworthBandPassSource();
 
+  private:
+    PassFilterState *_filterState;
+    bool _incremental;
+
   friend class Kst::ObjectStore;
 
 
@@ -51,6 +51,7 @@ class ConfigFilterButterworthBandStopPlugin : public Kst::DataObjectConfigWidget
         connect(_scalarOrder, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarRate, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarBandwidth, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
+        connect(_incremental, SIGNAL(toggled(bool)), dialog, SIGNAL(modified()));
       }
     }
 
@@ -78,26 +79,29 @@ class ConfigFilterButterworthBandStopPlugin : public Kst::DataObjectConfigWidget
     Kst::ScalarPtr selectedBandwidthScalar() { return _scalarBandwidth->selectedScalar(); };
     void setSelectedBandwidthScalar(Kst::ScalarPtr scalar) { return _scalarBandwidth->setSelectedScalar(scalar); };
 
+    bool incremental() { return _incremental->isChecked(); }
+    void setIncremental(bool incremental) { _incremental->setChecked(incremental); }
+
     virtual void setupFromObject(Kst::Object* dataObject) {
       if (FilterButterworthBandStopSource* source = static_cast<FilterButterworthBandStopSource*>(dataObject)) {
         setSelectedVector(source->vector());
         setSelectedOrderScalar(source->orderScalar());
         setSelectedRateScalar(source->rateScalar());
         setSelectedBandwidthScalar(source->bandwidthScalar());
+        setIncremental(source->incremental());
       }
     }
 
     virtual bool configurePropertiesFromXml(Kst::ObjectStore *store, QXmlStreamAttributes& attrs) {
       Q_UNUSED(store);
-      Q_UNUSED(attrs);
 
       bool validTag = true;
 
-//       QStringRef av;
-//       av = attrs.value("value");
-//       if (!av.isNull()) {
-//         _configValue = QVariant(av.toString()).toBool();
-//       }
+      QStringRef av;
+      av = attrs.value("incremental");
+      if (!av.isNull()) {
+        setIncremental(QVariant(av.toString()).toBool());
+      }
 
       return validTag;
     }
@@ -110,6 +114,7 @@ class ConfigFilterButterworthBandStopPlugin : public Kst::DataObjectConfigWidget
         _cfg->setValue("Order Scalar", _scalarOrder->selectedScalar()->Name());
         _cfg->setValue("Central Frequency / Sample Rate Scalar", _scalarRate->selectedScalar()->Name());
         _cfg->setValue("Band width Scalar", _scalarBandwidth->selectedScalar()->Name());
+        _cfg->setValue("Incremental", _incremental->isChecked());
         _cfg->endGroup();
       }
     }
@@ -132,6 +137,8 @@ class ConfigFilterButterworthBandStopPlugin : public Kst::DataObjectConfigWidget
         scalarName = _cfg->value("Band width Scalar").toString();
         _scalarBandwidth->setSelectedScalar(scalarName);
 
+        setIncremental(_cfg->value("Incremental", false).toBool());
+
         _cfg->endGroup();
       }
     }
@@ -143,11 +150,12 @@ class ConfigFilterButterworthBandStopPlugin : public Kst::DataObjectConfigWidget
 
 
 FilterButterworthBandStopSource::FilterButterworthBandStopSource(Kst::ObjectStore *store)
-: Kst::BasicPlugin(store) {
+: Kst::BasicPlugin(store), _filterState(new PassFilterState), _incremental(false) {
 }
 
 
 FilterButterworthBandStopSource::~FilterButterworthBandStopSource() {
+  delete _filterState;
 }
 
 
@@ -162,6 +170,7 @@ void FilterButterworthBandStopSource::change(Kst::DataObjectConfigWidget *config
     setInputScalar(SCALAR_ORDER_IN, config->selectedOrderScalar());
     setInputScalar(SCALAR_RATE_IN, config->selectedRateScalar());
     setInputScalar(SCALAR_BANDWIDTH_IN, config->selectedBandwidthScalar());
+    setIncremental(config->incremental());
   }
 }
 
@@ -214,7 +223,7 @@ bool FilterButterworthBandStopSource::algorithm() {
   label_info.name = tr("Filtered %1").arg(label_info.name);
   outputVector->setLabelInfo(label_info);
 
-  return kst_pass_filter( inputVector, scalars, outputVector);
+  return kst_pass_filter( inputVector, scalars, outputVector, *_filterState, _incremental );
 }
 
 
@@ -272,8 +281,7 @@ QStringList FilterButterworthBandStopSource::outputStringList() const {
 
 
 void FilterButterworthBandStopSource::saveProperties(QXmlStreamWriter &s) {
-  Q_UNUSED(s);
-//   s.writeAttribute("value", _configValue);
+  s.writeAttribute("incremental", QVariant(_incremental).toString());
 }
 
 
@@ -295,6 +303,7 @@ Kst::DataObject *ButterworthBandStopPlugin::create(Kst::ObjectStore *store, Kst:
       object->setupOutputs();
       object->setInputVector(VECTOR_IN, config->selectedVector());
     }
+    object->setIncremental(config->incremental());
 
     object->setPluginName(pluginName());
 
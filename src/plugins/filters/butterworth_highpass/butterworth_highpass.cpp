@@ -47,6 +47,7 @@ class ConfigFilterButterworthHighPassPlugin : public Kst::DataObjectConfigWidget
         connect(_vector, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarOrder, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarCutoff, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
+        connect(_incremental, SIGNAL(toggled(bool)), dialog, SIGNAL(modified()));
       }
     }
 
@@ -71,25 +72,28 @@ class ConfigFilterButterworthHighPassPlugin : public Kst::DataObjectConfigWidget
     Kst::ScalarPtr selectedCutoffScalar() { return _scalarCutoff->selectedScalar(); };
     void setSelectedCutoffScalar(Kst::ScalarPtr scalar) { return _scalarCutoff->setSelectedScalar(scalar); };
 
+    bool incremental() { return _incremental->isChecked(); }
+    void setIncremental(bool incremental) { _incremental->setChecked(incremental); }
+
     virtual void setupFromObject(Kst::Object* dataObject) {
       if (FilterButterworthHighPassSource* source = static_cast<FilterButterworthHighPassSource*>(dataObject)) {
         setSelectedVector(source->vector());
         setSelectedOrderScalar(source->orderScalar());
         setSelectedCutoffScalar(source->cutoffScalar());
+        setIncremental(source->incremental());
       }
     }
 
     virtual bool configurePropertiesFromXml(Kst::ObjectStore *store, QXmlStreamAttributes& attrs) {
       Q_UNUSED(store);
-      Q_UNUSED(attrs);
 
       bool validTag = true;
 
-//       QStringRef av;
-//       av = attrs.value("value");
-//       if (!av.isNull()) {
-//         _configValue = QVariant(av.toString()).toBool();
-//       }
+      QStringRef av;
+      av = attrs.value("incremental");
+      if (!av.isNull()) {
+        setIncremental(QVariant(av.toString()).toBool());
+      }
 
       return validTag;
     }
@@ -101,6 +105,7 @@ class ConfigFilterButterworthHighPassPlugin : public Kst::DataObjectConfigWidget
         _cfg->setValue("Input Vector", _vector->selectedVector()->Name());
         _cfg->setValue("Order Scalar", _scalarOrder->selectedScalar()->Name());
         _cfg->setValue("Cutoff / Spacing Scalar", _scalarCutoff->selectedScalar()->Name());
+        _cfg->setValue("Incremental", _incremental->isChecked());
         _cfg->endGroup();
       }
     }
@@ -120,6 +125,8 @@ class ConfigFilterButterworthHighPassPlugin : public Kst::DataObjectConfigWidget
         scalarName = _cfg->value("Cutoff / Spacing Scalar").toString();
         _scalarCutoff->setSelectedScalar(scalarName);
 
+        setIncremental(_cfg->value("Incremental", false).toBool());
+
         _cfg->endGroup();
       }
     }
@@ -131,11 +138,12 @@ class ConfigFilterButterworthHighPassPlugin : public Kst::DataObjectConfigWidget
 
 
 FilterButterworthHighPassSource::FilterButterworthHighPassSource(Kst::ObjectStore *store)
-: Kst::BasicPlugin(store) {
+: Kst::BasicPlugin(store), _filterState(new PassFilterState), _incremental(false) {
 }
 
 
 FilterButterworthHighPassSource::~FilterButterworthHighPassSource() {
+  delete _filterState;
 }
 
 
@@ -149,6 +157,7 @@ void FilterButterworthHighPassSource::change(Kst::DataObjectConfigWidget *config
     setInputVector(VECTOR_IN, config->selectedVector());
     setInputScalar(SCALAR_ORDER_IN, config->selectedOrderScalar());
     setInputScalar(SCALAR_CUTOFF_IN, config->selectedCutoffScalar());
+    setIncremental(config->incremental());
   }
 }
 
@@ -193,7 +202,7 @@ bool FilterButterworthHighPassSource::algorithm() {
   label_info.name = tr("Filtered %1").arg(label_info.name);
   outputVector->setLabelInfo(label_info);
 
-  return kst_pass_filter( inputVector, scalars, outputVector);
+  return kst_pass_filter( inputVector, scalars, outputVector, *_filterState, _incremental );
 }
 
 
@@ -245,8 +254,7 @@ QStringList FilterButterworthHighPassSource::outputStringList() const {
 
 
 void FilterButterworthHighPassSource::saveProperties(QXmlStreamWriter &s) {
-  Q_UNUSED(s);
-//   s.writeAttribute("value", _configValue);
+  s.writeAttribute("incremental", QVariant(_incremental).toString());
 }
 
 
@@ -267,6 +275,7 @@ Kst::DataObject *ButterworthHighPassPlugin::create(Kst::ObjectStore *store, Kst:
       object->setupOutputs();
       object->setInputVector(VECTOR_IN, config->selectedVector());
     }
+    object->setIncremental(config->incremental());
 
     object->setPluginName(pluginName());
 
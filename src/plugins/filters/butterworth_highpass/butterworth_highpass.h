@@ -20,6 +20,8 @@
 #include <basicplugin.h>
 #include <dataobjectplugin.h>
 
+class PassFilterState;
+
 class FilterButterworthHighPassSource : public Kst::BasicPlugin {
   Q_OBJECT
 
@@ -44,10 +46,18 @@ class FilterButterworthHighPassSource : public Kst::BasicPlugin {
 
     virtual void saveProperties(QXmlStreamWriter &s);
 
+    // refilter only the tail of the input when samples are appended
+    bool incremental() const { return _incremental; }
+    void setIncremental(bool incremental) { _incremental = incremental; }
+
   protected:
     FilterButterworthHighPassSource(Kst::ObjectStore *store);
     ~FilterButterworthHighPassSource();
 
+  private:
+    PassFilterState *_filterState;
+    bool _incremental;
+
   friend class Kst::ObjectStore;
 
 
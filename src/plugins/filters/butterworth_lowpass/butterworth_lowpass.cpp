@@ -48,6 +48,7 @@ class ConfigFilterButterworthLowPassPlugin : public Kst::DataObjectConfigWidget,
         connect(_vector, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarOrder, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
         connect(_scalarCutoff, SIGNAL(selectionChanged(QString)), dialog, SIGNAL(modified()));
+        connect(_incremental, SIGNAL(toggled(bool)), dialog, SIGNAL(modified()));
       }
     }
 
@@ -72,25 +73,28 @@ class ConfigFilterButterworthLowPassPlugin : public Kst::DataObjectConfigWidget,
     Kst::ScalarPtr selectedCutoffScalar() { return _scalarCutoff->selectedScalar(); };
     void setSelectedCutoffScalar(Kst::ScalarPtr scalar) { return _scalarCutoff->setSelectedScalar(scalar); };
 
+    bool incremental() { return _incremental->isChecked(); }
+    void setIncremental(bool incremental) { _incremental->setChecked(incremental); }
+
     virtual void setupFromObject(Kst::Object* dataObject) {
       if (FilterButterworthLowPassSource* source = static_cast<FilterButterworthLowPassSource*>(dataObject)) {
         setSelectedVector(source->vector());
         setSelectedOrderScalar(source->orderScalar());
         setSelectedCutoffScalar(source->cutoffScalar());
+        setIncremental(source->incremental());
       }
     }
 
     virtual bool configurePropertiesFromXml(Kst::ObjectStore *store, QXmlStreamAttributes& attrs) {
       Q_UNUSED(store);
-      Q_UNUSED(attrs);
 
       bool validTag = true;
 
-//       QStringRef av;
-//       av = attrs.value("value");
-//       if (!av.isNull()) {
-//         _configValue = QVariant(av.toString()).toBool();
-//       }
+      QStringRef av;
+      av = attrs.value("incremental");
+      if (!av.isNull()) {
+        setIncremental(QVariant(av.toString()).toBool());
+      }
 
       return validTag;
     }
@@ -102,6 +106,7 @@ class ConfigFilterButterworthLowPassPlugin : public Kst::DataObjectConfigWidget,
         _cfg->setValue("Input Vector", _vector->selectedVector()->Name());
         _cfg->setValue("Order Scalar", _scalarOrder->selectedScalar()->Name());
         _cfg->setValue("Cutoff / Spacing Scalar", _scalarCutoff->selectedScalar()->Name());
+        _cfg->setValue("Incremental", _incremental->isChecked());
         _cfg->endGroup();
       }
     }
@@ -121,6 +126,8 @@ class ConfigFilterButterworthLowPassPlugin : public Kst::DataObjectConfigWidget,
         scalarName = _cfg->value("Cutoff / Spacing Scalar").toString();
         _scalarCutoff->setSelectedScalar(scalarName);
 
+        setIncremental(_cfg->value("Incremental", false).toBool());
+
         _cfg->endGroup();
       }
     }
@@ -132,11 +139,12 @@ class ConfigFilterButterworthLowPassPlugin : public Kst::DataObjectConfigWidget,
 
 
 FilterButterworthLowPassSource::FilterButterworthLowPassSource(Kst::ObjectStore *store)
-: Kst::BasicPlugin(store) {
+: Kst::BasicPlugin(store), _filterState(new PassFilterState), _incremental(false) {
 }
 
 
 FilterButterworthLowPassSource::~FilterButterworthLowPassSource() {
+  delete _filterState;
 }
 
 
@@ -150,6 +158,7 @@ void FilterButterworthLowPassSource::change(Kst::DataObjectConfigWidget *configW
     setInputVector(VECTOR_IN, config->selectedVector());
     setInputScalar(SCALAR_ORDER_IN, config->selectedOrderScalar());
     setInputScalar(SCALAR_CUTOFF_IN, config->selectedCutoffScalar());
+    setIncremental(config->incremental());
   }
 }
 
@@ -188,7 +197,7 @@ bool FilterButterworthLowPassSource::algorithm() {
   Kst::LabelInfo label_info = inputVector->labelInfo();
   label_info.name = tr("Filtered %1").arg(label_info.name);
   outputVector->setLabelInfo(label_info);
-  return kst_pass_filter( inputVector, scalars, outputVector);
+  return kst_pass_filter( inputVector, scalars, outputVector, *_filterState, _incremental );
 }
 
 
@@ -240,8 +249,7 @@ QStringList FilterButterworthLowPassSource::outputStringList() const {
 
 
 void FilterButterworthLowPassSource::saveProperties(QXmlStreamWriter &s) {
-  Q_UNUSED(s);
-//   s.writeAttribute("value", _configValue);
+  s.writeAttribute("incremental", QVariant(_incremental).toString());
 }
 
 
@@ -262,6 +270,7 @@ Kst::DataObject *ButterworthLowPassPlugin::create(Kst::ObjectStore *store, Kst::
       object->setupOutputs();
       object->setInputVector(VECTOR_IN, config->selectedVector());
     }
+    object->setIncremental(config->incremental());
 
     object->setPluginName(pluginName());
 
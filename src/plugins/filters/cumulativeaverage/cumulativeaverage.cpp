@@ -168,6 +168,29 @@ bool CumulativeAverageSource::algorithm() {
 }
 
 
+bool CumulativeAverageSource::algorithmAppend(int &from) {
+  Kst::VectorPtr inputVector = _inputVectors[VECTOR_IN];
+  Kst::VectorPtr outputVector;
+  if (_outputVectors.contains(VECTOR_OUT)) {
+    outputVector = _outputVectors[VECTOR_OUT];
+  } else {
+    outputVector = _outputVectors.values().at(0);
+  }
+
+  // the average up to 'from' is still in the output
+  if (from < 1 || outputVector->length() < from) {
+    return false;
+  }
+  outputVector->resize(inputVector->length(), false);
+
+  for (int i = from; i < inputVector->length(); ++i) {
+    outputVector->value()[i] = (inputVector->value()[i] + (i * outputVector->value()[i-1])) / (i+1);
+  }
+
+  return true;
+}
+
+
 Kst::VectorPtr CumulativeAverageSource::vector() const {
   return _inputVectors[VECTOR_IN];
 }
@@ -34,6 +34,7 @@ class CumulativeAverageSource : public Kst::BasicPlugin {
 
     void setupOutputs();
     virtual bool algorithm();
+    virtual bool algorithmAppend(int &from);
 
     virtual QStringList inputVectorList() const;
     virtual QStringList inputScalarList() const;
@@ -180,6 +180,30 @@ bool CumulativeSumSource::algorithm() {
 }
 
 
+bool CumulativeSumSource::algorithmAppend(int &from) {
+  Kst::VectorPtr inputVector = _inputVectors[VECTOR_IN];
+  Kst::ScalarPtr inputScalar = _inputScalars[SCALAR_IN];
+  Kst::VectorPtr outputVector;
+  if (_outputVectors.contains(VECTOR_OUT)) {
+    outputVector = _outputVectors[VECTOR_OUT];
+  } else {
+    outputVector = _outputVectors.values().at(0);
+  }
+
+  // the sum up to 'from' is still in the output
+  if (from < 1 || outputVector->length() < from) {
+    return false;
+  }
+  outputVector->resize(inputVector->length(), false);
+
+  for (int i = from; i < inputVector->length(); i++) {
+    outputVector->value()[i] = inputVector->value()[i]*inputScalar->value() + outputVector->value()[i-1];
+  }
+
+  return true;
+}
+
+
 Kst::VectorPtr CumulativeSumSource::vector() const {
   return _inputVectors[VECTOR_IN];
 }
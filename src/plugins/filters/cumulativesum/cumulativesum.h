@@ -35,6 +35,7 @@ class CumulativeSumSource : public Kst::BasicPlugin {
 
     void setupOutputs();
     virtual bool algorithm();
+    virtual bool algorithmAppend(int &from);
 
     virtual QStringList inputVectorList() const;
     virtual QStringList inputScalarList() const;
@@ -180,6 +180,29 @@ bool DifferentiationSource::algorithm() {
 }
 
 
+bool DifferentiationSource::algorithmAppend(int &from) {
+  Kst::VectorPtr inputVector = _inputVectors[VECTOR_IN];
+  Kst::ScalarPtr inputScalar = _inputScalars[SCALAR_IN];
+  Kst::VectorPtr outputVector = _outputVectors[VECTOR_OUT];
+
+  if (inputScalar->value() == 0 || inputVector->length() < 2 || outputVector->length() < from) {
+    return false;
+  }
+
+  // the point before 'from' looks ahead at the first changed sample
+  from = qMax(0, from - 1);
+  outputVector->resize(inputVector->length(), false);
+
+  int i = from;
+  for (; i < inputVector->length()-1; i++) {
+      outputVector->value()[i] = (inputVector->value()[i+1] - inputVector->value()[i]) / inputScalar->value();
+  }
+
+  outputVector->value()[i] = (inputVector->value()[i] - inputVector->value()[i-1]) / inputScalar->value();
+  return true;
+}
+
+
 Kst::VectorPtr DifferentiationSource::vector() const {
   return _inputVectors[VECTOR_IN];
 }
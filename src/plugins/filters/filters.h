@@ -24,86 +24,319 @@
 #include <gsl/gsl_fft_real.h>
 #include <gsl/gsl_fft_halfcomplex.h>
 
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QVector>
+
 #include "vector.h"
 #include "scalar.h"
 
 double filter_calculate( double dFreqValue, Kst::ScalarList scalars );
 
+
+//
+// GSL wavetables, workspace and padded buffer for one transform length.
+// Plans are shared between all pass filters; the workspace and buffer are
+// scratch space, so a plan must be locked while it is used.
+//
+class FilterFFTPlan {
+  public:
+    explicit FilterFFTPlan( int iLength ) : length( iLength ) {
+      real = gsl_fft_real_wavetable_alloc( length );
+      hc = gsl_fft_halfcomplex_wavetable_alloc( length );
+      work = gsl_fft_real_workspace_alloc( length );
+    }
+
+    ~FilterFFTPlan() {
+      if( work != NULL ) {
+        gsl_fft_real_workspace_free( work );
+      }
+      if( hc != NULL ) {
+        gsl_fft_halfcomplex_wavetable_free( hc );
+      }
+      if( real != NULL ) {
+        gsl_fft_real_wavetable_free( real );
+      }
+    }
+
+    bool isValid() const { return real != NULL && hc != NULL && work != NULL; }
+
+    const int length;
+    gsl_fft_real_wavetable* real;
+    gsl_fft_halfcomplex_wavetable* hc;
+    gsl_fft_real_workspace* work;
+    QVector<double> buffer;
+    QMutex mutex;
+
+  private:
+    Q_DISABLE_COPY(FilterFFTPlan)
+};
+
+typedef QSharedPointer<FilterFFTPlan> FilterFFTPlanPtr;
+
+
+//
+// returns the cached plan for the given length, creating it if needed.
+// Only the most recently used lengths are kept.
+//
+FilterFFTPlanPtr filter_fft_plan( int iLength ) {
+  static const int iMaxPlans = 8;
+  static QMutex cacheMutex;
+  static QList<FilterFFTPlanPtr> cache; // most recently used first
+
+  QMutexLocker locker( &cacheMutex );
+  for( int i=0; i<cache.size(); i++ ) {
+    if( cache.at(i)->length == iLength ) {
+      if( i > 0 ) {
+        cache.move( i, 0 );
+      }
+      return cache.first();
+    }
+  }
+
+  FilterFFTPlanPtr plan( new FilterFFTPlan( iLength ) );
+  if( !plan->isValid() ) {
+    return FilterFFTPlanPtr();
+  }
+  cache.prepend( plan );
+  while( cache.size() > iMaxPlans ) {
+    cache.removeLast();
+  }
+  return plan;
+}
+
+
+//
+// Per filter state kept between updates: the frequency responses for the
+// current scalar values, and what the incremental (overlap-save) pass needs
+// to know about the previous update.
+//
+class PassFilterState {
+  public:
+    PassFilterState() : iOverlap( -1 ), iInputLength( 0 ), dLastInput( 0.0 ) { }
+
+    QVector<double> scalarValues;          // scalars the responses are valid for
+    QHash<int, QVector<double> > responses; // filter_calculate() per bin, by padded length
+    int iOverlap;      // kernel half width in samples, 0 if unusable, -1 if unknown
+    int iInputLength;  // input length at the previous update
+    double dLastInput; // last input sample at the previous update
+};
+
+
+//
+// drops everything cached in state if the filter scalars changed.
+//
+void pass_filter_check_scalars( PassFilterState& state, const Kst::ScalarList& scalars ) {
+  QVector<double> values( scalars.size() );
+  for( int i=0; i<scalars.size(); i++ ) {
+    values[i] = scalars.at(i)->value();
+  }
+  if( values != state.scalarValues ) {
+    state.scalarValues = values;
+    state.responses.clear();
+    state.iOverlap = -1;
+    state.iInputLength = 0;
+  }
+}
+
+
+//
+// the frequency response for a transform of the given length.
+//
+const double* pass_filter_response( PassFilterState& state, int iLength, const Kst::ScalarList& scalars ) {
+  QVector<double>& response = state.responses[iLength];
+  if( response.size() != iLength ) {
+    response.resize( iLength );
+    for( int i=0; i<iLength; i++ ) {
+      response[i] = filter_calculate( 0.5 * (double)i / (double)iLength, scalars );
+    }
+  }
+  return response.constData();
+}
+
+
+//
+// round up to the nearest power of 2...
+//
+int pass_filter_padded_length( int iLength ) {
+  return (int)pow( 2.0, ceil( log10( (double)iLength ) / log10( 2.0 ) ) );
+}
+
+
+//
+// filters iLength samples of pIn into pOut, padding the transform with at
+// least iMinPadding samples of linear extrapolation back to the first sample.
+//
+bool pass_filter_block(
+  const double* pIn,
+  int iLength,
+  int iMinPadding,
+  double* pOut,
+  PassFilterState& state,
+  const Kst::ScalarList& scalars) {
+
+  int iLengthPadded = pass_filter_padded_length( iLength + iMinPadding );
+  FilterFFTPlanPtr plan = filter_fft_plan( iLengthPadded );
+  if( !plan ) {
+    return false;
+  }
+
+  const double* pResponse = pass_filter_response( state, iLengthPadded, scalars );
+
+  QMutexLocker locker( &plan->mutex );
+  plan->buffer.resize( iLengthPadded );
+  double* pPadded = plan->buffer.data();
+
+  memcpy( pPadded, pIn, iLength * sizeof( double ) );
+
+  //
+  // linear extrapolation on the padded values...
+  //
+  for( int i=iLength; i<iLengthPadded; i++ ) {
+    pPadded[i] = pIn[iLength-1] - (double)( i - iLength + 1 ) * ( pIn[iLength-1] - pIn[0] ) / (double)( iLengthPadded - iLength );
+  }
+
+  //
+  // calculate the FFT...
+  //
+  if( gsl_fft_real_transform( pPadded, 1, iLengthPadded, plan->real, plan->work ) ) {
+    return false;
+  }
+
+  //
+  // apply the filter...
+  //
+  for( int i=0; i<iLengthPadded; i++ ) {
+    pPadded[i] *= pResponse[i];
+  }
+
+  //
+  // calculate the inverse FFT...
+  //
+  if( gsl_fft_halfcomplex_inverse( pPadded, 1, iLengthPadded, plan->hc, plan->work ) ) {
+    return false;
+  }
+  memcpy( pOut, pPadded, iLength * sizeof( double ) );
+
+  return true;
+}
+
+
+//
+// the half width of the filter kernel for a transform of the given length:
+// beyond it the impulse response stays below 1e-9 of its peak.  Returns 0
+// if the kernel does not decay within a quarter of the transform.
+//
+int pass_filter_overlap( PassFilterState& state, int iLength, const Kst::ScalarList& scalars ) {
+  FilterFFTPlanPtr plan = filter_fft_plan( iLength );
+  if( !plan ) {
+    return 0;
+  }
+
+  const double* pResponse = pass_filter_response( state, iLength, scalars );
+
+  QMutexLocker locker( &plan->mutex );
+  plan->buffer.resize( iLength );
+  double* pKernel = plan->buffer.data();
+
+  //
+  // the transform of a unit impulse is 1 in every real slot and 0 in every
+  // imaginary slot of the half complex array...
+  //
+  pKernel[0] = pResponse[0];
+  for( int i=1; i<iLength; i++ ) {
+    pKernel[i] = ( i % 2 == 1 ) ? pResponse[i] : 0.0;
+  }
+  if( gsl_fft_halfcomplex_inverse( pKernel, 1, iLength, plan->hc, plan->work ) ) {
+    return 0;
+  }
+
+  double dPeak = 0.0;
+  for( int i=0; i<=iLength/2; i++ ) {
+    dPeak = qMax( dPeak, fabs( pKernel[i] ) );
+  }
+
+  int iOverlap = iLength/2;
+  while( iOverlap > 0 && fabs( pKernel[iOverlap] ) <= 1.0e-9 * dPeak && fabs( pKernel[iLength - iOverlap] ) <= 1.0e-9 * dPeak ) {
+    iOverlap--;
+  }
+
+  return ( iOverlap < iLength/4 ) ? iOverlap + 1 : 0;
+}
+
+
+//
+// Zero phase pass filter of vector into outVector.
+//
+// With bIncremental set, and when the input only grew since the previous
+// update, only the tail is refiltered, overlap-save style: the block starts
+// a kernel width before the first output that can have changed, and the
+// outputs of that leading overlap are discarded.  Outputs within a kernel
+// width of the end are provisional either way, and are redone by the next
+// pass as more samples arrive.
+//
 bool kst_pass_filter(
   Kst::VectorPtr vector,
   Kst::ScalarList scalars,
-  Kst::VectorPtr outVector) {
-
-  gsl_fft_real_wavetable* real;
-  gsl_fft_real_workspace* work;
-  gsl_fft_halfcomplex_wavetable* hc;
-  double* pPadded;
-  double dFreqValue;
-  int iLengthData;
-  int iLengthDataPadded;
-  bool bReturn = false;
-  int iStatus;
-  int i;
-  
-  if( scalars.at(1)->value() > 0.0 ) {
-    iLengthData = vector->length();
-    
-    if( iLengthData > 0 ) {
-      //
-      // round up to the nearest power of 2...
-      //
-      iLengthDataPadded = (int)pow( 2.0, ceil( log10( (double)iLengthData ) / log10( 2.0 ) ) );
-      pPadded = (double*)malloc( iLengthDataPadded * sizeof( double ) );
-      if( pPadded != 0L ) {
-        outVector->resize(iLengthData);
-
-        real = gsl_fft_real_wavetable_alloc( iLengthDataPadded );
-        if( real != NULL ) {
-          work = gsl_fft_real_workspace_alloc( iLengthDataPadded );
-          if( work != NULL ) {
-            memcpy( pPadded, vector->value(), iLengthData * sizeof( double ) );
-
-            //
-            // linear extrapolation on the padded values...
-            //
-            for( i=iLengthData; i<iLengthDataPadded; i++ ) {
-              pPadded[i] = vector->value()[iLengthData-1] - (double)( i - iLengthData + 1 ) * ( vector->value()[iLengthData-1] - vector->value()[0] ) / (double)( iLengthDataPadded - iLengthData );
-            }
-            
-            //
-            // calculate the FFT...
-            //
-            iStatus = gsl_fft_real_transform( pPadded, 1, iLengthDataPadded, real, work );
-
-            if( !iStatus ) {
-              //
-              // apply the filter...
-              //
-              for( i=0; i<iLengthDataPadded; i++ ) {
-                dFreqValue = 0.5 * (double)i / (double)iLengthDataPadded;
-                pPadded[i] *= filter_calculate( dFreqValue, scalars );
-              }
-
-              hc = gsl_fft_halfcomplex_wavetable_alloc( iLengthDataPadded );
-              if( hc != NULL ) {
-                //
-                // calculate the inverse FFT...
-                //
-                iStatus = gsl_fft_halfcomplex_inverse( pPadded, 1, iLengthDataPadded, hc, work );
-                if( !iStatus ) {
-                  memcpy( outVector->value(), pPadded, iLengthData * sizeof( double ) );
-                  bReturn = true;
-                }
-                gsl_fft_halfcomplex_wavetable_free( hc );
-              }
-            }
-            gsl_fft_real_workspace_free( work );
-          }
-          gsl_fft_real_wavetable_free( real );
-        }
-        free( pPadded );
+  Kst::VectorPtr outVector,
+  PassFilterState& state,
+  bool bIncremental) {
+
+  if( scalars.at(1)->value() <= 0.0 ) {
+    return false;
+  }
+
+  int iLengthData = vector->length();
+  if( iLengthData <= 0 ) {
+    return false;
+  }
+
+  pass_filter_check_scalars( state, scalars );
+
+  const double* pData = vector->value();
+  int iPrevLength = state.iInputLength;
+
+  if( bIncremental &&
+      state.iOverlap > 0 &&
+      iPrevLength > 0 &&
+      iLengthData > iPrevLength &&
+      vector->numShift() == 0 &&
+      outVector->length() == iPrevLength &&
+      pData[iPrevLength-1] == state.dLastInput ) {
+    int iOverlap = state.iOverlap;
+    int iFirstOut = iPrevLength - iOverlap;
+    int iBlockStart = iFirstOut - iOverlap;
+
+    if( iBlockStart > 0 && 2 * ( iLengthData - iBlockStart ) < iLengthData ) {
+      QVector<double> block( iLengthData - iBlockStart );
+
+      if( pass_filter_block( pData + iBlockStart, block.size(), iOverlap, block.data(), state, scalars ) ) {
+        outVector->resize( iLengthData, false );
+        memcpy( outVector->value() + iFirstOut, block.constData() + iOverlap, ( iLengthData - iFirstOut ) * sizeof( double ) );
+        state.iInputLength = iLengthData;
+        state.dLastInput = pData[iLengthData-1];
+        return true;
       }
     }
   }
-  return bReturn;
+
+  //
+  // filter the whole vector...
+  //
+  outVector->resize( iLengthData );
+  if( !pass_filter_block( pData, iLengthData, 0, outVector->value(), state, scalars ) ) {
+    state.iInputLength = 0;
+    return false;
+  }
+
+  if( bIncremental && state.iOverlap < 0 ) {
+    state.iOverlap = pass_filter_overlap( state, pass_filter_padded_length( iLengthData ), scalars );
+  }
+  state.iInputLength = iLengthData;
+  state.dLastInput = pData[iLengthData-1];
+
+  return true;
 }
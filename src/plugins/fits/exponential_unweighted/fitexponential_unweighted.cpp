@@ -203,6 +203,19 @@ void function_derivative( double dX, double* pdParameters, double* pdDerivatives
 
 
 bool FitExponentialUnweightedSource::algorithm() {
+  return fit(false);
+}
+
+
+bool FitExponentialUnweightedSource::algorithmAppend(int &from) {
+  // samples were only added: start from the previous fit, which changes
+  // all of the outputs
+  from = 0;
+  return fit(true);
+}
+
+
+bool FitExponentialUnweightedSource::fit(bool warmStart) {
   Kst::VectorPtr inputVectorX = _inputVectors[VECTOR_IN_X];
   Kst::VectorPtr inputVectorY = _inputVectors[VECTOR_IN_Y];
 
@@ -223,7 +236,7 @@ bool FitExponentialUnweightedSource::algorithm() {
 
   bReturn = kstfit_nonlinear( inputVectorX, inputVectorY,
                               outputVectorYFitted, outputVectorYResiduals, outputVectorYParameters,
-                              outputVectorYCovariance, outputScalar );
+                              outputVectorYCovariance, outputScalar, warmStart );
   return bReturn;
 }
 
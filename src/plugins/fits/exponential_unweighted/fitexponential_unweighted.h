@@ -33,6 +33,7 @@ class FitExponentialUnweightedSource : public Kst::BasicPlugin {
 
     void setupOutputs();
     virtual bool algorithm();
+    virtual bool algorithmAppend(int &from);
 
     virtual QStringList inputVectorList() const;
     virtual QStringList inputScalarList() const;
@@ -51,6 +52,9 @@ class FitExponentialUnweightedSource : public Kst::BasicPlugin {
 
   friend class Kst::ObjectStore;
 
+  private:
+    bool fit(bool warmStart);
+
 
 };
 
@@ -247,6 +247,19 @@ void function_derivative( double x, double P[], double dFdP[] ) {
 }
 
 bool FitGaussianUnweightedSource::algorithm() {
+  return fit(false);
+}
+
+
+bool FitGaussianUnweightedSource::algorithmAppend(int &from) {
+  // samples were only added: start from the previous fit, which changes
+  // all of the outputs
+  from = 0;
+  return fit(true);
+}
+
+
+bool FitGaussianUnweightedSource::fit(bool warmStart) {
   Kst::VectorPtr inputVectorX = _inputVectors[VECTOR_IN_X];
   Kst::VectorPtr inputVectorY = _inputVectors[VECTOR_IN_Y];
 
@@ -268,7 +281,7 @@ bool FitGaussianUnweightedSource::algorithm() {
 
   bReturn = kstfit_nonlinear( inputVectorX, inputVectorY,
                               outputVectorYFitted, outputVectorYResiduals, outputVectorYParameters,
-                              outputVectorYCovariance, outputScalar );
+                              outputVectorYCovariance, outputScalar, warmStart );
   return bReturn;
 }
 
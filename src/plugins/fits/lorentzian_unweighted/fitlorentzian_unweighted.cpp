@@ -248,6 +248,19 @@ void function_derivative(double x, double P[], double dFdP[]) {
 }
 
 bool FitLorentzianUnweightedSource::algorithm() {
+  return fit(false);
+}
+
+
+bool FitLorentzianUnweightedSource::algorithmAppend(int &from) {
+  // samples were only added: start from the previous fit, which changes
+  // all of the outputs
+  from = 0;
+  return fit(true);
+}
+
+
+bool FitLorentzianUnweightedSource::fit(bool warmStart) {
   Kst::VectorPtr inputVectorX = _inputVectors[VECTOR_IN_X];
   Kst::VectorPtr inputVectorY = _inputVectors[VECTOR_IN_Y];
 
@@ -269,7 +282,7 @@ bool FitLorentzianUnweightedSource::algorithm() {
 
   bReturn = kstfit_nonlinear( inputVectorX, inputVectorY,
                               outputVectorYFitted, outputVectorYResiduals, outputVectorYParameters,
-                              outputVectorYCovariance, outputScalar );
+                              outputVectorYCovariance, outputScalar, warmStart );
   return bReturn;
 }
 
@@ -13,19 +13,41 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <gsl/gsl_math.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_multifit_nlin.h>
 #include <gsl/gsl_statistics.h>
+#include <QVector>
+#include <QtConcurrentMap>
 #include "common.h"
 
+// residuals and derivatives are evaluated in chunks of this many samples,
+// in parallel when there is more than one
+#define PARALLEL_CHUNK_LENGTH 16384
+
+// without a previous fit to start from, longer data are first fitted on
+// a subset of about this many samples; 0 to always fit the full data
+#ifndef DECIMATED_FIT_LENGTH
+#define DECIMATED_FIT_LENGTH 16384
+#endif
+
 struct data {
   size_t	n;
   const double*	pdX;
   const double* pdY;
 };
 
+struct chunk {
+  size_t iStart;
+  size_t iEnd;
+  const data* pData;
+  double dParameters[NUM_PARAMS];
+  gsl_vector* pVectorF;
+  gsl_matrix* pMatrixJ;
+};
+
 void function_initial_estimate( const double* pdX, const double* pdY, int iLength, double* pdParameterEstimates );
 double function_calculate( double dX, double* pdParameters );
 void function_derivative( double dX, double* pdParameters, double* pdDerivatives );
@@ -36,56 +58,148 @@ bool kstfit_nonlinear(
   Kst::VectorPtr xVector, Kst::VectorPtr yVector,
   Kst::VectorPtr vectorOutYFitted, Kst::VectorPtr vectorOutYResiduals,
   Kst::VectorPtr vectorOutYParameters, Kst::VectorPtr vectorOutYCovariance,
-  Kst::ScalarPtr scalarOutChi );
+  Kst::ScalarPtr scalarOutChi, bool bWarmStart = false );
 
 
-int function_f( const gsl_vector* pVectorX, void* pParams, gsl_vector* pVectorF ) {
-  double 	dParameters[NUM_PARAMS];
-  double	dY;
-  data*	 	pData	= (data*)pParams;
-  size_t 	i;
+void function_chunk( chunk& c ) {
+  double dDerivatives[NUM_PARAMS];
+  size_t i;
+  size_t j;
+
+  for( i=c.iStart; i<c.iEnd; i++ ) {
+    if( c.pVectorF ) {
+      gsl_vector_set( c.pVectorF, i, function_calculate( c.pData->pdX[i], c.dParameters ) - c.pData->pdY[i] );
+    }
+    if( c.pMatrixJ ) {
+      function_derivative( c.pData->pdX[i], c.dParameters, dDerivatives );
+      for( j=0; j<NUM_PARAMS; j++ ) {
+        gsl_matrix_set( c.pMatrixJ, i, j, dDerivatives[j] );
+      }
+    }
+  }
+}
+
+
+// Fills in the residuals and/or the Jacobian, a chunk of samples at a time.
+void function_chunks( const gsl_vector* pVectorX, const data* pData, gsl_vector* pVectorF, gsl_matrix* pMatrixJ ) {
+  QVector<chunk> chunks;
+  chunk c;
+  size_t i;
 
   for( i=0; i<NUM_PARAMS; i++ ) {
-    dParameters[i] = gsl_vector_get( pVectorX, i );
+    c.dParameters[i] = gsl_vector_get( pVectorX, i );
+  }
+  c.pData = pData;
+  c.pVectorF = pVectorF;
+  c.pMatrixJ = pMatrixJ;
+  for( i=0; i<pData->n; i+=PARALLEL_CHUNK_LENGTH ) {
+    c.iStart = i;
+    c.iEnd = qMin( i+PARALLEL_CHUNK_LENGTH, pData->n );
+    chunks.append( c );
   }
 
-  for( i=0; i<pData->n; i++ ) {
-    dY  = function_calculate( pData->pdX[i], dParameters );
-    gsl_vector_set( pVectorF, i, dY - pData->pdY[i] );
+  if( chunks.count() > 1 ) {
+    QtConcurrent::blockingMap( chunks, function_chunk );
+  } else if( chunks.count() == 1 ) {
+    function_chunk( chunks[0] );
   }
+}
+
+
+int function_f( const gsl_vector* pVectorX, void* pParams, gsl_vector* pVectorF ) {
+  function_chunks( pVectorX, (data*)pParams, pVectorF, NULL );
 
   return GSL_SUCCESS;
 }
 
 
 int function_df( const gsl_vector* pVectorX, void* pParams, gsl_matrix* pMatrixJ ) {
-  double dParameters[NUM_PARAMS];
-  double dDerivatives[NUM_PARAMS];
-  data*	 pData	= (data*)pParams;
-  size_t i;
-  size_t j;
+  function_chunks( pVectorX, (data*)pParams, NULL, pMatrixJ );
 
-  for( i=0; i<NUM_PARAMS; i++ ) {
-    dParameters[i] = gsl_vector_get( pVectorX, i );
-  }
+  return GSL_SUCCESS;
+}
+
+
+int function_fdf( const gsl_vector* pVectorX, void* pParams, gsl_vector* pVectorF, gsl_matrix* pMatrixJ ) {  
+  function_chunks( pVectorX, (data*)pParams, pVectorF, pMatrixJ );
+
+  return GSL_SUCCESS;
+}
 
-  for( i=0; i<pData->n; i++ ) {
-    function_derivative( pData->pdX[i], dParameters, dDerivatives );
 
-    for( j=0; j<NUM_PARAMS; j++ ) {
-      gsl_matrix_set( pMatrixJ, i, j, dDerivatives[j] );
+// Iterates the solver from pdParameters, which is left holding the
+// solution; true if it converged.  pFunction has to outlive the solver.
+bool function_solve( gsl_multifit_fdfsolver* pSolver, gsl_multifit_function_fdf* pFunction, double* pdParameters ) {
+  gsl_vector_view vectorViewInitial;
+  int iIterations = 0;
+  int iStatus;
+  int i;
+
+  vectorViewInitial = gsl_vector_view_array( pdParameters, NUM_PARAMS );
+  gsl_multifit_fdfsolver_set( pSolver, pFunction, &vectorViewInitial.vector );
+
+  //
+  // iterate to a solution...
+  //
+  do {
+    iStatus = gsl_multifit_fdfsolver_iterate( pSolver );
+    if( iStatus == GSL_SUCCESS ) {
+      iStatus = gsl_multifit_test_delta( pSolver->dx, pSolver->x, 1.0e-6, 1.0e-6 );
     }
+    iIterations++;
+  } while( iStatus == GSL_CONTINUE && iIterations < MAX_NUM_ITERATIONS );
+
+  for( i=0; i<NUM_PARAMS; i++ ) {
+    pdParameters[i] = gsl_vector_get( pSolver->x, i );
   }
 
-  return GSL_SUCCESS;
+  return iStatus == GSL_SUCCESS;
 }
 
 
-int function_fdf( const gsl_vector* pVectorX, void* pParams, gsl_vector* pVectorF, gsl_matrix* pMatrixJ ) {  
-  function_f( pVectorX, pParams, pVectorF );
-  function_df( pVectorX, pParams, pMatrixJ );
+// The starting point of a fit with no previous fit to go on: the estimate
+// of the plugin, refined on every n-th sample if there are many of them.
+void function_start( const double* pdX, const double* pdY, int iLength, double* pdParameters ) {
+  function_initial_estimate( pdX, pdY, iLength, pdParameters );
 
-  return GSL_SUCCESS;
+  if( DECIMATED_FIT_LENGTH <= 0 || iLength < 4 * DECIMATED_FIT_LENGTH ) {
+    return;
+  }
+
+  int iStep = iLength / DECIMATED_FIT_LENGTH;
+  int iDecimated = iLength / iStep;
+  QVector<double> decimatedX( iDecimated );
+  QVector<double> decimatedY( iDecimated );
+  double dDecimated[NUM_PARAMS];
+  int i;
+
+  for( i=0; i<iDecimated; i++ ) {
+    decimatedX[i] = pdX[i*iStep];
+    decimatedY[i] = pdY[i*iStep];
+  }
+
+  gsl_multifit_fdfsolver* pSolver = gsl_multifit_fdfsolver_alloc( gsl_multifit_fdfsolver_lmsder, iDecimated, NUM_PARAMS );
+  if( pSolver != NULL ) {
+    struct data d;
+    gsl_multifit_function_fdf function;
+
+    d.n    = iDecimated;
+    d.pdX  = decimatedX.constData();
+    d.pdY  = decimatedY.constData();
+
+    function.f      = function_f;
+    function.df     = function_df;
+    function.fdf    = function_fdf;
+    function.n      = iDecimated;
+    function.p      = NUM_PARAMS;
+    function.params = &d;
+
+    memcpy( dDecimated, pdParameters, sizeof( dDecimated ) );
+    if( function_solve( pSolver, &function, dDecimated ) ) {
+      memcpy( pdParameters, dDecimated, sizeof( dDecimated ) );
+    }
+    gsl_multifit_fdfsolver_free( pSolver );
+  }
 }
 
 
@@ -93,21 +207,18 @@ bool kstfit_nonlinear(
   Kst::VectorPtr xVector, Kst::VectorPtr yVector,
   Kst::VectorPtr vectorOutYFitted, Kst::VectorPtr vectorOutYResiduals,
   Kst::VectorPtr vectorOutYParameters, Kst::VectorPtr vectorOutYCovariance,
-  Kst::ScalarPtr scalarOutChi ) {
+  Kst::ScalarPtr scalarOutChi, bool bWarmStart ) {
 
   const gsl_multifit_fdfsolver_type* pType;
   gsl_multifit_fdfsolver* pSolver;
   gsl_multifit_function_fdf	function;
-  gsl_vector_view vectorViewInitial;
   gsl_matrix* pMatrixCovariance;
   struct data d;  
   double dXInitial[NUM_PARAMS];
   double* pInputX;
   double* pInputY;
-  int iIterations = 0;
   int iLength;
   bool bReturn = false;
-  int iStatus;
   int i;
   int j;
 
@@ -140,6 +251,18 @@ bool kstfit_nonlinear(
       }
     }
 
+    //
+    // the previous parameters are a good start if the data only grew...
+    //
+    if( bWarmStart && vectorOutYParameters->length() == NUM_PARAMS ) {
+      for( i=0; i<NUM_PARAMS; i++ ) {
+        dXInitial[i] = vectorOutYParameters->value()[i];
+        bWarmStart = bWarmStart && gsl_finite( dXInitial[i] );
+      }
+    } else {
+      bWarmStart = false;
+    }
+
     if( iLength > NUM_PARAMS ) {
       vectorOutYFitted->resize(iLength);
       vectorOutYResiduals->resize(iLength);
@@ -162,30 +285,19 @@ bool kstfit_nonlinear(
 
         pMatrixCovariance = gsl_matrix_alloc( NUM_PARAMS, NUM_PARAMS );
         if( pMatrixCovariance != NULL ) {
-          function_initial_estimate( pInputX, pInputY, iLength, dXInitial );
-          vectorViewInitial = gsl_vector_view_array( dXInitial, NUM_PARAMS );
-
-          gsl_multifit_fdfsolver_set( pSolver, &function, &vectorViewInitial.vector );
-
-          //
-          // iterate to a solution...
-          //
-          do {
-            iStatus = gsl_multifit_fdfsolver_iterate( pSolver );
-            if( iStatus == GSL_SUCCESS ) {
-              iStatus = gsl_multifit_test_delta( pSolver->dx, pSolver->x, 1.0e-6, 1.0e-6 );
-            }
-            iIterations++;
-          } while( iStatus == GSL_CONTINUE && iIterations < MAX_NUM_ITERATIONS );
+          if( !bWarmStart ) {
+            function_start( pInputX, pInputY, iLength, dXInitial );
+          }
+          if( !function_solve( pSolver, &function, dXInitial ) && bWarmStart ) {
+            // the previous fit led astray: start over
+            function_start( pInputX, pInputY, iLength, dXInitial );
+            function_solve( pSolver, &function, dXInitial );
+          }
           gsl_multifit_covar( pSolver->J, 0.0, pMatrixCovariance );
 
           //
           // determine the fitted values...
           //
-          for( i=0; i<NUM_PARAMS; i++ ) {
-            dXInitial[i] = gsl_vector_get( pSolver->x, i );
-          }
-
           for( i=0; i<iLength; i++ ) {
             vectorOutYFitted->value()[i] = function_calculate( pInputX[i], dXInitial );
             vectorOutYResiduals->value()[i] = pInputY[i] - vectorOutYFitted->value()[i];
@@ -0,0 +1,177 @@
+/***************************************************************************
+                                datasets.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "datasets.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <math.h>
+#include <stdio.h>
+
+#ifdef KST_HAVE_NETCDF
+#include <netcdfcpp.h>
+#endif
+
+#ifdef Q_CC_MSVC
+#define snprintf _snprintf
+#endif
+
+// samples per period of the sine
+static const double Period = 1000.0;
+
+
+DataSets::DataSets(const QString& dir)
+  : _dir(dir) {
+  QDir().mkpath(_dir);
+}
+
+
+// uniform in [-0.5, 0.5), from the sample index alone
+static double hashNoise(quint32 i) {
+  i ^= i >> 16;
+  i *= 0x7feb352d;
+  i ^= i >> 15;
+  i *= 0x846ca68b;
+  i ^= i >> 16;
+  return double(i)/4294967296.0 - 0.5;
+}
+
+
+void DataSets::generate(int from, int rows, QVector<double> *sig, QVector<double> *noise) {
+  sig->resize(rows);
+  noise->resize(rows);
+  for (int i = 0; i < rows; ++i) {
+    const quint32 n = quint32(from + i);
+    const double r = hashNoise(2*n) + hashNoise(2*n + 1);
+    (*noise)[i] = r;
+    (*sig)[i] = sin(2.0*M_PI*double(from + i)/Period) + 0.2*r;
+  }
+}
+
+
+bool DataSets::writeAscii(const QString& fileName, int from, int rows, bool append) {
+  QFile f(fileName);
+  if (!f.open(append ? QIODevice::Append : QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+
+  QVector<double> sig, noise;
+  generate(from, rows, &sig, &noise);
+
+  QByteArray lines;
+  lines.reserve(64*1024 + 128);
+  char line[128];
+  for (int i = 0; i < rows; ++i) {
+    const int n = snprintf(line, sizeof(line), "%d %.10g %.10g\n", from + i, sig.at(i), noise.at(i));
+    lines.append(line, n);
+    if (lines.size() > 64*1024) {
+      f.write(lines);
+      lines.clear();
+    }
+  }
+  f.write(lines);
+  return f.error() == QFile::NoError;
+}
+
+
+QString DataSets::ascii(int rows) {
+  const QString fileName = _dir + QString("/ascii_%1.txt").arg(rows);
+  if (QFileInfo(fileName).exists()) {
+    return fileName;
+  }
+  // renamed when complete, so an interrupted run is not taken for a finished one
+  const QString partName = fileName + ".part";
+  if (!writeAscii(partName, 0, rows, false) || !QFile::rename(partName, fileName)) {
+    QFile::remove(partName);
+    return QString();
+  }
+  return fileName;
+}
+
+
+bool DataSets::appendAscii(const QString& fileName, int from, int rows) {
+  return writeAscii(fileName, from, rows, true);
+}
+
+
+static bool writeRaw(const QString& fileName, const QVector<double>& data) {
+  QFile f(fileName);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+  f.write(reinterpret_cast<const char*>(data.constData()), data.size()*sizeof(double));
+  return f.error() == QFile::NoError;
+}
+
+
+QString DataSets::dirfile(int rows) {
+  const QString dirName = _dir + QString("/dirfile_%1").arg(rows);
+  if (QFileInfo(dirName + "/format").exists()) {
+    return dirName;
+  }
+  QDir().mkpath(dirName);
+
+  QVector<double> sig, noise;
+  generate(0, rows, &sig, &noise);
+  if (!writeRaw(dirName + "/sig", sig) || !writeRaw(dirName + "/noise", noise)) {
+    return QString();
+  }
+
+  // written last, for the same reason
+  QFile format(dirName + "/format");
+  if (!format.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    return QString();
+  }
+  format.write("sig RAW FLOAT64 1\n"
+               "noise RAW FLOAT64 1\n");
+  return format.error() == QFile::NoError ? dirName : QString();
+}
+
+
+QString DataSets::netcdf(int rows) {
+#ifdef KST_HAVE_NETCDF
+  const QString fileName = _dir + QString("/netcdf_%1.nc").arg(rows);
+  if (QFileInfo(fileName).exists()) {
+    return fileName;
+  }
+
+  QVector<double> sig, noise;
+  generate(0, rows, &sig, &noise);
+
+  NcFile f(QFile::encodeName(fileName).constData(), NcFile::Replace);
+  if (!f.is_valid()) {
+    return QString();
+  }
+  NcDim *time = f.add_dim("time", rows);
+  NcVar *sigVar = f.add_var("sig", ncDouble, time);
+  NcVar *noiseVar = f.add_var("noise", ncDouble, time);
+  if (!sigVar || !noiseVar || !sigVar->put(sig.constData(), rows) || !noiseVar->put(noise.constData(), rows)) {
+    f.close();
+    QFile::remove(fileName);
+    return QString();
+  }
+  f.close();
+  return fileName;
+#else
+  Q_UNUSED(rows)
+  return QString();
+#endif
+}
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,55 @@
+/***************************************************************************
+                                 datasets.h
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DATASETS_H
+#define DATASETS_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * Synthetic data sets for the benchmarks: a sine with noise on top ("sig")
+ * and the noise alone ("noise"), sampled once per frame.  The noise comes
+ * from a fixed generator, so every run and platform gets the same data.
+ *
+ * The ASCII file has the columns index, sig and noise, so its fields are
+ * "1", "2" and "3"; the dirfile and NetCDF file have fields sig and noise.
+ */
+class DataSets {
+  public:
+    explicit DataSets(const QString& dir);
+
+    // file names of the data sets with rows samples, written if not there yet
+    QString ascii(int rows);
+    QString dirfile(int rows);
+    // empty when built without NetCDF
+    QString netcdf(int rows);
+
+    // appends rows more lines to an ASCII data set
+    static bool appendAscii(const QString& fileName, int from, int rows);
+
+    QString dir() const { return _dir; }
+
+  private:
+    static void generate(int from, int rows, QVector<double> *sig, QVector<double> *noise);
+    static bool writeAscii(const QString& fileName, int from, int rows, bool append);
+
+    QString _dir;
+};
+
+#endif
+// vim: ts=2 sw=2 et
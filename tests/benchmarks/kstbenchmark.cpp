@@ -0,0 +1,654 @@
+/***************************************************************************
+                              kstbenchmark.cpp
+                             -------------------
+    begin                : Oct 2026
+    copyright            : (C) 2026 The University of Toronto
+    email                : netterfield@astro.utoronto.ca
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+// Times data reading, updates, the common data objects, curve rendering and
+// session load/save on synthetic data sets of several sizes, writes the
+// timings as JSON and compares them against an earlier run's.
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QMap>
+#include <QPainter>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+#include <string.h>
+
+#include "application.h"
+#include "csd.h"
+#include "curve.h"
+#include "datasourcepluginmanager.h"
+#include "datavector.h"
+#include "document.h"
+#include "editablevector.h"
+#include "equation.h"
+#include "histogram.h"
+#include "mainwindow.h"
+#include "objectstore.h"
+#include "psd.h"
+#include "updatemanager.h"
+
+#include "datasets.h"
+
+// slowdowns smaller than this are taken for noise, however large relatively
+static const double NoiseFloorMs = 0.5;
+
+static QTextStream out(stdout);
+
+
+struct Result {
+  QString name;
+  int scale;
+  QList<double> times; // ms
+
+  double median() const {
+    QList<double> t = times;
+    qSort(t);
+    const int n = t.count();
+    return n == 0 ? 0.0 : (n % 2 ? t.at(n/2) : 0.5*(t.at(n/2 - 1) + t.at(n/2)));
+  }
+  double min() const { QList<double> t = times; qSort(t); return t.isEmpty() ? 0.0 : t.first(); }
+  double max() const { QList<double> t = times; qSort(t); return t.isEmpty() ? 0.0 : t.last(); }
+};
+
+
+/**
+ * Collects the timings of one benchmark.  The first run only warms up
+ * caches, plugins and the allocator and is not counted.
+ */
+class Timing {
+  public:
+    Timing(const QString& name, int scale) : _warm(false) {
+      _result.name = name;
+      _result.scale = scale;
+    }
+
+    void start() { _timer.start(); }
+    void stop() {
+      const double ms = _timer.nsecsElapsed()/1.0e6;
+      if (_warm) {
+        _result.times << ms;
+      }
+      _warm = true;
+    }
+
+    const Result& result() const { return _result; }
+
+  private:
+    QElapsedTimer _timer;
+    Result _result;
+    bool _warm;
+};
+
+
+template<class T>
+static void updateObject(const Kst::SharedPtr<T>& object) {
+  object->writeLock();
+  object->internalUpdate();
+  object->unlock();
+}
+
+
+static Kst::DataVectorPtr readVector(Kst::ObjectStore *store, Kst::DataSourcePtr ds, const QString& field) {
+  Kst::DataVectorPtr v = store->createObject<Kst::DataVector>();
+  v->writeLock();
+  v->change(ds, field, 0, -1, 0, false, false);
+  v->internalUpdate();
+  v->unlock();
+  return v;
+}
+
+
+class Benchmarks {
+  public:
+    Benchmarks(DataSets *data, Kst::MainWindow *win, int runs)
+      : _data(data), _win(win), _runs(runs) {}
+
+    void run(int scale);
+
+    const QList<Result>& results() const { return _results; }
+
+  private:
+    void read(const QString& name, const QString& fileName, const QStringList& fields, int scale);
+    void vectorUpdate(const QString& name, Kst::DataVector::StorageType storage, int scale);
+    void analysis(int scale);
+    void curveRender(Kst::ObjectStore *store, Kst::VectorPtr x, Kst::VectorPtr y, int scale);
+    void session(int scale);
+
+    void add(const Timing& timing);
+    void skip(const QString& name, int scale, const QString& why);
+
+    DataSets *_data;
+    Kst::MainWindow *_win;
+    int _runs;
+    QList<Result> _results;
+};
+
+
+void Benchmarks::add(const Timing& timing) {
+  const Result& r = timing.result();
+  out << QString("  %1 %2: %3 ms\n").arg(r.name, -16).arg(r.scale, 8).arg(r.median(), 0, 'f', 2);
+  out.flush();
+  _results << r;
+}
+
+
+void Benchmarks::skip(const QString& name, int scale, const QString& why) {
+  out << QString("  %1 %2: skipped, %3\n").arg(name, -16).arg(scale, 8).arg(why);
+  out.flush();
+}
+
+
+void Benchmarks::run(int scale) {
+  out << QString("%1 samples\n").arg(scale);
+
+  read("ascii ingest", _data->ascii(scale), QStringList() << "1" << "2" << "3", scale);
+  read("dirfile read", _data->dirfile(scale), QStringList() << "sig" << "noise", scale);
+#ifdef KST_HAVE_NETCDF
+  read("netcdf read", _data->netcdf(scale), QStringList() << "sig" << "noise", scale);
+#else
+  skip("netcdf read", scale, "built without NetCDF");
+#endif
+  vectorUpdate("vector update", Kst::DataVector::DoubleStorage, scale);
+  vectorUpdate("float32 update", Kst::DataVector::FloatStorage, scale);
+  analysis(scale);
+  session(scale);
+}
+
+
+void Benchmarks::read(const QString& name, const QString& fileName, const QStringList& fields, int scale) {
+  if (fileName.isEmpty()) {
+    skip(name, scale, "the data set could not be written");
+    return;
+  }
+
+  Timing timing(name, scale);
+  for (int i = 0; i <= _runs; ++i) {
+    Kst::ObjectStore store;
+    timing.start();
+    Kst::DataSourcePtr ds = Kst::DataSourcePluginManager::loadSource(&store, fileName);
+    if (!ds || !ds->isValid()) {
+      skip(name, scale, "no data source plugin reads " + fileName);
+      return;
+    }
+    foreach (const QString& field, fields) {
+      readVector(&store, ds, field);
+    }
+    timing.stop();
+  }
+  add(timing);
+}
+
+
+// A tenth more data appended to a file which has been read already, as
+// when following a file being written.  The vector is read after every
+// update, as a plot would, so compact storage has to keep it unpacked.
+void Benchmarks::vectorUpdate(const QString& name, Kst::DataVector::StorageType storage, int scale) {
+  const QString source = _data->ascii(scale);
+  const QString fileName = _data->dir() + QString("/update_%1_%2.txt")
+                           .arg(Kst::DataVector::storageTypeName(storage)).arg(scale);
+  QFile::remove(fileName);
+  if (source.isEmpty() || !QFile::copy(source, fileName)) {
+    skip(name, scale, "the data set could not be written");
+    return;
+  }
+
+  Kst::ObjectStore store;
+  Kst::DataSourcePtr ds = Kst::DataSourcePluginManager::loadSource(&store, fileName);
+  if (!ds || !ds->isValid()) {
+    skip(name, scale, "no data source plugin reads " + fileName);
+    return;
+  }
+  Kst::DataVectorPtr v = readVector(&store, ds, "2");
+  v->writeLock();
+  v->setStorage(storage);
+  v->internalUpdate();
+  v->unlock();
+
+  const int step = qMax(1, scale/10);
+  int rows = scale;
+  qint64 serial = Kst::UpdateManager::self()->serial();
+  Timing timing(name, scale);
+  for (int i = 0; i <= _runs; ++i) {
+    if (!DataSets::appendAscii(fileName, rows, step)) {
+      skip(name, scale, "could not append to " + fileName);
+      return;
+    }
+    rows += step;
+    ++serial;
+
+    timing.start();
+    ds->writeLock();
+    ds->objectUpdate(serial);
+    ds->unlock();
+    v->writeLock();
+    v->objectUpdate(serial);
+    v->unlock();
+    v->readLock();
+    v->value();
+    v->unlock();
+    timing.stop();
+  }
+
+  if (v->length() != rows) {
+    out << QString("  warning: the vector has %1 samples of %2\n").arg(v->length()).arg(rows);
+  }
+  add(timing);
+  QFile::remove(fileName);
+}
+
+
+void Benchmarks::analysis(int scale) {
+  const QString fileName = _data->ascii(scale);
+  Kst::ObjectStore store;
+  Kst::DataSourcePtr ds = fileName.isEmpty() ? Kst::DataSourcePtr() : Kst::DataSourcePluginManager::loadSource(&store, fileName);
+  if (!ds || !ds->isValid()) {
+    skip("analysis", scale, "the ASCII data set could not be read");
+    return;
+  }
+  Kst::DataVectorPtr x = readVector(&store, ds, "1");
+  Kst::DataVectorPtr y = readVector(&store, ds, "2");
+
+  {
+    Kst::EquationPtr eq = store.createObject<Kst::Equation>();
+    eq->writeLock();
+    eq->setEquation(QString("sin([%1]*0.01)*[%2] + [%2]^2 - exp(-abs([%2]))")
+                    .arg(x->shortName()).arg(y->shortName()));
+    eq->setExistingXVector(Kst::VectorPtr(x), false);
+    eq->unlock();
+    Timing timing("equation", scale);
+    for (int i = 0; i <= _runs; ++i) {
+      timing.start();
+      updateObject(eq);
+      timing.stop();
+    }
+    add(timing);
+  }
+
+  {
+    Kst::PSDPtr psd = store.createObject<Kst::PSD>();
+    psd->writeLock();
+    psd->change(Kst::VectorPtr(y), 1.0, true, 12, true, true, "V", "Hz",
+                WindowOriginal, 3.0, PSDPowerSpectralDensity);
+    psd->unlock();
+    Timing timing("psd", scale);
+    for (int i = 0; i <= _runs; ++i) {
+      timing.start();
+      updateObject(psd);
+      timing.stop();
+    }
+    add(timing);
+  }
+
+  {
+    // about 50 spectra whatever the size
+    Kst::CSDPtr csd = store.createObject<Kst::CSD>();
+    csd->writeLock();
+    csd->change(Kst::VectorPtr(y), 1.0, true, true, true, WindowOriginal,
+                qMax(1024, scale/50), 10, 3.0, PSDPowerSpectralDensity, "V", "Hz");
+    csd->unlock();
+    Timing timing("csd", scale);
+    for (int i = 0; i <= _runs; ++i) {
+      timing.start();
+      updateObject(csd);
+      timing.stop();
+    }
+    add(timing);
+  }
+
+  {
+    Kst::HistogramPtr histogram = store.createObject<Kst::Histogram>();
+    histogram->writeLock();
+    histogram->change(Kst::VectorPtr(y), -1.5, 1.5, 300, Kst::Histogram::Number);
+    histogram->unlock();
+    Timing timing("histogram", scale);
+    for (int i = 0; i <= _runs; ++i) {
+      timing.start();
+      updateObject(histogram);
+      timing.stop();
+    }
+    add(timing);
+  }
+
+  curveRender(&store, Kst::VectorPtr(x), Kst::VectorPtr(y), scale);
+}
+
+
+// Drawing a curve with lines into a plot sized image, the way
+// CartesianRenderItem does.
+void Benchmarks::curveRender(Kst::ObjectStore *store, Kst::VectorPtr x, Kst::VectorPtr y, int scale) {
+  Kst::CurvePtr curve = store->createObject<Kst::Curve>();
+  curve->writeLock();
+  curve->setXVector(x);
+  curve->setYVector(y);
+  curve->setHasLines(true);
+  curve->setLineWidth(1);
+  curve->setColor(Qt::blue);
+  curve->internalUpdate();
+  curve->unlock();
+
+  QImage image(1600, 1000, QImage::Format_ARGB32_Premultiplied);
+  const QRect plotRect = image.rect().adjusted(60, 20, -20, -60);
+
+  Kst::CurveRenderContext context;
+  context.window = image.rect();
+  context.XMin = context.x_min = curve->minX();
+  context.XMax = context.x_max = curve->maxX();
+  context.YMin = context.y_min = curve->minY();
+  context.YMax = context.y_max = curve->maxY();
+  context.Lx = plotRect.left();
+  context.Hx = plotRect.right();
+  context.Ly = plotRect.top();
+  context.Hy = plotRect.bottom();
+  context.m_X = double(plotRect.width())/(context.x_max - context.x_min);
+  context.m_Y = -double(plotRect.height())/(context.y_max - context.y_min);
+  context.b_X = context.Lx - context.m_X*context.x_min;
+  context.b_Y = context.Ly - context.m_Y*context.y_max;
+  context.penWidth = 1;
+  context.foregroundColor = Qt::black;
+  context.backgroundColor = Qt::white;
+
+  Timing timing("curve render", scale);
+  for (int i = 0; i <= _runs; ++i) {
+    image.fill(0xffffffff);
+    QPainter painter(&image);
+    context.painter = &painter;
+    timing.start();
+    curve->updatePaintObjects(context);
+    curve->paintObjects(context);
+    timing.stop();
+  }
+  add(timing);
+}
+
+
+// A session with data from the ASCII data set, the common data objects
+// and curves, and an editable vector the size of the data set.
+void Benchmarks::session(int scale) {
+  Kst::Document *doc = _win->document();
+  Kst::ObjectStore *store = doc->objectStore();
+  const QString dataFile = _data->ascii(scale);
+  const QString fileName = _data->dir() + QString("/session_%1.kst").arg(scale);
+
+  store->clear();
+  Kst::DataSourcePtr ds = dataFile.isEmpty() ? Kst::DataSourcePtr() : Kst::DataSourcePluginManager::loadSource(store, dataFile);
+  if (!ds || !ds->isValid()) {
+    skip("session", scale, "the ASCII data set could not be read");
+    return;
+  }
+  Kst::DataVectorPtr x = readVector(store, ds, "1");
+  Kst::DataVectorPtr y = readVector(store, ds, "2");
+  readVector(store, ds, "3");
+
+  Kst::EquationPtr eq = store->createObject<Kst::Equation>();
+  eq->writeLock();
+  eq->setEquation(QString("[%1]^2").arg(y->shortName()));
+  eq->setExistingXVector(Kst::VectorPtr(x), false);
+  eq->internalUpdate();
+  eq->unlock();
+
+  Kst::PSDPtr psd = store->createObject<Kst::PSD>();
+  psd->writeLock();
+  psd->change(Kst::VectorPtr(y), 1.0, true, 12, true, true, "V", "Hz",
+              WindowOriginal, 3.0, PSDPowerSpectralDensity);
+  psd->internalUpdate();
+  psd->unlock();
+
+  Kst::HistogramPtr histogram = store->createObject<Kst::Histogram>();
+  histogram->writeLock();
+  histogram->change(Kst::VectorPtr(y), -1.5, 1.5, 300, Kst::Histogram::Number);
+  histogram->internalUpdate();
+  histogram->unlock();
+
+  Kst::EditableVectorPtr edited = store->createObject<Kst::EditableVector>();
+  edited->writeLock();
+  edited->resize(y->length());
+  ::memcpy(edited->value(), y->value(), y->length()*sizeof(double));
+  edited->unlock();
+
+  Kst::CurvePtr curve = store->createObject<Kst::Curve>();
+  curve->writeLock();
+  curve->setXVector(Kst::VectorPtr(x));
+  curve->setYVector(Kst::VectorPtr(y));
+  curve->setHasLines(true);
+  curve->internalUpdate();
+  curve->unlock();
+
+  curve = store->createObject<Kst::Curve>();
+  curve->writeLock();
+  curve->setXVector(psd->vX());
+  curve->setYVector(psd->vY());
+  curve->setHasLines(true);
+  curve->internalUpdate();
+  curve->unlock();
+
+  Timing save("session save", scale);
+  for (int i = 0; i <= _runs; ++i) {
+    save.start();
+    const bool ok = doc->save(fileName);
+    save.stop();
+    if (!ok) {
+      skip("session save", scale, doc->lastError());
+      store->clear();
+      return;
+    }
+  }
+  add(save);
+
+  // with the data read, as when the session is opened for use
+  Timing load("session load", scale);
+  for (int i = 0; i <= _runs; ++i) {
+    store->clear();
+    load.start();
+    const bool ok = doc->open(fileName);
+    Kst::UpdateManager::self()->doUpdates(true);
+    load.stop();
+    if (!ok) {
+      skip("session load", scale, doc->lastError());
+      break;
+    }
+  }
+  if (load.result().times.count() == _runs) {
+    add(load);
+  }
+  store->clear();
+}
+
+
+static QString jsonString(const QString& s) {
+  QString escaped = s;
+  escaped.replace('\\', "\\\\").replace('"', "\\\"");
+  return '"' + escaped + '"';
+}
+
+
+static bool writeResults(const QString& fileName, const QList<Result>& results, int runs) {
+  QFile f(fileName);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    return false;
+  }
+  QTextStream ts(&f);
+  ts << "{\n"
+     << "  \"qt\": " << jsonString(qVersion()) << ",\n"
+     << "  \"runs\": " << runs << ",\n"
+     << "  \"results\": [\n";
+  for (int i = 0; i < results.count(); ++i) {
+    const Result& r = results.at(i);
+    // one result a line; readBaseline() relies on it
+    ts << "    {\"name\": " << jsonString(r.name) << ", \"scale\": " << r.scale
+       << ", \"median_ms\": " << QString::number(r.median(), 'f', 3)
+       << ", \"min_ms\": " << QString::number(r.min(), 'f', 3)
+       << ", \"max_ms\": " << QString::number(r.max(), 'f', 3)
+       << "}" << (i + 1 < results.count() ? ",\n" : "\n");
+  }
+  ts << "  ]\n"
+     << "}\n";
+  ts.flush();
+  return f.error() == QFile::NoError;
+}
+
+
+static QString resultKey(const QString& name, int scale) {
+  return name + '@' + QString::number(scale);
+}
+
+
+// Reads the medians of results written by writeResults().
+static bool readBaseline(const QString& fileName, QMap<QString, double> *medians) {
+  QFile f(fileName);
+  if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return false;
+  }
+  QRegExp re("\\{\"name\": \"([^\"]*)\", \"scale\": (\\d+), \"median_ms\": ([-0-9.eE+]+)");
+  QTextStream ts(&f);
+  while (!ts.atEnd()) {
+    const QString line = ts.readLine();
+    if (re.indexIn(line) >= 0) {
+      medians->insert(resultKey(re.cap(1), re.cap(2).toInt()), re.cap(3).toDouble());
+    }
+  }
+  return true;
+}
+
+
+// Prints the comparison; returns the number of regressions.
+static int compare(const QList<Result>& results, const QMap<QString, double>& baseline, double tolerance) {
+  int regressions = 0;
+  out << QString("\n%1 %2 %3 %4 %5\n").arg("benchmark", -16).arg("scale", 8)
+                                       .arg("ms", 10).arg("baseline", 10).arg("change", 8);
+  foreach (const Result& r, results) {
+    const QString key = resultKey(r.name, r.scale);
+    const double median = r.median();
+    QString line = QString("%1 %2 %3").arg(r.name, -16).arg(r.scale, 8).arg(median, 10, 'f', 2);
+    if (baseline.contains(key)) {
+      const double base = baseline.value(key);
+      const double change = base > 0.0 ? (median - base)/base : 0.0;
+      line += QString(" %1 %2%").arg(base, 10, 'f', 2).arg(100.0*change, 7, 'f', 1);
+      if (change > tolerance && median - base > NoiseFloorMs) {
+        line += "  REGRESSION";
+        ++regressions;
+      }
+    } else {
+      line += QString(" %1").arg("-", 10);
+    }
+    out << line << '\n';
+  }
+  out.flush();
+  return regressions;
+}
+
+
+static void usage() {
+  out << "Usage: kstbenchmark [options]\n"
+         "  --scales n,n,...  samples in the data sets (default 10000,100000,1000000)\n"
+         "  --runs n          timed runs of each benchmark (default 5)\n"
+         "  --data dir        where the data sets are made and kept\n"
+         "                    (default kstbenchmark in the temporary directory)\n"
+         "  --output file     where the results are written (default kstbenchmark.json)\n"
+         "  --baseline file   results of an earlier run to compare against\n"
+         "  --tolerance f     slowdown over the baseline which fails the run (default 0.1)\n";
+  out.flush();
+}
+
+
+int main(int argc, char *argv[]) {
+#if QT_VERSION >= 0x050000
+  // curves are rendered to images, so no display is needed
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+#endif
+
+  Kst::Application app(argc, argv);
+
+  QList<int> scales;
+  scales << 10000 << 100000 << 1000000;
+  int runs = 5;
+  QString dataDir = QDir::tempPath() + "/kstbenchmark";
+  QString output("kstbenchmark.json");
+  QString baselineFile;
+  double tolerance = 0.1;
+
+  const QStringList args = app.arguments();
+  for (int i = 1; i < args.count(); ++i) {
+    const QString& arg = args.at(i);
+    const QString value = i + 1 < args.count() ? args.at(i + 1) : QString();
+    bool ok = !value.isEmpty();
+    if (arg == "--scales") {
+      scales.clear();
+      foreach (const QString& s, value.split(',', QString::SkipEmptyParts)) {
+        const int scale = s.toInt(&ok);
+        if (!ok || scale <= 0) {
+          break;
+        }
+        scales << scale;
+      }
+    } else if (arg == "--runs") {
+      runs = value.toInt(&ok);
+      ok = ok && runs > 0;
+    } else if (arg == "--data") {
+      dataDir = value;
+    } else if (arg == "--output") {
+      output = value;
+    } else if (arg == "--baseline") {
+      baselineFile = value;
+    } else if (arg == "--tolerance") {
+      tolerance = value.toDouble(&ok);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      usage();
+      return 2;
+    }
+    ++i;
+  }
+
+  app.initMainWindow();
+
+  DataSets data(dataDir);
+  Benchmarks benchmarks(&data, app.mainWindow(), runs);
+  foreach (int scale, scales) {
+    benchmarks.run(scale);
+  }
+
+  if (!writeResults(output, benchmarks.results(), runs)) {
+    out << "Could not write " << output << '\n';
+    return 2;
+  }
+  out << "Results written to " << output << '\n';
+
+  if (baselineFile.isEmpty()) {
+    return 0;
+  }
+  QMap<QString, double> baseline;
+  if (!readBaseline(baselineFile, &baseline)) {
+    out << "No baseline in " << baselineFile << ", nothing compared\n";
+    return 0;
+  }
+  const int regressions = compare(benchmarks.results(), baseline, tolerance);
+  if (regressions > 0) {
+    out << regressions << " regression(s) of more than " << 100.0*tolerance << "%\n";
+    return 1;
+  }
+  return 0;
+}
+
+// vim: ts=2 sw=2 et
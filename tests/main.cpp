@@ -26,6 +26,8 @@
 #include "testlabelparser.h"
 #include "testeqparser.h"
 #include "testobjectstore.h"
+#include "teststreamplugin.h"
+#include "testdetectioncache.h"
 
 int main(int argc, char *argv[]) {
   QCoreApplication app(argc, argv);
@@ -69,6 +71,12 @@ int main(int argc, char *argv[]) {
   TestObjectStore test11;
   QTest::qExec(&test11, argc, argv);
 
+  TestStreamPlugin test12;
+  QTest::qExec(&test12, argc, argv);
+
+  TestDetectionCache test13;
+  QTest::qExec(&test13, argc, argv);
+
   return 0;
 }
 
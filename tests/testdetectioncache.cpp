@@ -0,0 +1,171 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testdetectioncache.h"
+
+#include <QtTest>
+
+#include <QDir>
+#include <QFile>
+
+#include "detectioncache.h"
+
+// Caches made here are never loaded or saved, so the one kst keeps
+// across runs is left alone.
+
+static const QByteArray BinaryMagic("\x89KST\r\n\x1a\n\0\0\0\x01\0\0\0\x02", 16);
+
+void TestDetectionCache::initTestCase() {
+  _dir = QDir::tempPath() + QString("/kst_testdetectioncache_%1").arg(QCoreApplication::applicationPid());
+  QVERIFY(QDir().mkpath(_dir));
+}
+
+
+void TestDetectionCache::cleanupTestCase() {
+  foreach (const QString& file, _files) {
+    QFile::remove(file);
+  }
+  QDir().rmdir(_dir);
+}
+
+
+QString TestDetectionCache::writeFile(const QString& name, const QByteArray& contents) {
+  const QString fileName = _dir + '/' + name;
+  QFile f(fileName);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return QString();
+  }
+  f.write(contents);
+  f.close();
+  if (!_files.contains(fileName)) {
+    _files << fileName;
+  }
+  return fileName;
+}
+
+
+void TestDetectionCache::testLookup() {
+  Kst::DetectionCache cache;
+  cache.setContext("plugins");
+
+  Kst::DetectionCache::Matches ascii;
+  ascii << qMakePair(QString("ASCII File Reader"), 75);
+
+  const QString fileName = writeFile("lookup.txt", "1 2 3\n4 5 6\n");
+  QVERIFY(!fileName.isEmpty());
+
+  Kst::DetectionCache::Probe probe = Kst::DetectionCache::probe(fileName);
+  QVERIFY(probe.valid);
+
+  Kst::DetectionCache::Matches matches;
+  QVERIFY(!cache.lookup(probe, &matches));
+
+  cache.insert(probe, ascii);
+  QVERIFY(cache.lookup(Kst::DetectionCache::probe(fileName), &matches));
+  QCOMPARE(matches, ascii);
+
+  // a file which no plugin understands is remembered as well
+  const QString unknown = writeFile("lookup.unknown", "\x01\x02\x03");
+  cache.insert(Kst::DetectionCache::probe(unknown), Kst::DetectionCache::Matches());
+  QVERIFY(cache.lookup(Kst::DetectionCache::probe(unknown), &matches));
+  QVERIFY(matches.isEmpty());
+
+  // a file which changed goes back to the plugins
+  QVERIFY(!writeFile("lookup.txt", "# now a longer header\n1 2 3\n").isEmpty());
+  probe = Kst::DetectionCache::probe(fileName);
+  QVERIFY(!cache.lookup(probe, &matches));
+
+  // so does one which isn't there, or isn't a plain file
+  probe = Kst::DetectionCache::probe(_dir + "/missing.txt");
+  QVERIFY(!probe.valid);
+  QVERIFY(!cache.lookup(probe, &matches));
+}
+
+
+void TestDetectionCache::testInvalidation() {
+  Kst::DetectionCache cache;
+  cache.setContext("plugins");
+
+  Kst::DetectionCache::Matches ascii;
+  ascii << qMakePair(QString("ASCII File Reader"), 75);
+
+  const QString fileName = writeFile("invalidation.txt", "1 2 3\n");
+  cache.insert(Kst::DetectionCache::probe(fileName), ascii);
+
+  Kst::DetectionCache::Matches matches;
+  cache.setContext("plugins");
+  QVERIFY(cache.lookup(Kst::DetectionCache::probe(fileName), &matches));
+
+  cache.setContext("plugins with other settings");
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(fileName), &matches));
+
+  // settings of one file only forget that file
+  const QString other = writeFile("invalidation2.txt", "4 5 6\n");
+  cache.insert(Kst::DetectionCache::probe(fileName), ascii);
+  cache.insert(Kst::DetectionCache::probe(other), ascii);
+  cache.forget(fileName);
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(fileName), &matches));
+  QVERIFY(cache.lookup(Kst::DetectionCache::probe(other), &matches));
+}
+
+
+void TestDetectionCache::testKindTrust() {
+  Kst::DetectionCache cache;
+  cache.setContext("plugins");
+
+  Kst::DetectionCache::Matches images;
+  images << qMakePair(QString("QImage Source Reader"), 90);
+
+  Kst::DetectionCache::Matches matches;
+  int i = 0;
+  for (; i < 3; ++i) {
+    const QString fileName = writeFile(QString("kind%1.img").arg(i), BinaryMagic + QByteArray(i + 1, 'x'));
+    QVERIFY(!cache.lookup(Kst::DetectionCache::probe(fileName), &matches));
+    cache.insert(Kst::DetectionCache::probe(fileName), images);
+  }
+
+  // judged the same way often enough; new files of the kind are trusted
+  const QString same = writeFile("kind_new.img", BinaryMagic + QByteArray(100, 'y'));
+  QVERIFY(cache.lookup(Kst::DetectionCache::probe(same), &matches));
+  QCOMPARE(matches, images);
+
+  // another extension or other leading bytes make another kind
+  const QString otherSuffix = writeFile("kind_new.dat", BinaryMagic + QByteArray(100, 'y'));
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(otherSuffix), &matches));
+  QByteArray otherBytes = BinaryMagic;
+  otherBytes[1] = 'Q';
+  const QString otherMagic = writeFile("kind_other.img", otherBytes);
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(otherMagic), &matches));
+
+  // text files never are, however many of them look alike
+  for (int j = 0; j < 5; ++j) {
+    const QString fileName = writeFile(QString("text%1.txt").arg(j), "# header line\n1 2 3\n" + QByteArray(j, '4'));
+    cache.insert(Kst::DetectionCache::probe(fileName), images);
+  }
+  const QString text = writeFile("text_new.txt", "# header line\n1 2 3\n");
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(text), &matches));
+
+  // once a plugin judges one file of the kind differently, none are trusted
+  const QString odd = writeFile(QString("kind%1.img").arg(i), BinaryMagic + QByteArray(200, 'z'));
+  cache.insert(Kst::DetectionCache::probe(odd), Kst::DetectionCache::Matches());
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(same), &matches));
+
+  // and a new context starts the count over
+  cache.setContext("other plugins");
+  QVERIFY(!cache.lookup(Kst::DetectionCache::probe(same), &matches));
+}
+
+
+#ifdef KST_USE_QTEST_MAIN
+QTEST_MAIN(TestDetectionCache)
+#endif
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,38 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTDETECTIONCACHE_H
+#define TESTDETECTIONCACHE_H
+
+#include <QObject>
+#include <QStringList>
+
+class TestDetectionCache : public QObject
+{
+  Q_OBJECT
+  private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testLookup();
+    void testInvalidation();
+    void testKindTrust();
+
+  private:
+    QString writeFile(const QString& name, const QByteArray& contents);
+
+    QString _dir;
+    QStringList _files;
+};
+
+#endif
+
+// vim: ts=2 sw=2 et
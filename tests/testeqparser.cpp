@@ -19,6 +19,11 @@
 #include <eparse-eh.h>
 #include <objectstore.h>
 #include <generatedvector.h>
+#include <datavector.h>
+#include <datasourcepluginmanager.h>
+
+#include <QTemporaryFile>
+#include <QTextStream>
 
 KSTMATH_EXPORT extern /*"C"*/ int yyparse(Kst::ObjectStore *store);
 KSTMATH_EXPORT extern /*"C"*/ void *ParsedEquation;
@@ -111,7 +116,14 @@ bool TestEqParser::validateEquation(const char *equation, double x, double resul
     eq->collectObjects(vectorsUsed, scm, stm);
     eq->update(&ctx);
     double v = eq->value(&ctx);
+    // block evaluation must agree with per sample evaluation
+    double block;
+    eq->values(&ctx, ctx.i, 1, &block);
     delete eq;
+    if (block != v && (block == block || v == v)) {
+      printf("Block result: %.16f, sample result: %.16f\n", block, v);
+      return false;
+    }
     if (fabs(v - result) < tol || (result != result && v != v) || (result == INF && v == INF) || (result == -INF && v == -INF)) {
       return true;
     } else {
@@ -633,6 +645,118 @@ void TestEqParser::testEqParser() {
   QVERIFY(validateParserFailures("2*sin(x)()"));
 }
 
+// Evaluates equation over sampleCount samples a block at a time, from
+// block boundaries and from odd places, and compares every sample with
+// per sample evaluation.
+bool TestEqParser::validateBlocks(const char *equation, long sampleCount) {
+  yy_scan_string(equation);
+  if (yyparse(&_store) != 0) {
+    printf("Failed to parse [%s]\n", equation);
+    delete (Equations::Node*)ParsedEquation;
+    ParsedEquation = 0L;
+    return false;
+  }
+  Equations::Node *eq = static_cast<Equations::Node*>(ParsedEquation);
+  ParsedEquation = 0L;
+  if (!eq) {
+    return false;
+  }
+
+  Kst::VectorMap vm;
+  Kst::ScalarMap scm;
+  Kst::StringMap stm;
+  eq->collectObjects(vm, scm, stm);
+
+  Equations::Context ctx;
+  ctx.sampleCount = sampleCount;
+  ctx.noPoint = _NOPOINT;
+  eq->update(&ctx);
+
+  bool ok = true;
+  double block[Equations::BlockSize];
+  const long starts[] = { 0, 7, Equations::BlockSize - 1 };
+  for (unsigned s = 0; ok && s < sizeof(starts)/sizeof(starts[0]); ++s) {
+    for (long i0 = starts[s]; ok && i0 < sampleCount; i0 += Equations::BlockSize) {
+      const int n = int(qMin(long(Equations::BlockSize), sampleCount - i0));
+      eq->values(&ctx, i0, n, block);
+      for (int k = 0; k < n; ++k) {
+        ctx.i = i0 + k;
+        const double v = eq->value(&ctx);
+        if (block[k] != v && (block[k] == block[k] || v == v)) {
+          printf("[%s] sample %ld: block result %.16f, sample result %.16f\n", equation, i0 + k, block[k], v);
+          ok = false;
+          break;
+        }
+      }
+    }
+  }
+  delete eq;
+  return ok;
+}
+
+
+void TestEqParser::testBlockEvaluation() {
+  Kst::GeneratedVectorPtr gv = Kst::kst_cast<Kst::GeneratedVector>(_store.createObject<Kst::GeneratedVector>());
+  gv->changeRange(-3.0, 5.0, 1000);
+  gv->setDescriptiveName("bvector1");
+  gv = Kst::kst_cast<Kst::GeneratedVector>(_store.createObject<Kst::GeneratedVector>());
+  gv->changeRange(2.0, -1.0, 1000);
+  gv->setDescriptiveName("bvector2");
+  gv = Kst::kst_cast<Kst::GeneratedVector>(_store.createObject<Kst::GeneratedVector>());
+  gv->changeRange(0.0, 1.0, 300);
+  gv->setDescriptiveName("bvector3");
+
+  QVERIFY(validateBlocks("[bvector1]", 1000));
+  QVERIFY(validateBlocks("2*sin([bvector1]) + [bvector2]^2 - abs([bvector1])", 1000));
+  QVERIFY(validateBlocks("[bvector1] > 0 && [bvector2] < 1", 1000));
+  QVERIFY(validateBlocks("-[bvector1]/[bvector2] + sqrt([bvector2])", 1000));
+  // a shorter vector is interpolated to the sample count
+  QVERIFY(validateBlocks("[bvector1]*[bvector3]", 1000));
+
+  // a data vector which scrolled, so that its samples start further into
+  // its buffer
+  Kst::DataSourcePluginManager::init();
+  if (!Kst::DataSourcePluginManager::pluginList().contains("ASCII File Reader"))
+    QSKIP("...couldn't find the ascii plugin.", SkipAll);
+
+  QTemporaryFile tf;
+  tf.open();
+  QTextStream ts(&tf);
+  for (int i = 0; i < 1000; ++i) {
+    ts << (i % 37) - 18 << endl;
+  }
+  ts.flush();
+
+  Kst::DataSourcePtr ds = Kst::DataSourcePluginManager::loadSource(&_store, tf.fileName());
+  QVERIFY(ds);
+  Kst::DataVectorPtr dv = _store.createObject<Kst::DataVector>();
+  dv->writeLock();
+  dv->change(ds, "1", -1, 600, 0, false, false);
+  dv->internalUpdate();
+  dv->unlock();
+  dv->setDescriptiveName("svector");
+  QCOMPARE(dv->length(), 600);
+
+  for (int i = 1000; i < 1150; ++i) {
+    ts << (i % 37) - 18 << endl;
+  }
+  ts.flush();
+  ds->writeLock();
+  ds->objectUpdate(1);
+  ds->unlock();
+  dv->writeLock();
+  dv->objectUpdate(1);
+  dv->unlock();
+
+  QCOMPARE(dv->length(), 600);
+  QCOMPARE(dv->numShift(), 150);
+  QCOMPARE(dv->value(0), double((550 % 37) - 18));
+
+  QVERIFY(validateBlocks("[svector]", 600));
+  QVERIFY(validateBlocks("3*[svector] + 1", 600));
+  QVERIFY(validateBlocks("[svector]*[bvector3]", 600));
+}
+
 #ifdef KST_USE_QTEST_MAIN
 QTEST_MAIN(TestEqParser)
 #endif
@@ -21,10 +21,12 @@ class TestEqParser : public QObject
     bool validateText(const char *equation, const char *expect);
     bool validateParserFailures(const char *equation);
     bool validateEquation(const char *equation, double x, double result, const double tol = 0.00000000001);
+    bool validateBlocks(const char *equation, long sampleCount);
   private Q_SLOTS:
     void cleanupTestCase();
 
     void testEqParser();
+    void testBlockEvaluation();
 };
 
 #endif
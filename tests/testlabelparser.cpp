@@ -480,6 +480,25 @@ void TestLabelParser::testLabelParser() {
 }
 
 
+void TestLabelParser::testParseCache() {
+  QSharedPointer<const Label::Parsed> parsed = Label::parseCached("x^2");
+  QVERIFY(parsed);
+  QCOMPARE(parsed->chunk->text, QString("x"));
+  QVERIFY(parsed->chunk->up != 0L);
+  QCOMPARE(parsed->chunk->up->text, QString("2"));
+
+  // the same text shares one tree
+  QSharedPointer<const Label::Parsed> again = Label::parseCached("x^2");
+  QVERIFY(again == parsed);
+
+  // but uninterpreted text is cached separately
+  QSharedPointer<const Label::Parsed> plain = Label::parseCached("x^2", false);
+  QVERIFY(plain != parsed);
+  QCOMPARE(plain->chunk->text, QString("x^2"));
+  QVERIFY(plain->chunk->up == 0L);
+}
+
+
 #ifdef KST_USE_QTEST_MAIN
 QTEST_MAIN(TestLabelParser)
 #endif
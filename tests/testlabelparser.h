@@ -26,6 +26,7 @@ class TestLabelParser : public QObject
     void cleanupTestCase();
 
     void testLabelParser();
+    void testParseCache();
 };
 
 #endif
@@ -32,6 +32,7 @@ SOURCES += \
     testcsd.cpp \
     testdatamatrix.cpp \
     testdatasource.cpp \
+    testdetectioncache.cpp \
     testeqparser.cpp \
     testgeneratedmatrix.cpp \
     testhistogram.cpp \
@@ -40,6 +41,7 @@ SOURCES += \
     testmatrix.cpp \
     testpsd.cpp \
     testobjectstore.cpp \
+    teststreamplugin.cpp \
     testvector.cpp
 
 HEADERS += \
@@ -47,6 +49,7 @@ HEADERS += \
     testcsd.h \
     testdatamatrix.h \
     testdatasource.h \
+    testdetectioncache.h \
     testhistogram.h \
     testeqparser.h \
     testgeneratedmatrix.h \
@@ -55,4 +58,5 @@ HEADERS += \
     testmatrix.h \
     testpsd.h \
     testobjectstore.h \
+    teststreamplugin.h \
     testvector.h
@@ -0,0 +1,226 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "teststreamplugin.h"
+
+#include <QtTest>
+
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "basicplugin.h"
+#include "datacollection.h"
+#include "datasourcepluginmanager.h"
+#include "datavector.h"
+#include "objectstore.h"
+
+static Kst::ObjectStore _store;
+
+// A cumulative sum, which counts how it was updated.
+class StreamSum : public Kst::BasicPlugin {
+  public:
+    int full;
+    int appended;
+
+    QString _automaticDescriptiveName() const { return QLatin1String("Stream Sum"); }
+    void change(Kst::DataObjectConfigWidget *configWidget) { Q_UNUSED(configWidget); }
+
+    bool algorithm() {
+      ++full;
+      Kst::VectorPtr in = _inputVectors["Y"];
+      Kst::VectorPtr out = _outputVectors["Sum"];
+      out->resize(in->length(), true);
+      double sum = 0.0;
+      for (int i = 0; i < in->length(); ++i) {
+        sum += in->value(i);
+        out->value()[i] = sum;
+      }
+      return true;
+    }
+
+    bool algorithmAppend(int &from) {
+      Kst::VectorPtr in = _inputVectors["Y"];
+      Kst::VectorPtr out = _outputVectors["Sum"];
+      if (from < 1 || out->length() < from) {
+        return false;
+      }
+      ++appended;
+      out->resize(in->length(), false);
+      for (int i = from; i < in->length(); ++i) {
+        out->value()[i] = out->value(i - 1) + in->value(i);
+      }
+      return true;
+    }
+
+    QStringList inputVectorList() const { return QStringList("Y"); }
+    QStringList inputScalarList() const { return QStringList(); }
+    QStringList inputStringList() const { return QStringList(); }
+    QStringList outputVectorList() const { return QStringList("Sum"); }
+    QStringList outputScalarList() const { return QStringList(); }
+    QStringList outputStringList() const { return QStringList(); }
+
+  protected:
+    StreamSum(Kst::ObjectStore *store) : Kst::BasicPlugin(store), full(0), appended(0) {}
+
+  friend class Kst::ObjectStore;
+};
+
+
+static void appendLines(QFile *f, int from, int n) {
+  QTextStream ts(f);
+  for (int i = from; i < from + n; ++i) {
+    ts << (i % 7) - 2.5 << endl;
+  }
+  ts.flush();
+}
+
+
+// what the streamed sum has to come out as
+static void compareWithFullSum(Kst::VectorPtr in, Kst::VectorPtr out) {
+  QCOMPARE(out->length(), in->length());
+  double sum = 0.0;
+  for (int i = 0; i < in->length(); ++i) {
+    sum += in->value(i);
+    QCOMPARE(out->value(i), sum);
+  }
+}
+
+
+static qint64 _serial = 0;
+
+// one update pass, as the update manager would do it; the plugin can be left
+// out, as it is when nothing needs it
+static void updatePass(Kst::DataSourcePtr ds, Kst::DataVectorPtr dv, StreamSum *sum) {
+  ++_serial;
+  ds->writeLock();
+  ds->objectUpdate(_serial);
+  ds->unlock();
+  dv->writeLock();
+  dv->objectUpdate(_serial);
+  dv->unlock();
+  if (sum) {
+    sum->writeLock();
+    sum->objectUpdate(_serial);
+    sum->unlock();
+  }
+}
+
+
+void TestStreamPlugin::initTestCase() {
+  Kst::DataSourcePluginManager::init();
+  _plugins = Kst::DataSourcePluginManager::pluginList();
+}
+
+
+void TestStreamPlugin::cleanupTestCase() {
+  _store.clear();
+}
+
+
+void TestStreamPlugin::testAppend() {
+  if (!_plugins.contains("ASCII File Reader"))
+    QSKIP("...couldn't find plugin.", SkipAll);
+
+  QTemporaryFile tf;
+  tf.open();
+  appendLines(&tf, 0, 10);
+
+  Kst::DataSourcePtr ds = Kst::DataSourcePluginManager::loadSource(&_store, tf.fileName());
+  QVERIFY(ds);
+  Kst::DataVectorPtr dv = _store.createObject<Kst::DataVector>();
+  dv->writeLock();
+  dv->change(ds, "1", 0, -1, 0, false, false);
+  dv->unlock();
+
+  Kst::SharedPtr<StreamSum> sum = _store.createObject<StreamSum>();
+  sum->writeLock();
+  sum->setInputVector("Y", dv);
+  sum->setOutputVector("Sum", "");
+  sum->unlock();
+
+  updatePass(ds, dv, sum);
+  QCOMPARE(dv->length(), 10);
+  QCOMPARE(sum->full, 1);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+
+  appendLines(&tf, 10, 5);
+  updatePass(ds, dv, sum);
+  QCOMPARE(dv->length(), 15);
+  QCOMPARE(sum->appended, 1);
+  QCOMPARE(sum->full, 1);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+
+  // nothing new: the plugin is not even run
+  updatePass(ds, dv, sum);
+  QCOMPARE(sum->appended, 1);
+  QCOMPARE(sum->full, 1);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+
+  appendLines(&tf, 15, 3);
+  updatePass(ds, dv, sum);
+  QCOMPARE(sum->appended, 2);
+  QCOMPARE(sum->full, 1);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+}
+
+
+void TestStreamPlugin::testSkippedUpdates() {
+  if (!_plugins.contains("ASCII File Reader"))
+    QSKIP("...couldn't find plugin.", SkipAll);
+
+  QTemporaryFile tf;
+  tf.open();
+  appendLines(&tf, 0, 10);
+
+  Kst::DataSourcePtr ds = Kst::DataSourcePluginManager::loadSource(&_store, tf.fileName());
+  QVERIFY(ds);
+  Kst::DataVectorPtr dv = _store.createObject<Kst::DataVector>();
+  dv->writeLock();
+  dv->change(ds, "1", 0, -1, 0, false, false);
+  dv->unlock();
+
+  Kst::SharedPtr<StreamSum> sum = _store.createObject<StreamSum>();
+  sum->writeLock();
+  sum->setInputVector("Y", dv);
+  sum->setOutputVector("Sum", "");
+  sum->unlock();
+
+  updatePass(ds, dv, sum);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+
+  // the vector updates twice while the plugin is skipped, so the new samples
+  // of the last update are not all it has missed
+  appendLines(&tf, 10, 5);
+  updatePass(ds, dv, 0);
+  appendLines(&tf, 15, 4);
+  updatePass(ds, dv, 0);
+  QCOMPARE(dv->length(), 19);
+  QCOMPARE(dv->numNew(), 4);
+
+  updatePass(ds, dv, sum);
+  QCOMPARE(sum->appended, 0);
+  QCOMPARE(sum->full, 2);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+
+  // and it streams again afterwards
+  appendLines(&tf, 19, 6);
+  updatePass(ds, dv, sum);
+  QCOMPARE(sum->appended, 1);
+  QCOMPARE(sum->full, 2);
+  compareWithFullSum(dv, sum->outputVector("Sum"));
+}
+
+
+#ifdef KST_USE_QTEST_MAIN
+QTEST_MAIN(TestStreamPlugin)
+#endif
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,34 @@
+/***************************************************************************
+ *                                                                         *
+ *   copyright : (C) 2026 The University of Toronto                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTSTREAMPLUGIN_H
+#define TESTSTREAMPLUGIN_H
+
+#include <QObject>
+#include <QStringList>
+
+class TestStreamPlugin : public QObject
+{
+  Q_OBJECT
+  private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testAppend();
+    void testSkippedUpdates();
+
+  private:
+    QStringList _plugins;
+};
+
+#endif
+
+// vim: ts=2 sw=2 et